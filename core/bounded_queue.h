@@ -0,0 +1,88 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+// FIFO between a producer and a consumer thread holding at most capacity items. push()
+// blocks while it's full, which is what slows a producer down to its consumer's pace.
+// Once closed, pushes fail and pops drain what's left before failing too. Thread safe.
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t capacity)
+    : m_capacity(std::max<size_t>(capacity, 1))
+    { }
+
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    bool push(T item)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (!m_closed && m_items.size() >= m_capacity)
+                m_stall_count++;
+            m_not_full.wait(lock, [this]() { return m_closed || m_items.size() < m_capacity; });
+            if (m_closed)
+                return false;
+            m_items.push_back(std::move(item));
+        }
+        m_not_empty.notify_one();
+        return true;
+    }
+
+    bool pop(T &out)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_not_empty.wait(lock, [this]() { return m_closed || !m_items.empty(); });
+            if (m_items.empty())
+                return false;
+            out = std::move(m_items.front());
+            m_items.pop_front();
+        }
+        m_not_full.notify_one();
+        return true;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_not_full.notify_all();
+        m_not_empty.notify_all();
+    }
+
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_items.size();
+    }
+
+    size_t capacity() const { return m_capacity; }
+
+    // pushes that had to wait for room, i.e. the consumer was the slower side
+    size_t stallCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stall_count;
+    }
+
+protected:
+    mutable std::mutex m_mutex;
+    std::condition_variable m_not_full;
+    std::condition_variable m_not_empty;
+    std::deque<T> m_items;
+    size_t m_capacity;
+    size_t m_stall_count {0};
+    bool m_closed {false};
+};
+
+#endif // BOUNDED_QUEUE_H
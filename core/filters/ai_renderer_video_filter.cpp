@@ -2,14 +2,32 @@
 
 #include "ai_renderer_video_filter.h"
 #include "main_api_connection.h"
+#include "endpoint_request_builder.h"
+#include "backend_pool.h"
+#include "response_cache.h"
+#include "plugin_catalogue.h"
+#include "render_result_index.h"
+#include "render_queue.h"
+#include "frame_prefetcher.h"
+#include "uploaded_frame_ring.h"
+#include "render_pipeline.h"
+#include "render_latency.h"
+#include "in_flight_jobs.h"
+#include "hash_utils.h"
 #include "parameter.h"
 #include "video_host.h"
 #include "utils.h"
 #include "images/image_utils.h"
+#include "images/disk_result_cache.h"
 #include "logger.h"
 #include <iostream>
 #include <thread>
 #include <unordered_set>
+#include <atomic>
+#include <future>
+#include <functional>
+#include <mutex>
+#include <algorithm>
 #define PLUGIN_MENU_STRING_ID "plugin.menu"
 #define PLUGIN_ENDPOINT_START_STRING_ID ".endpoint.group.start"
 #define PLUGIN_ENDPOINT_END_STRING_ID ".endpoint.group.end"
@@ -19,9 +37,49 @@
 #define SELECT_PLUGIN_MESSAGE "Select A Plugin"
 #define PLUGIN_CONFIG_STRING_ID "Plugin Configuration"
 
+// upper bound on concurrent get_info requests while building the plugin menu
+static const size_t kMaxPluginInfoFetches = 8;
+// jobs waiting between two pipeline stages, enough to keep the slowest one busy
+static const size_t kPipelineQueueDepth = 2;
+// the most the inputs of a draft render are shrunk by, past it the result isn't worth looking at
+static const int kMaxProxyScale = 8;
+// a progressive render's draft is this much smaller than the render it stands in for
+static const int kDraftScale = 4;
+// a job is polled at the shortest time one took so far, but no more often than this
+static const std::chrono::milliseconds kMinJobPollInterval {250};
+// how long a job is waited for before it's given up on, what six polls at the default interval used to allow
+static const std::chrono::seconds kJobTimeout {60};
+
 std::vector<FilterConfig> AIRendererFilter::s_filter_configs;
+std::mutex AIRendererFilter::s_filter_configs_mutex;
 ParamCache AIRendererFilter::s_param_cache{kAIREndererMatchName};
 
+// every request of the catalogue refresh gives up after this, shutdown joins it so this bounds
+// how long the host waits at unload
+static const std::chrono::milliseconds kCatalogueRefreshTimeout {2000};
+
+// The background revalidation of the plugin catalogue snapshot, joined by shutdown. Its worker
+// holds on to this too, so a refresh still running when the module is unloaded without shutdown
+// is detached instead of blocking a static destructor
+struct CatalogueRefresh
+{
+     ~CatalogueRefresh()
+     {
+          if (worker.joinable())
+               worker.detach();
+     }
+
+     std::mutex mutex;
+     std::thread worker;
+     std::atomic<bool> cancelled {false};
+};
+
+static std::shared_ptr<CatalogueRefresh> catalogueRefresh()
+{
+     static std::shared_ptr<CatalogueRefresh> refresh = std::make_shared<CatalogueRefresh>();
+     return refresh;
+}
+
 std::string selectedEndpointId(const std::string &plugin_name, const std::string &endpoint_name)
 {
      return plugin_name + "." + endpoint_name;
@@ -76,9 +134,24 @@ void AIRendererFilter::shutdown()
 {
      ApiConnection api_connection;
 
+     std::shared_ptr<CatalogueRefresh> refresh = catalogueRefresh();
+     {
+          // no new get_info is sent once cancelled, the ones in flight end within kCatalogueRefreshTimeout
+          refresh->cancelled = true;
+          std::lock_guard<std::mutex> lock(refresh->mutex);
+          if (refresh->worker.joinable())
+               refresh->worker.join();
+     }
+     RenderQueue::instance().shutdown();
+
      if (IsBackendStarted())
           api_connection.shutdownBackend();
 
+     DiskResultCache::instance().flush();
+     LogInfo(ResponseCache::instance().statsString());
+     LogInfo("Coalesced backend requests: " + std::to_string(ApiConnection::coalescedRequestCount()));
+     LogInfo(RenderLatency::instance().statsString());
+     LogInfo("Superseded backend jobs: " + std::to_string(InFlightJobs::instance().supersededCount()));
      ShutdownSentryLogging();
 }
 
@@ -90,7 +163,9 @@ void AIRendererFilter::initParameters()
           s_param_cache.init();
      }
 
-     if (s_filter_configs.empty())
+     bool first_build = s_filter_configs.empty();
+     auto build_start = std::chrono::steady_clock::now();
+     if (first_build)
      {
           fetchFilterConfigs();
      }
@@ -98,6 +173,12 @@ void AIRendererFilter::initParameters()
      addFilterMenu();
      addFilterParams();
      addMissingParams();
+
+     if (first_build)
+     {
+          auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - build_start);
+          LogInfo(std::string("Time to first params (") + (m_catalogue_from_snapshot ? "warm" : "cold") + "): " + std::to_string(elapsed.count()) + "ms");
+     }
 }
 
 void AIRendererFilter::addMissingParams()
@@ -141,18 +222,73 @@ ParamCache &AIRendererFilter::paramCache()
      return s_param_cache;
 }
 
-void AIRendererFilter::fetchFilterConfigs()
+// get_info is fetched and parsed on a handful of workers, each result goes in the
+// slot matching its place in the plugin list so the menu order doesn't depend on
+// which request finishes first. Once cancelled the workers stop taking plugins,
+// a timeout other than 0 replaces the default request deadline
+static std::vector<ArkPlugin> fetchPluginInfos(const std::vector<std::string> &plugin_list,
+                                               const std::atomic<bool> *cancelled = nullptr,
+                                               std::chrono::milliseconds timeout = std::chrono::milliseconds(0))
 {
-     ApiConnection api_connection;
-     std::vector<std::string> plugin_list = api_connection.getPluginList();
-     for (const auto &plugin_name : plugin_list)
+     std::vector<ArkPlugin> fetched_plugins(plugin_list.size());
+     std::vector<char> fetched(plugin_list.size(), 0);
+     std::atomic<size_t> next_plugin {0};
+     auto fetch_worker = [&]()
      {
-          FilterConfig filter_config(plugin_name);
-
-          if (api_connection.getPluginInfo(plugin_name, filter_config.plugin()))
+          ApiConnection worker_connection;
+          worker_connection.setRequestTimeout(timeout);
+          for (size_t i = next_plugin++; i < plugin_list.size(); i = next_plugin++)
           {
-               s_filter_configs.push_back(filter_config);
+               if (cancelled && *cancelled)
+                    break;
+               if (worker_connection.getPluginInfo(plugin_list[i], fetched_plugins[i]))
+               {
+                    fetched[i] = 1;
+               }
           }
+     };
+
+     size_t worker_count = std::min(plugin_list.size(), kMaxPluginInfoFetches);
+     std::vector<std::future<void>> workers;
+     for (size_t i = 0; i < worker_count; i++)
+     {
+          workers.push_back(std::async(std::launch::async, fetch_worker));
+     }
+     for (auto &worker : workers)
+     {
+          worker.get();
+     }
+
+     std::vector<ArkPlugin> plugins;
+     for (size_t i = 0; i < fetched_plugins.size(); i++)
+     {
+          if (fetched[i])
+               plugins.push_back(std::move(fetched_plugins[i]));
+     }
+     return plugins;
+}
+
+void AIRendererFilter::fetchFilterConfigs()
+{
+     std::vector<ArkPlugin> plugins;
+     m_catalogue_from_snapshot = PluginCatalogue::load(PluginCatalogue::snapshotPath(), plugins) && !plugins.empty();
+     if (m_catalogue_from_snapshot)
+     {
+          refreshCatalogueSnapshot(plugins);
+     }
+     else
+     {
+          ApiConnection api_connection;
+          plugins = fetchPluginInfos(api_connection.getPluginList());
+          if (!plugins.empty())
+               PluginCatalogue::save(PluginCatalogue::snapshotPath(), plugins);
+     }
+
+     for (const auto &plugin : plugins)
+     {
+          FilterConfig filter_config(plugin.plugin_name);
+          filter_config.plugin() = plugin;
+          s_filter_configs.push_back(filter_config);
      }
      if (!s_filter_configs.empty())
      {
@@ -161,6 +297,90 @@ void AIRendererFilter::fetchFilterConfigs()
      }
 }
 
+void AIRendererFilter::refreshCatalogueSnapshot(const std::vector<ArkPlugin> &snapshot_plugins)
+{
+     std::shared_ptr<CatalogueRefresh> refresh = catalogueRefresh();
+     std::lock_guard<std::mutex> lock(refresh->mutex);
+     if (refresh->worker.joinable() || refresh->cancelled)
+          return;
+
+     refresh->worker = std::thread([refresh, snapshot_plugins]()
+     {
+          // the filter may be shut down between any two steps, a snapshot half way there isn't written
+          ApiConnection api_connection;
+          api_connection.setRequestTimeout(kCatalogueRefreshTimeout);
+          std::vector<std::string> plugin_list = api_connection.getPluginList();
+          if (plugin_list.empty() || refresh->cancelled)
+               return;
+
+          std::vector<ArkPlugin> fetched_plugins = fetchPluginInfos(plugin_list, &refresh->cancelled, kCatalogueRefreshTimeout);
+          std::vector<ArkPlugin> merged_plugins;
+          int changed = PluginCatalogue::merge(snapshot_plugins, fetched_plugins, merged_plugins);
+          if (changed > 0 && !refresh->cancelled)
+          {
+               PluginCatalogue::save(PluginCatalogue::snapshotPath(), merged_plugins);
+               int applied = applyCatalogueChanges(merged_plugins);
+               LogInfo("Plugin catalogue changed on the backend (" + std::to_string(changed) + " plugins), " +
+                       std::to_string(applied) + " versions or configs taken for this session, new plugins, endpoints and params show up after a restart");
+          }
+     });
+}
+
+int AIRendererFilter::applyCatalogueChanges(const std::vector<ArkPlugin> &plugins)
+{
+     // The params were already built from the snapshot and the hosts don't let us change them
+     // for this session, what a render sends and how its result is keyed can still follow the backend
+     int applied = 0;
+     std::lock_guard<std::mutex> lock(s_filter_configs_mutex);
+     for (auto &filter_config : s_filter_configs)
+     {
+          for (const auto &plugin : plugins)
+          {
+               ArkPlugin &current = filter_config.plugin();
+               if (plugin.plugin_name != current.plugin_name || (plugin.version == current.version && plugin.config.hash == current.config.hash))
+                    continue;
+
+               current.version = plugin.version;
+               current.config = plugin.config;
+               applied++;
+          }
+     }
+     return applied;
+}
+
+void AIRendererFilter::refreshPluginConfig(const std::string &plugin_name)
+{
+     // the dialog already dropped the cached get_info, this is the edited config
+     ArkPlugin plugin;
+     if (!ApiConnection().getPluginInfo(plugin_name, plugin))
+     {
+          LogWarning("Couldn't re-read the config of " + plugin_name + " after editing it");
+          return;
+     }
+
+     std::vector<ArkPlugin> plugins;
+     bool changed = false;
+     {
+          std::lock_guard<std::mutex> lock(s_filter_configs_mutex);
+          for (auto &filter_config : s_filter_configs)
+          {
+               if (filter_config.plugin().plugin_name == plugin_name && filter_config.plugin().config.hash != plugin.config.hash)
+               {
+                    filter_config.plugin().config = plugin.config;
+                    changed = true;
+               }
+               if (!filter_config.plugin().plugin_name.empty())
+                    plugins.push_back(filter_config.plugin());
+          }
+     }
+     if (changed)
+     {
+          LogInfo("Config of " + plugin_name + " changed, new results are cached under it");
+          // the next launch starts from the snapshot, it mustn't bring the old config back
+          PluginCatalogue::save(PluginCatalogue::snapshotPath(), plugins);
+     }
+}
+
 void AIRendererFilter::addFilterMenu()
 {
      std::vector<std::string> plugin_list;
@@ -282,68 +502,568 @@ void AIRendererFilter::syncParamWithCachedParam(ParameterPtr param)
      }
 }
 
-void AIRendererFilter::handleMultiImageRequest(const std::vector<std::string> &img_params, VideoHost &host, Endpoint &endpoint)
+struct WindowFrame
 {
-     int currentCachedFrame = host.getDelegate()->currentFrame();
-     ApiConnection api_connection;
-     for (const auto &param : img_params)
+     int frame {0};
+     ArkImagePtr image;      // only fetched when the frame isn't in the instance's upload ring
+     UploadedFrame uploaded;
+};
+
+// Everything a render needs once it has left the host's render call. Images of a queued
+// render are copies, the host's buffers only live as long as the call they came with.
+struct RenderJob
+{
+     uint64_t instance_id {0};
+     std::string plugin_name;
+     std::string endpoint_name;
+     std::string img_param; // takes the source image, empty if the endpoint doesn't
+     std::vector<std::pair<std::string, std::vector<WindowFrame>>> frame_params; // img_before/img_after and their frames
+     ArkImagePtr source;
+     EndpointRequestBuilder request; // the endpoint params, image ids are added as they're uploaded
+     uint64_t params_hash {0};
+     bool supersedable {false}; // interactive, dropped once the instance renders with other params
+     bool disk_cacheable {false};
+     uint64_t disk_key {0};
+     int proxy_scale {1}; // the images sent are this much smaller than the host's, 1 at full resolution
+     std::chrono::milliseconds poll_interval {10000};
+     // the host's frames, only set for jobs that run within the host call they came with
+     std::function<ArkImagePtr(int frame)> fetch_frame;
+
+     // the node the inputs went to, held from the upload until the result is downloaded
+     std::shared_ptr<BackendLease> lease;
+     std::vector<std::string> tried_nodes;
+     std::chrono::high_resolution_clock::time_point start_time;
+
+     std::string img_id;
+     std::string node_url; // the backend holding img_id
+     ArkImagePtr img;
+     std::chrono::duration<double> elapsed {0};
+};
+
+void AIRendererFilter::gatherFrameImages(VideoHost &host, Endpoint &endpoint, RenderJob &job, int frame, bool detach)
+{
+     int currentCachedFrame = frame;
+     if (!detach)
+          job.fetch_frame = [&host](int host_frame) { return host.getImgAtFrame(host_frame); };
+     for (const auto &param : endpoint.getInputImgListParams())
      {
           LogInfo("Image Param: " + param);
 
           int frameOffset = endpoint.countInputOccurrences(param, "Image");
 
-          std::vector<ArkImagePtr> images;
-          std::vector<std::string> img_ids;
+          std::vector<WindowFrame> frames;
 
           int direction = (param == "img_before") ? -1 : 1;
           int startOffset = 1;
 
           for (int i = startOffset; i <= frameOffset; i++)
           {
-               int requestedFrame = currentCachedFrame + (i * direction);
-               LogInfo(param + ":frame being requested = " + std::to_string(requestedFrame) + ":Current Frame:" + std::to_string(currentCachedFrame));
-               images.push_back(host.getImgAtFrame(requestedFrame));
+               WindowFrame window_frame;
+               window_frame.frame = currentCachedFrame + (i * direction);
+               // sent for an earlier frame whose window overlapped this one, at the same resolution
+               if (job.instance_id != 0 && UploadedFrameRing::instance().find(job.instance_id, window_frame.frame, window_frame.uploaded) &&
+                   window_frame.uploaded.scale == job.proxy_scale)
+               {
+                    frames.push_back(window_frame);
+                    continue;
+               }
+               window_frame.uploaded = UploadedFrame();
+
+               LogInfo(param + ":frame being requested = " + std::to_string(window_frame.frame) + ":Current Frame:" + std::to_string(currentCachedFrame));
+               ArkImagePtr image = host.getImgAtFrame(window_frame.frame);
+               // hashed at the host's size, that's what the ring's checkFrame compares against
+               window_frame.uploaded.content_hash = imageContentHash(image);
+               window_frame.uploaded.scale = job.proxy_scale;
+               if (job.proxy_scale > 1)
+                    window_frame.image = downscaleImage(image, job.proxy_scale);
+               else
+                    window_frame.image = detach ? cloneImage(image) : image;
+               frames.push_back(window_frame);
           }
 
-          api_connection.uploadMultipleImages(images, img_ids);
+          job.frame_params.emplace_back(param, std::move(frames));
+     }
+}
 
-          std::string img_ids_param;
-          for (auto it = img_ids.begin(); it != img_ids.end(); ++it)
+// frames taken from the upload ring that live on another node are fetched from the host again and
+// uploaded to this one, false if the host call the job came with is over and that isn't possible
+static bool uploadFrameImages(const ApiConnection &api_connection, const BackendNode &node, RenderJob &job)
+{
+     UploadedFrameRing &ring = UploadedFrameRing::instance();
+     for (const auto &frame_param : job.frame_params)
+     {
+          std::vector<std::string> img_ids;
+          for (const auto &window_frame : frame_param.second)
           {
-               if (it == img_ids.begin())
-               {
-                    img_ids_param += *it + "\",";
-               }
-               else if (std::next(it) != img_ids.end())
+               ArkImagePtr image = window_frame.image;
+               if (!window_frame.uploaded.image_id.empty())
                {
-                    img_ids_param += "\"" + *it + "\",";
+                    if (window_frame.uploaded.node == node.base_url)
+                    {
+                         img_ids.push_back(window_frame.uploaded.image_id);
+                         continue;
+                    }
+                    if (!job.fetch_frame)
+                         return false;
+                    image = job.fetch_frame(window_frame.frame);
+                    if (image && job.proxy_scale > 1)
+                         image = downscaleImage(image, job.proxy_scale);
                }
-               else
+
+               // frames out of the clip have no image, the backend is sent -1 for those
+               std::string img_id;
+               if (!image || !api_connection.uploadImage(image, img_id, TransferRole::Neighbour))
                {
-                    img_ids_param += "\"" + *it;
+                    img_ids.push_back("-1");
+                    continue;
                }
+               img_ids.push_back(img_id);
+
+               if (job.instance_id != 0)
+                    ring.add(job.instance_id, UploadedFrame{window_frame.frame, node.base_url, img_id, window_frame.uploaded.content_hash, job.proxy_scale});
           }
-          endpoint.setInputId(param, img_ids_param);
+          job.request.addStringList(frame_param.first, img_ids);
+     }
+     return true;
+}
 
-          for (int i = 0; i < img_ids.size(); i++)
+// the node holding the frames reused from the upload ring, empty if none were
+static std::string ringNode(const RenderJob &job)
+{
+     for (const auto &frame_param : job.frame_params)
+     {
+          for (const auto &window_frame : frame_param.second)
           {
-               m_imageMap[param + std::to_string(i)] = img_ids[i];
+               if (!window_frame.uploaded.image_id.empty())
+                    return window_frame.uploaded.node;
           }
      }
+     return "";
 }
 
-void AIRendererFilter::handleImageRequest(const std::string &img_param, Endpoint &endpoint, ArkImagePtr sourceImg)
+static void uploadSourceImage(const ApiConnection &api_connection, RenderJob &job)
 {
-     ApiConnection api_connection;
      std::string img_id;
 
-     if (api_connection.uploadImage(sourceImg, img_id))
+     if (api_connection.uploadImage(job.source, img_id))
      {
           if (!img_id.empty())
           {
-               endpoint.setInputId(img_param, img_id);
+               job.request.addString(job.img_param, img_id);
+          }
+     }
+}
+
+// A render runs in three stages, each of them host free so they run the same on the render
+// thread, a RenderQueue worker or a RenderPipeline stage thread.
+
+// leases a node and uploads the inputs to it
+static bool uploadRenderJob(RenderJob &job)
+{
+     BackendPool &pool = BackendPool::instance();
+
+     // the uploads, the job, its status polls and the result download all stay on the node
+     // leased here, a node that can't take the job hands it to the next least busy one.
+     // Frames reused from the upload ring only exist where they were uploaded, so that node goes first
+     std::string ring_node = job.tried_nodes.empty() ? ringNode(job) : "";
+     job.lease.reset();
+     while (job.tried_nodes.size() < pool.size())
+     {
+          std::vector<std::string> exclude = job.tried_nodes;
+          if (!ring_node.empty())
+          {
+               for (const auto &node : ApiConnection::configuredBackends())
+               {
+                    if (node.base_url != ring_node)
+                         exclude.push_back(node.base_url);
+               }
+               ring_node.clear();
+          }
+
+          std::shared_ptr<BackendLease> lease = std::make_shared<BackendLease>(pool, exclude);
+          if (!lease->valid())
+          {
+               if (exclude.size() > job.tried_nodes.size())
+                    continue;
+               break;
+          }
+          job.tried_nodes.push_back(lease->node().base_url);
+          ApiConnection api_connection = lease->connection();
+
+          if (!job.frame_params.empty())
+          {
+               if (!uploadFrameImages(api_connection, lease->node(), job))
+               {
+                    // a queued job has no host to fetch the frames from, the placeholder stays up
+                    // and the next render fetches and uploads the whole window again
+                    LogWarning("Reused frames aren't on " + lease->node().base_url + ", dropping them");
+                    UploadedFrameRing::instance().forget(job.instance_id);
+                    return false;
+               }
+          }
+          else if (!job.img_param.empty())
+          {
+               uploadSourceImage(api_connection, job);
+          }
+          job.lease = lease;
+          return true;
+     }
+
+     LogError("Error executing plugin");
+     return false;
+}
+
+// runs the endpoint on the leased node and waits for it to finish
+static bool inferRenderJob(RenderJob &job)
+{
+     InFlightJobs &in_flight = InFlightJobs::instance();
+     bool tracked = job.supersedable && job.instance_id != 0;
+     if (tracked && !in_flight.isCurrent(job.instance_id, job.params_hash))
+     {
+          LogInfo("Render superseded by newer params before it started");
+          job.lease.reset();
+          return false;
+     }
+
+     std::string job_id;
+     while (job.lease)
+     {
+          LogInfo("Endpoint Params: " + job.request.json());
+          job_id = job.lease->connection().callEndpoint(job.plugin_name, job.endpoint_name, job.request.json());
+          if (!job_id.empty())
+               break;
+          LogWarning("Backend " + job.lease->node().base_url + " could not run the job");
+          // image ids of one node mean nothing to another, the next one gets its own uploads
+          if (!uploadRenderJob(job))
+               return false;
+     }
+     if (job_id.empty())
+          return false;
+
+     ApiConnection api_connection = job.lease->connection();
+     // the instance may have moved on while the job was being submitted
+     bool superseded = tracked && !in_flight.add(job.instance_id, job.params_hash, job_id);
+     job.start_time = std::chrono::high_resolution_clock::now();
+     // jobs that finished quickly before don't get polled back to back
+     std::chrono::milliseconds poll_interval = std::max(job.poll_interval, kMinJobPollInterval);
+     // wait for the job to complete
+     JobStatusResponse job_response;
+     if (!superseded)
+          job_response = api_connection.jobStatus(job_id);
+     while (job_response.status == JOB_STATUS_IN_PROGRESS)
+     {
+          // woken up early once the instance renders with other params
+          if (in_flight.waitSuperseded(job.instance_id, job_id, poll_interval))
+          {
+               superseded = true;
+               break;
+          }
+          job_response = api_connection.jobStatus(job_id);
+          LogInfo("Job Response: " + stringFromJobStatus(job_response.status));
+
+          if (job_response.status == JOB_STATUS_IN_PROGRESS && std::chrono::high_resolution_clock::now() - job.start_time > kJobTimeout)
+          {
+               LogError(job_id + ": Job timed out", true);
+               break;
           }
      }
+
+     if (tracked)
+          in_flight.remove(job.instance_id, job_id);
+     if (superseded)
+     {
+          // its result would be thrown away, the backend is better off working on the current params
+          LogInfo("Cancelling superseded job " + job_id);
+          api_connection.cancelJob(job_id);
+          job.lease.reset();
+          return false;
+     }
+
+     if (job_response.status != JOB_STATUS_SUCCESS)
+     {
+          LogError("Job failed: " + stringFromJobStatus(job_response.status), true);
+          // one of the reused uploads may be what the backend choked on, send fresh ones next time
+          api_connection.invalidateUploadCache();
+          UploadedFrameRing::instance().forget(job.instance_id);
+          job.lease.reset();
+          return false;
+     }
+     job.img_id = job_response.img_id;
+     return true;
+}
+
+// downloads and decodes the result, then gives the node back
+static bool downloadRenderJob(RenderJob &job)
+{
+     std::shared_ptr<BackendLease> lease = std::move(job.lease);
+     std::string encoded_img;
+     ArkImagePtr img = lease->connection().getImage(job.img_id, &encoded_img);
+     if (!img)
+     {
+          job.img_id.clear();
+          return false;
+     }
+
+     if (job.disk_cacheable && !encoded_img.empty())
+          DiskResultCache::instance().store(job.disk_key, encoded_img);
+
+     job.node_url = lease->node().base_url;
+     job.img = img;
+     job.elapsed = std::chrono::high_resolution_clock::now() - job.start_time;
+     LogInfo("Job took " + std::to_string(job.elapsed.count()) + " s");
+     return true;
+}
+
+static bool runRenderJob(RenderJob &job)
+{
+     bool success = uploadRenderJob(job) && inferRenderJob(job) && downloadRenderJob(job);
+     job.lease.reset();
+     return success;
+}
+
+static bool isDiskCacheable(Endpoint &endpoint)
+{
+     return endpoint.getInputImgListParams().empty();
+}
+
+// results outlive the session, so an updated plugin or another model in its config gets keys of its own
+static uint64_t diskResultKey(FilterConfig &filter_config, const Endpoint &endpoint, uint64_t render_key)
+{
+     const ArkPlugin &plugin = filter_config.plugin();
+     uint64_t plugin_key = hashCombine(hashCombine(hash64(filter_config.name()), hash64(plugin.version)), plugin.config.hash);
+     return hashCombine(hashCombine(plugin_key, hash64(endpoint.name)), render_key);
+}
+
+// How much smaller than the host's images the inputs are sent while the host renders at a
+// reduced resolution, 1 at full resolution. Endpoints that don't take images make their
+// output from the params alone, those always render at full size
+static int proxyScale(VideoHost &host, Endpoint &endpoint)
+{
+     if (endpoint.getInputImgParam().empty() && endpoint.getInputImgListParams().empty())
+          return 1;
+     int scale = std::min(host.getDelegate()->downsampleX(), host.getDelegate()->downSampleY());
+     return std::max(1, std::min(scale, kMaxProxyScale));
+}
+
+// results are kept per resolution, full resolution ones keep the key they always had
+static uint64_t renderKey(uint64_t params_hash, uint64_t source_hash, int proxy_scale)
+{
+     uint64_t render_key = hashCombine(params_hash, source_hash);
+     if (proxy_scale > 1)
+          render_key = hashCombine(render_key, static_cast<uint64_t>(proxy_scale));
+     return render_key;
+}
+
+// the frame's result for render_key from the index or the disk cache, nullptr if there's none
+static ArkImagePtr cachedResult(FilterConfig &filter_config, Endpoint &endpoint, RenderResultIndex &render_index,
+                                int frame, uint64_t render_key)
+{
+     std::string image_id;
+     std::string node_url;
+     if (render_index.find(frame, render_key, image_id, &node_url))
+     {
+          ArkImagePtr img = ApiConnection(BackendPool::instance().nodeForUrl(node_url)).getImage(image_id);
+          if (img)
+               return img;
+     }
+     std::string disk_data;
+     if (isDiskCacheable(endpoint) && DiskResultCache::instance().load(diskResultKey(filter_config, endpoint, render_key), disk_data))
+          return ::getImage(disk_data);
+     return nullptr;
+}
+
+// a draft result of the frame, the sharpest one first, nullptr if there's none
+static ArkImagePtr proxyResult(FilterConfig &filter_config, Endpoint &endpoint, RenderResultIndex &render_index,
+                               int frame, uint64_t params_hash, uint64_t source_hash)
+{
+     for (int scale = 2; scale <= kMaxProxyScale; scale++)
+     {
+          ArkImagePtr img = cachedResult(filter_config, endpoint, render_index, frame, renderKey(params_hash, source_hash, scale));
+          if (img)
+               return img;
+     }
+     return nullptr;
+}
+
+static bool submitRenderJob(uint64_t instance_id, uint64_t render_key, int frame, RenderJob job, RenderQueue::Completion on_done, RenderLane lane)
+{
+     std::shared_ptr<RenderJob> queued_job = std::make_shared<RenderJob>(std::move(job));
+     return RenderQueue::instance().submit(instance_id, render_key, frame,
+          [queued_job](RenderQueue::Result &result)
+          {
+               result.success = runRenderJob(*queued_job);
+               result.image_id = queued_job->img_id;
+               result.node_url = queued_job->node_url;
+               result.seconds = queued_job->elapsed.count();
+          },
+          on_done, lane);
+}
+
+static RenderQueue::Completion rerenderOnSuccess(RenderCompletion notify_host)
+{
+     return [notify_host](const RenderQueue::Result &result)
+     {
+          // failures wait for the host to ask for the frame again, rather than retry in a loop
+          if (result.success && notify_host)
+               notify_host();
+     };
+}
+
+// one frame of a prefetched range, prepared like a single render's job
+struct BatchEntry
+{
+     int frame {0};
+     uint64_t render_key {0};
+     RenderJob job;
+};
+
+// the nodes that turned batch jobs down, batches go to the others
+static std::vector<std::string> nodesWithoutBatches()
+{
+     std::vector<std::string> nodes;
+     for (const auto &node : ApiConnection::configuredBackends())
+     {
+          if (!ApiConnection(node).batchJobsSupported())
+               nodes.push_back(node.base_url);
+     }
+     return nodes;
+}
+
+// Renders the frames as a single backend job. Each frame's result is published as soon as
+// the backend reports it, the first entry's goes into result like a single job's would.
+// The downloads wait for the stream to end, nothing is fetched from inside its callback
+static void runBatchRenderJob(std::vector<BatchEntry> &entries, RenderQueue::Result &result)
+{
+     BackendPool &pool = BackendPool::instance();
+     BackendLease lease(pool, nodesWithoutBatches());
+     if (!lease.valid())
+          return;
+     ApiConnection api_connection = lease.connection();
+
+     std::vector<BatchFrame> frames;
+     for (auto &entry : entries)
+     {
+          if (!entry.job.img_param.empty())
+               uploadSourceImage(api_connection, entry.job);
+          frames.push_back(BatchFrame{entry.frame, entry.job.request.json()});
+     }
+
+     const RenderJob &first_job = entries.front().job;
+     std::string job_id = api_connection.callEndpointBatch(first_job.plugin_name, first_job.endpoint_name, frames);
+     if (job_id.empty())
+     {
+          // unpublished frames are prefetched again, one by one once the node is known not to take batches
+          LogWarning("Backend " + lease.node().base_url + " could not run the batch");
+          return;
+     }
+
+     std::chrono::high_resolution_clock::time_point frame_start = std::chrono::high_resolution_clock::now();
+     api_connection.streamBatchResults(job_id, frames.size(), [&](const BatchFrameResult &frame_result)
+     {
+          auto entry = std::find_if(entries.begin(), entries.end(), [&](const BatchEntry &candidate) { return candidate.frame == frame_result.frame; });
+          if (entry == entries.end())
+               return;
+
+          std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
+          entry->job.elapsed = now - frame_start;
+          frame_start = now;
+          if (frame_result.status == JOB_STATUS_SUCCESS)
+          {
+               entry->job.img_id = frame_result.img_id;
+               entry->job.node_url = lease.node().base_url;
+          }
+          else
+          {
+               LogWarning("Batch frame " + std::to_string(entry->frame) + " failed: " + stringFromJobStatus(frame_result.status));
+          }
+
+          if (entry == entries.begin())
+          {
+               result.success = !entry->job.img_id.empty();
+               result.image_id = entry->job.img_id;
+               result.node_url = entry->job.node_url;
+               result.seconds = entry->job.elapsed.count();
+               return;
+          }
+          RenderQueue::Result published;
+          published.instance_id = entry->job.instance_id;
+          published.render_key = entry->render_key;
+          published.frame = entry->frame;
+          published.success = !entry->job.img_id.empty();
+          published.image_id = entry->job.img_id;
+          published.node_url = entry->job.node_url;
+          published.seconds = entry->job.elapsed.count();
+          published.lane = RenderLane::Prefetch;
+          RenderQueue::instance().publish(published);
+     });
+
+     // decoded by the time the host gets to the frames, and kept on disk for later sessions
+     for (auto &entry : entries)
+     {
+          if (entry.job.img_id.empty())
+               continue;
+          std::string encoded_img;
+          ArkImagePtr img = api_connection.getImage(entry.job.img_id, &encoded_img);
+          if (img && entry.job.disk_cacheable && !encoded_img.empty())
+               DiskResultCache::instance().store(entry.job.disk_key, encoded_img);
+     }
+}
+
+// Renders the frames one job each, the upload of a frame, the inference of the one before
+// and the download of the one before that overlap. Results are published as each download
+// finishes, the first entry's goes into result like a single job's would
+static void runPipelinedRenderJobs(std::vector<BatchEntry> &entries, RenderQueue::Result &result)
+{
+     RenderPipeline<BatchEntry *> pipeline(
+          [](BatchEntry *&entry) { return uploadRenderJob(entry->job); },
+          [](BatchEntry *&entry) { return inferRenderJob(entry->job); },
+          [](BatchEntry *&entry) { return downloadRenderJob(entry->job); },
+          kPipelineQueueDepth);
+
+     pipeline.start([&](BatchEntry *&entry, bool success)
+     {
+          entry->job.lease.reset();
+          if (entry == &entries.front())
+          {
+               result.success = success;
+               result.image_id = entry->job.img_id;
+               result.node_url = entry->job.node_url;
+               result.seconds = entry->job.elapsed.count();
+               return;
+          }
+          RenderQueue::Result published;
+          published.instance_id = entry->job.instance_id;
+          published.render_key = entry->render_key;
+          published.frame = entry->frame;
+          published.success = success;
+          published.image_id = entry->job.img_id;
+          published.node_url = entry->job.node_url;
+          published.seconds = entry->job.elapsed.count();
+          published.lane = RenderLane::Prefetch;
+          RenderQueue::instance().publish(published);
+     });
+     for (auto &entry : entries)
+          pipeline.submit(&entry);
+     pipeline.finish();
+     LogInfo("Pipelined " + std::to_string(entries.size()) + " frames, stalls upload/inference " +
+             std::to_string(pipeline.uploadStalls()) + "/" + std::to_string(pipeline.inferStalls()));
+}
+
+using FrameRangeRun = void (*)(std::vector<BatchEntry> &entries, RenderQueue::Result &result);
+
+static bool submitFrameRange(uint64_t instance_id, std::vector<BatchEntry> entries, FrameRangeRun run)
+{
+     std::vector<std::pair<uint64_t, int>> frames;
+     for (const auto &entry : entries)
+          frames.emplace_back(entry.render_key, entry.frame);
+
+     std::shared_ptr<std::vector<BatchEntry>> queued_entries = std::make_shared<std::vector<BatchEntry>>(std::move(entries));
+     return RenderQueue::instance().submitBatch(instance_id, frames,
+          [queued_entries, run](RenderQueue::Result &result)
+          {
+               run(*queued_entries, result);
+          },
+          RenderLane::Prefetch);
 }
 
 bool AIRendererFilter::addEndpointParams(FilterConfig &filter_config)
@@ -463,12 +1183,14 @@ bool AIRendererFilter::addEndpointParams(FilterConfig &filter_config)
 bool AIRendererFilter::getSelectedFilterConfig(VideoHost &host, FilterConfig &filter_config)
 {   
      int menuId = filter_config.name() == SELECT_PLUGIN_MESSAGE ? 0 : s_param_cache.getIdForStringId(PLUGIN_MENU_STRING_ID);
-     ParamValue menuValue = host.getParamValue(menuId);
+     ParamValue menuValue = host.paramSnapshot().value(menuId);
      int menuIndex = std::get<int>(menuValue);
      ApiConnection api_connection;
+     std::unique_lock<std::mutex> lock(s_filter_configs_mutex);
      if (menuIndex < s_filter_configs.size())
      {
           filter_config = s_filter_configs[menuIndex];
+          lock.unlock();
           m_selected_filter_name = filter_config.name();
           filter_config.required_license = api_connection.getPluginSubscriptionLevelRequirement(filter_config.plugin().plugin_name);
           LogInfo("Selected filter: " + m_selected_filter_name+ "\n");
@@ -481,7 +1203,7 @@ bool AIRendererFilter::getSelectedEndpoint(VideoHost &host, FilterConfig &filter
 {
      if (filter_config.endpoint_param_id != -1)
      {
-          ParamValue menuValue = host.getParamValue(filter_config.endpoint_param_id);
+          ParamValue menuValue = host.paramSnapshot().value(filter_config.endpoint_param_id);
           int menuIndex = std::get<int>(menuValue);
           if (menuIndex < filter_config.plugin().endpoints.size())
           {
@@ -493,66 +1215,41 @@ bool AIRendererFilter::getSelectedEndpoint(VideoHost &host, FilterConfig &filter
      return false;
 }
 
-bool AIRendererFilter::getEndpointParams(VideoHost &host, Endpoint &endpoint, std::string &params)
+bool AIRendererFilter::getEndpointParams(VideoHost &host, Endpoint &endpoint, EndpointRequestBuilder &request)
 {
      bool success = false;
-     params = "{";
+     const ParamSnapshot &param_values = host.paramSnapshot();
+     request.clear();
 
      for (const auto &input_param : endpoint.inputParams())
      {
           if (input_param.type == ParameterType::IntSlider)
           {
-               ParamValue intParamValue = host.getParamValue(input_param.id);
-               int intValue = int(std::get<float>(intParamValue));
-               if (params.size() > 1)
-               {
-                    params += ", ";
-               }
-               params += "\"" + input_param.name + "\": " + std::to_string(intValue);
+               ParamValue intParamValue = param_values.value(input_param.id);
+               request.addInt(input_param.name, int(std::get<float>(intParamValue)));
           }
           else if (input_param.type == ParameterType::Text)
           {
-               std::string prompt = host.getTextPrompt();
-               if (params.size() > 1)
-               {
-                    params += ", ";
-               }
-               params += "\"prompt\": \"" + prompt + "\"";
+               request.addString("prompt", host.getTextPrompt());
                success = true;
           }
           else if (input_param.type == ParameterType::Image_List)
           {
-               if (params.size() > 1)
-               {
-                    params += ", ";
-               }
-               params += "\"" + input_param.name + "\": [\"" + input_param.string_val + "\"]";
+               request.addStringList(input_param.name, input_param.image_list);
           }
           else if (input_param.type == ParameterType::Image)
           {
-               if (params.size() > 1)
-               {
-                    params += ", ";
-               }
-               params += "\"" + input_param.name + "\": \"" + input_param.string_val + "\"";
+               request.addString(input_param.name, input_param.string_val);
           }
           else if (input_param.type == ParameterType::Boolean)
           {
-               ParamValue paramValue = host.getParamValue(input_param.id);
-               bool boolValue = bool(std::get<bool>(paramValue));
-               if (params.size() > 1)
-               {
-                    params += ", ";
-               }
-               params += "\"" + input_param.name + "\": " + (boolValue ? "true" : "false");
+               ParamValue paramValue = param_values.value(input_param.id);
+               request.addBool(input_param.name, bool(std::get<bool>(paramValue)));
           }
           else if (input_param.type == ParameterType::FloatSlider)
           {
-               ParamValue paramValue = host.getParamValue(input_param.id);
-               float floatValue = std::get<float>(paramValue);
-               if (params.size() > 1)
-                    params += ", ";
-               params += "\"" + input_param.name + "\": " + std::to_string(floatValue);
+               ParamValue paramValue = param_values.value(input_param.id);
+               request.addFloat(input_param.name, std::get<float>(paramValue));
           }
           else
           {
@@ -560,8 +1257,6 @@ bool AIRendererFilter::getEndpointParams(VideoHost &host, Endpoint &endpoint, st
                LOG_ASSERT(false, "AIRendererFilter::getEndpointParams: Unsupported parameter type" + type_string);
           }
      }
-     params += "}";
-     LogInfo("Endpoint Params: " + params);
      return success;
 }
 
@@ -603,7 +1298,9 @@ bool AIRendererFilter::render(VideoHost &host)
      ArkImagePtr destImg = host.destImg();
      int downSampleX = host.getDelegate()->downsampleX();
      int downSampleY = host.getDelegate()->downSampleY();
-     if (IsBackendStarted())
+     // the breakers already know whether the backend answers, probing it here would hold
+     // every frame up for the status timeout while it's down
+     if (BackendPool::instance().hasAvailableNode())
      {
           FilterConfig filter_config;
           if (!getSelectedFilterConfig(host, filter_config))
@@ -623,7 +1320,7 @@ bool AIRendererFilter::render(VideoHost &host)
                return false;
           }
           LogInfo("Endpoint Name:" + endpoint.name);
-          ApiConnection api_connection;
+          BackendPool &pool = BackendPool::instance();
           // if the prompt hasn't been set just return the source
           if ( endpoint.has_prompt && host.getTextPrompt().empty())
           {
@@ -631,118 +1328,392 @@ bool AIRendererFilter::render(VideoHost &host)
                return copyImage(sourceImg, destImg, downSampleX, downSampleY);
           }
 
-          std::string endpoint_params;
-          std::string cached_params = host.getCachedParams();
-          getEndpointParams(host, endpoint, endpoint_params);
-          if (endpoint_params != cached_params)
+          // one per render thread, its buffers are reused from render to render
+          static thread_local EndpointRequestBuilder request;
+          getEndpointParams(host, endpoint, request);
+
+          // results are indexed by frame and by the params before any image ids are filled in,
+          // the source pixels go into the key too so a change upstream isn't served a stale result
+          int frame = host.getDelegate()->currentFrame();
+          uint64_t params_hash = request.hash();
+          uint64_t source_hash = imageContentHash(sourceImg);
+          // while the host renders at a reduced resolution the inputs are sent shrunk to it,
+          // the result is kept apart from the full resolution one
+          int proxy_scale = proxyScale(host, endpoint);
+          uint64_t render_key = renderKey(params_hash, source_hash, proxy_scale);
+
+          // the last rendered image only stands in while nothing it was made from has changed,
+          // for endpoints that take the source image that includes its pixels
+          bool takes_source = !endpoint.getInputImgParam().empty() || !endpoint.getInputImgListParams().empty();
+          uint64_t rendered_key = takes_source ? render_key : params_hash;
+          // stands in for the new result while a queued render is running
+          std::string last_image_id = host.getRenderedImageID();
+          if (rendered_key != host.getCachedParamsHash())
           {
                LogInfo("Endpoint params have changed, invalidating rendered image\n");
                invalidateRenderedImage(host);
           }
 
-          std::string render_image_id = host.getRenderedImageID();
-          if (!render_image_id.empty())
+          RenderResultIndex render_index;
+          render_index.deserialize(host.getRenderIndex());
+
+          // queued renders that finished since the last call go in the index, this frame's is served from there
+          uint64_t instance_id = host.getDelegate()->instanceId();
+          RenderQueue &render_queue = RenderQueue::instance();
+          takeFinishedRenders(host, render_index, frame, render_key, rendered_key);
+          if (instance_id != 0)
+               UploadedFrameRing::instance().checkFrame(instance_id, frame, source_hash);
+
+          // interactive renders are queued when the host can be told to render again once the result is in,
+          // progressive ones show a draft of the frame while the full render runs
+          bool async_render = instance_id != 0 &&
+                              ApiConnection::asyncRenderEnabled() &&
+                              host.getDelegate()->isInteractiveRender();
+          int draft_scale = std::min(proxy_scale * kDraftScale, kMaxProxyScale);
+          bool progressive = async_render && takes_source && draft_scale > proxy_scale && ApiConnection::progressiveRenderEnabled();
+
+          // while the user works an instance waits on one render at a time, what it queued or started
+          // for other params is dropped rather than left to occupy the backend
+          if (instance_id != 0 && host.getDelegate()->isInteractiveRender())
+          {
+               InFlightJobs &in_flight = InFlightJobs::instance();
+               size_t dropped = 0;
+               if (!in_flight.isCurrent(instance_id, params_hash))
+                    dropped = render_queue.cancelQueued(instance_id, RenderLane::Interactive);
+               size_t superseded = in_flight.supersede(instance_id, params_hash);
+               if (dropped + superseded > 0)
+                    LogInfo("New params dropped " + std::to_string(dropped) + " queued and " + std::to_string(superseded) + " running renders");
+          }
+
+          // frames ahead are only worth rendering while the params stay put, work queued for older ones is dropped
+          bool prefetch = false;
+          if (instance_id != 0 && takes_source)
           {
-               ArkImagePtr img = api_connection.getImage(render_image_id);
+               prefetch = FramePrefetcher::instance().paramsStable(instance_id, params_hash);
+               if (!prefetch)
+                    render_queue.cancelQueued(instance_id, RenderLane::Prefetch);
+          }
+
+          std::string indexed_image_id;
+          std::string indexed_node_url;
+          if (render_index.find(frame, render_key, indexed_image_id, &indexed_node_url))
+          {
+               ArkImagePtr img = ApiConnection(pool.nodeForUrl(indexed_node_url)).getImage(indexed_image_id);
                if (img)
                {
-                    LogInfo("Using cached image");
-                    copyImage(img, destImg, downSampleX, downSampleY);
-                    return true;
+                    LogInfo("Using indexed result for frame " + std::to_string(frame));
+                    double seconds = RenderLatency::instance().finished(instance_id, render_key);
+                    if (seconds >= 0.0)
+                         LogInfo("Queued render of frame " + std::to_string(frame) + " shown after " + std::to_string(static_cast<int>(seconds * 1000.0)) + "ms");
+                    if (prefetch)
+                         prefetchFrames(host, filter_config, endpoint, request, frame, params_hash, render_index);
+                    host.setRenderIndex(render_index.serialize());
+                    return writeRenderedImage(host, endpoint, img);
                }
+               render_index.remove(frame, render_key);
           }
 
-          std::string img_param = endpoint.getInputImgParam();
-          std::vector<std::string> img_params = endpoint.getInputImgListParams();
-          if (img_params.size() > 0)
+          // results from earlier sessions, temporal endpoints are left out since their
+          // output also depends on the neighbouring frames which aren't part of the key
+          bool disk_cacheable = isDiskCacheable(endpoint);
+          uint64_t disk_key = diskResultKey(filter_config, endpoint, render_key);
+          std::string disk_data;
+          if (disk_cacheable && DiskResultCache::instance().load(disk_key, disk_data))
           {
-               handleMultiImageRequest(img_params, host, endpoint);
-               getEndpointParams(host, endpoint, endpoint_params);
+               ArkImagePtr img = ::getImage(disk_data);
+               if (img)
+               {
+                    LogInfo("Using result cached on disk for frame " + std::to_string(frame));
+                    if (prefetch)
+                         prefetchFrames(host, filter_config, endpoint, request, frame, params_hash, render_index);
+                    return writeRenderedImage(host, endpoint, img);
+               }
           }
-          else if (!img_param.empty())
+
+          // while the user is still working, a draft of the frame scaled up beats waiting on a full resolution render
+          if (proxy_scale == 1 && takes_source && !progressive && ApiConnection::proxyUpscaleEnabled() && host.getDelegate()->isInteractiveRender())
           {
-               handleImageRequest(img_param, endpoint, sourceImg);
-               getEndpointParams(host, endpoint, endpoint_params);
+               ArkImagePtr img = proxyResult(filter_config, endpoint, render_index, frame, params_hash, source_hash);
+               if (img)
+               {
+                    LogInfo("Using a draft result scaled up for frame " + std::to_string(frame));
+                    return writeRenderedImage(host, endpoint, img);
+               }
           }
 
-          std::string job_id = api_connection.callEndpoint(filter_config.name(), endpoint.name, endpoint_params);
-          if (job_id.empty())
+          // nothing cached and the backend isn't answering, show the source rather than hold the host up
+          if (!pool.hasAvailableNode())
           {
-               LogError("Error executing plugin");
-               return false;
+               LogWarning("Backend unavailable, passing the source through");
+               return copyImage(sourceImg, destImg, downSampleX, downSampleY);
           }
 
-          int loopCycleCount = 0;
-          std::chrono::high_resolution_clock::time_point start_time = std::chrono::high_resolution_clock::now();
-          // wait for the job to complete
-          JobStatusResponse job_response = api_connection.jobStatus(job_id);
-          while (job_response.status == JOB_STATUS_IN_PROGRESS)
+          std::string render_image_id = host.getRenderedImageID();
+          std::string render_node_url;
+          if (!render_image_id.empty())
           {
-               job_response = api_connection.jobStatus(job_id);
-               arkSleepMS(cachedElasedTime);
-               job_response = api_connection.jobStatus(job_id);
-               LogInfo("Job Response: " + stringFromJobStatus(job_response.status));
-               loopCycleCount += 1;
-
-               if (loopCycleCount > 5)
+               // the host only keeps the id, the node it was rendered on is in the index
+               render_index.findNode(render_image_id, render_node_url);
+               ArkImagePtr img = ApiConnection(pool.nodeForUrl(render_node_url)).getImage(render_image_id);
+               if (img)
                {
-                    LogError(job_id + ": Job timed out", true);
-                    break;
+                    LogInfo("Using cached image");
+                    return writeRenderedImage(host, endpoint, img);
                }
           }
 
-          if (job_response.status == JOB_STATUS_SUCCESS)
+          if (async_render)
           {
-               ArkImagePtr img = api_connection.getImage(job_response.img_id);
-               if (img)
+               RenderQueue::Completion on_done = rerenderOnSuccess(host.getDelegate()->renderCompletion());
+               auto queue_render = [&](uint64_t key, int scale)
                {
-                    host.setCachedParams(endpoint_params);
-                    host.setRenderedImageID(job_response.img_id);
-
-                    if (endpoint.outputIsMask())
-                    {
-                         copyImage(sourceImg, destImg);
-                         if (img->width() < destImg->width() ||
-                             img->height() < destImg->height())
-                         {
-                              ArkImage *resizedImg = resizeImageUp(img.get(), destImg->width(), destImg->height());
-                              if (resizedImg)
-                                   img.reset(resizedImg);
-                         }
-                         img->setChannelOrder(AAA);
-
-                         copyAlphaToImage(img, destImg);
-                    }
-                    else
+                    // already on its way, possibly as a prefetch that now has somebody waiting for it
+                    if (render_queue.promote(instance_id, key, frame, on_done))
+                         return;
+                    RenderJob job;
+                    prepareRenderJob(host, filter_config, endpoint, request, frame, sourceImg, key, scale, true, job);
+                    submitRenderJob(instance_id, key, frame, std::move(job), on_done, RenderLane::Interactive);
+               };
+               RenderLatency::instance().requested(instance_id, render_key);
+
+               // the draft goes first, the full render is only queued once the draft is on screen
+               if (progressive)
+               {
+                    uint64_t draft_key = renderKey(params_hash, source_hash, draft_scale);
+                    ArkImagePtr draft = cachedResult(filter_config, endpoint, render_index, frame, draft_key);
+                    if (draft)
                     {
-                         copyImage(img, destImg, downSampleX, downSampleY);
+                         double seconds = RenderLatency::instance().firstFeedback(instance_id, render_key);
+                         if (seconds >= 0.0)
+                              LogInfo("Draft of frame " + std::to_string(frame) + " shown after " + std::to_string(static_cast<int>(seconds * 1000.0)) + "ms");
+                         queue_render(render_key, proxy_scale);
+                         return writeRenderedImage(host, endpoint, draft);
                     }
+                    queue_render(draft_key, draft_scale);
+                    LogInfo("Draft render of frame " + std::to_string(frame) + " queued, showing a placeholder until it's done");
+                    return writePlaceholderImage(host, endpoint, render_index, last_image_id);
+               }
 
-                    std::chrono::high_resolution_clock::time_point end_time = std::chrono::high_resolution_clock::now();
-                    std::chrono::duration<double> timeElapsed = end_time - start_time;
-
-                    if (timeElapsed < cachedElasedTime)
-                    {
-                         cachedElasedTime = std::chrono::duration_cast<std::chrono::seconds>(timeElapsed);
-                    }
+               queue_render(render_key, proxy_scale);
+               LogInfo("Render of frame " + std::to_string(frame) + " queued, showing a placeholder until it's done");
+               return writePlaceholderImage(host, endpoint, render_index, last_image_id);
+          }
 
-                    LogInfo("Job took " + std::to_string(timeElapsed.count()) + " s");
-                    if (m_imageMap.size() > 0)
+          // a prefetch of this frame may already be running, waiting for it beats starting over
+          if (instance_id != 0 && render_queue.waitFor(instance_id, render_key, frame))
+          {
+               takeFinishedRenders(host, render_index, frame, render_key, rendered_key);
+               if (render_index.find(frame, render_key, indexed_image_id, &indexed_node_url))
+               {
+                    ArkImagePtr img = ApiConnection(pool.nodeForUrl(indexed_node_url)).getImage(indexed_image_id);
+                    if (img)
                     {
-                         m_imageMap.clear();
-                         LogInfo("Image Map Cleared");
+                         LogInfo("Using prefetched result for frame " + std::to_string(frame));
+                         if (prefetch)
+                              prefetchFrames(host, filter_config, endpoint, request, frame, params_hash, render_index);
+                         host.setRenderIndex(render_index.serialize());
+                         return writeRenderedImage(host, endpoint, img);
                     }
-                    return true;
                }
           }
+
+          RenderJob job;
+          prepareRenderJob(host, filter_config, endpoint, request, frame, sourceImg, render_key, proxy_scale, false, job);
+          if (!runRenderJob(job))
+          {
+               if (!pool.hasAvailableNode())
+                    return copyImage(sourceImg, destImg, downSampleX, downSampleY);
+               return false;
+          }
+
+          host.setCachedParamsHash(rendered_key);
+          host.setRenderedImageID(job.img_id);
+          render_index.add(frame, render_key, job.img_id, job.node_url);
+          rememberJobTime(job.elapsed);
+          if (prefetch)
+               prefetchFrames(host, filter_config, endpoint, request, frame, params_hash, render_index);
+          host.setRenderIndex(render_index.serialize());
+          writeRenderedImage(host, endpoint, job.img);
+          return true;
+     }
+     LogWarning("Backend unavailable, passing the source through");
+     return copyImage(sourceImg, destImg, downSampleX, downSampleY);
+}
+
+void AIRendererFilter::takeFinishedRenders(VideoHost &host, RenderResultIndex &render_index, int frame, uint64_t render_key, uint64_t rendered_key)
+{
+     uint64_t instance_id = host.getDelegate()->instanceId();
+     std::vector<RenderQueue::Result> finished;
+     if (instance_id == 0 || !RenderQueue::instance().takeResults(instance_id, finished))
+          return;
+
+     for (const auto &result : finished)
+     {
+          if (!result.success)
+          {
+               LogWarning("Queued render of frame " + std::to_string(result.frame) + " failed");
+               continue;
+          }
+          render_index.add(result.frame, result.render_key, result.image_id, result.node_url);
+          rememberJobTime(std::chrono::duration<double>(result.seconds));
+          if (result.frame == frame && result.render_key == render_key)
+          {
+               host.setCachedParamsHash(rendered_key);
+               host.setRenderedImageID(result.image_id);
+          }
+     }
+     host.setRenderIndex(render_index.serialize());
+}
+
+void AIRendererFilter::prepareRenderJob(VideoHost &host, FilterConfig &filter_config, Endpoint &endpoint, const EndpointRequestBuilder &request,
+                                        int frame, ArkImagePtr source, uint64_t render_key, int proxy_scale, bool detach, RenderJob &job)
+{
+     job.instance_id = host.getDelegate()->instanceId();
+     job.plugin_name = filter_config.name();
+     job.endpoint_name = endpoint.name;
+     job.request = request;
+     job.params_hash = job.request.hash();
+     job.supersedable = host.getDelegate()->isInteractiveRender();
+     job.disk_cacheable = isDiskCacheable(endpoint);
+     job.disk_key = diskResultKey(filter_config, endpoint, render_key);
+     job.proxy_scale = proxy_scale;
+     job.poll_interval = cachedElasedTime;
+     gatherFrameImages(host, endpoint, job, frame, detach);
+     if (job.frame_params.empty())
+     {
+          job.img_param = endpoint.getInputImgParam();
+          if (job.img_param.empty())
+               return;
+          // the shrunk copy is ours already
+          if (job.proxy_scale > 1)
+               job.source = downscaleImage(source, job.proxy_scale);
           else
+               job.source = detach ? cloneImage(source) : source;
+     }
+}
+
+void AIRendererFilter::prefetchFrames(VideoHost &host, FilterConfig &filter_config, Endpoint &endpoint, const EndpointRequestBuilder &request,
+                                      int frame, uint64_t params_hash, RenderResultIndex &render_index)
+{
+     uint64_t instance_id = host.getDelegate()->instanceId();
+     int last_frame = host.getDelegate()->durationFrames() - 1;
+     std::vector<int> frames = FramePrefetcher::instance().framesToPrefetch(instance_id, params_hash, frame, last_frame);
+     int proxy_scale = proxyScale(host, endpoint);
+     // frames rendered on their own inputs alone can go to the backend as one batch job,
+     // the others are pipelined
+     bool batch = frames.size() > 1 && isDiskCacheable(endpoint) && nodesWithoutBatches().size() < BackendPool::instance().size();
+     std::vector<BatchEntry> entries;
+     for (int next_frame : frames)
+     {
+          ArkImagePtr source = host.getImgAtFrame(next_frame);
+          if (!source)
+               continue;
+
+          // keyed the same way render() keys the frame once the host asks for it
+          uint64_t render_key = renderKey(params_hash, imageContentHash(source), proxy_scale);
+          std::string indexed_image_id;
+          if (render_index.find(next_frame, render_key, indexed_image_id))
+               continue;
+          if (isDiskCacheable(endpoint) && DiskResultCache::instance().contains(diskResultKey(filter_config, endpoint, render_key)))
+               continue;
+          if (RenderQueue::instance().isPending(instance_id, render_key, next_frame))
+               continue;
+
+          RenderJob job;
+          prepareRenderJob(host, filter_config, endpoint, request, next_frame, source, render_key, proxy_scale, true, job);
+          entries.push_back(BatchEntry{next_frame, render_key, std::move(job)});
+     }
+
+     if (entries.size() == 1)
+     {
+          BatchEntry &entry = entries.front();
+          if (submitRenderJob(instance_id, entry.render_key, entry.frame, std::move(entry.job), nullptr, RenderLane::Prefetch))
+               LogInfo("Prefetching frame " + std::to_string(entry.frame));
+     }
+     else if (entries.size() > 1)
+     {
+          std::string range = std::to_string(entries.front().frame) + "-" + std::to_string(entries.back().frame);
+          if (submitFrameRange(instance_id, std::move(entries), batch ? runBatchRenderJob : runPipelinedRenderJobs))
+               LogInfo("Prefetching frames " + range + (batch ? " as one batch" : " pipelined"));
+     }
+}
+
+bool AIRendererFilter::writePlaceholderImage(VideoHost &host, Endpoint &endpoint, RenderResultIndex &render_index, const std::string &last_image_id)
+{
+     // the previous result is usually closer to the final image than the source is
+     std::string image_id = last_image_id;
+     std::string node_url;
+     if (!image_id.empty())
+          render_index.findNode(image_id, node_url);
+     else
+          image_id = RenderQueue::instance().lastImageId(host.getDelegate()->instanceId(), &node_url);
+
+     if (!image_id.empty())
+     {
+          ArkImagePtr img = ApiConnection(BackendPool::instance().nodeForUrl(node_url)).getImage(image_id);
+          if (img)
+               return writeRenderedImage(host, endpoint, img);
+     }
+     return copyImage(host.sourceImg(), host.destImg(), host.getDelegate()->downsampleX(), host.getDelegate()->downSampleY());
+}
+
+void AIRendererFilter::rememberJobTime(std::chrono::duration<double> elapsed)
+{
+     FramePrefetcher::instance().recordJobTime(elapsed.count());
+     if (elapsed < cachedElasedTime)
+     {
+          cachedElasedTime = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed);
+     }
+}
+
+// the factor left to shrink a result by, for a host downsampling its source by host_downsample
+static int resultDownsample(int host_downsample, int result_size, int source_size)
+{
+     if (source_size <= 0)
+          return host_downsample;
+     return std::max(1, (host_downsample * result_size + source_size / 2) / source_size);
+}
+
+bool AIRendererFilter::writeRenderedImage(VideoHost &host, Endpoint &endpoint, ArkImagePtr img)
+{
+     ArkImagePtr sourceImg = host.sourceImg();
+     ArkImagePtr destImg = host.destImg();
+     int downSampleX = host.getDelegate()->downsampleX();
+     int downSampleY = host.getDelegate()->downSampleY();
+
+     if (!endpoint.outputIsMask())
+     {
+          // a result rendered at proxy resolution has less of the host's downsampling left to go
+          downSampleX = resultDownsample(downSampleX, img->width(), sourceImg->width());
+          downSampleY = resultDownsample(downSampleY, img->height(), sourceImg->height());
+          // and one rendered for less than the host wants now is scaled up to it
+          if (img->width() < destImg->width() || img->height() < destImg->height())
           {
-               LogError("Job failed: " + stringFromJobStatus(job_response.status), true);
+               ArkImage *resizedImg = resizeImageUp(img.get(), destImg->width(), destImg->height());
+               if (resizedImg)
+               {
+                    img.reset(resizedImg);
+                    downSampleX = 1;
+                    downSampleY = 1;
+               }
           }
+          return copyImage(img, destImg, downSampleX, downSampleY);
+     }
 
-          return false;
+     copyImage(sourceImg, destImg);
+     if (img->width() < destImg->width() ||
+         img->height() < destImg->height())
+     {
+          ArkImage *resizedImg = resizeImageUp(img.get(), destImg->width(), destImg->height());
+          if (resizedImg)
+               img.reset(resizedImg);
      }
-     return false;
+
+     // img can be shared with the decoded image cache, so read it as a mask through a view
+     // rather than changing its channel order
+     std::shared_ptr<ImageBuffer> mask = std::make_shared<ImageBuffer>();
+     mask->init(static_cast<unsigned char *>(img->data()), img->width(), img->height(), img->format(), AAA);
+     return copyAlphaToImage(mask, destImg);
 }
 
 bool AIRendererFilter::handleOverlayEvent(VideoHost &host, MouseEventType eventType, int x, int y)
@@ -886,7 +1857,7 @@ bool AIRendererFilter::updateParams(VideoHost &host, int changedParamID)
                std::string endpoint_menu_id = endpointMenuId(selected_filter_config.plugin().plugin_name);
 
                int menuId = s_param_cache.getIdForStringId(PLUGIN_MENU_STRING_ID);
-               ParamValue menuValue = host.getParamValue(menuId);
+               ParamValue menuValue = host.paramSnapshot().value(menuId);
                int menuIndex = std::get<int>(menuValue);
 
                // assert(menuIndex < s_filter_configs.size());
@@ -4,11 +4,15 @@
 #include "video_filter.h"
 #include "ark_plugin.h"
 #include <map>
+#include <chrono>
+#include <mutex>
 #include "plugin_defs.h"
 #include "param_cache.h"
-#ifdef _WIN32   
-#include <chrono>
-#endif
+
+class ApiConnection;
+class EndpointRequestBuilder;
+class RenderResultIndex;
+struct RenderJob;
 
 class FilterConfig
 {
@@ -75,8 +79,9 @@ public:
     virtual ParameterPtr getParamWithStringId(const std::string&stringId) override;
     virtual void addPersistentParam(ParameterPtr param) override;
     virtual void clearPersistentParams() override {m_persistent_params.clear();};
-    std::map<std::string,std::string> m_imageMap;
     bool IsBackendStarted();
+    // re-reads the plugin's config once its config dialog is closed, results are cached on disk under it
+    void refreshPluginConfig(const std::string &plugin_name);
 protected:
 
      
@@ -84,6 +89,9 @@ protected:
     void hideAllParams(VideoHost &host);
     void invalidateRenderedImage(VideoHost &host);
     void fetchFilterConfigs();
+    void refreshCatalogueSnapshot(const std::vector<ArkPlugin> &snapshot_plugins);
+    // takes the version and config of plugins that changed on the backend, returns how many did
+    static int applyCatalogueChanges(const std::vector<ArkPlugin> &plugins);
     void addFilterMenu();
     void addRegenerateButton();
     void addFilterParams();
@@ -93,14 +101,23 @@ protected:
     void AddConfigGroupStart(FilterConfig &filter_config);
     void AddConfigGroupEnd(FilterConfig &filter_config);
     void syncParamWithCachedParam(ParameterPtr param);
-    void handleMultiImageRequest(const std::vector<std::string> &img_params, VideoHost &host, Endpoint &endpoint);
-    void handleImageRequest(const std::string &img_param, Endpoint &endpoint, ArkImagePtr sourceImg);
+    // the img_before/img_after frames, detach copies them for renders that outlive the host call
+    void gatherFrameImages(VideoHost &host, Endpoint &endpoint, RenderJob &job, int frame, bool detach);
+    // the inputs are sent shrunk by proxy_scale, detach copies the source too for jobs that go on the render queue
+    void prepareRenderJob(VideoHost &host, FilterConfig &filter_config, Endpoint &endpoint, const EndpointRequestBuilder &request,
+                          int frame, ArkImagePtr source, uint64_t render_key, int proxy_scale, bool detach, RenderJob &job);
+    void takeFinishedRenders(VideoHost &host, RenderResultIndex &render_index, int frame, uint64_t render_key, uint64_t rendered_key);
+    void prefetchFrames(VideoHost &host, FilterConfig &filter_config, Endpoint &endpoint, const EndpointRequestBuilder &request,
+                        int frame, uint64_t params_hash, RenderResultIndex &render_index);
     bool shouldShowPromptUI(int changedParamID);
     bool showPromptUI(VideoHost &host, int textParamID);
 
     bool getSelectedFilterConfig(VideoHost &host, FilterConfig &filter_config);
     bool getSelectedEndpoint(VideoHost &host, FilterConfig &filter_config, Endpoint &out_endpoint);
-    bool getEndpointParams(VideoHost &host, Endpoint &out_endpoint, std::string &params);
+    bool getEndpointParams(VideoHost &host, Endpoint &out_endpoint, EndpointRequestBuilder &request);
+    bool writeRenderedImage(VideoHost &host, Endpoint &endpoint, ArkImagePtr img);
+    bool writePlaceholderImage(VideoHost &host, Endpoint &endpoint, RenderResultIndex &render_index, const std::string &last_image_id);
+    void rememberJobTime(std::chrono::duration<double> elapsed);
     bool hasBackendStartupTimedout(int maxAttempts);
     
     //eventually these should be pulled from the filter defs for each filter
@@ -110,10 +127,12 @@ protected:
     std::string m_selected_filter_name;
     //Temp hack to avoid calling the get_info endpoint just to build params
     static std::vector<FilterConfig> s_filter_configs; //index matches the plugin menu index(should be a map of API filter IDs)
+    static std::mutex s_filter_configs_mutex; //renders copy their config while the UI thread may update one
 
     static ParamCache s_param_cache;
+    bool m_catalogue_from_snapshot = false;
     
-    std::chrono::seconds cachedElasedTime = std::chrono::seconds(10);
+    std::chrono::milliseconds cachedElasedTime = std::chrono::seconds(10);
     void handleCrashCheck();
 
 private:
@@ -0,0 +1,93 @@
+#include "frame_prefetcher.h"
+#include "render_queue.h"
+#include <algorithm>
+#include <cmath>
+
+// backend work worth queueing ahead of the frame being looked at
+static const double kPrefetchLookaheadSeconds = 10.0;
+static const int kMaxPrefetchDepth = 8;
+// weight of the newest job time, the average follows a change of model within a few jobs
+static const double kJobTimeSmoothing = 0.3;
+
+FramePrefetcher::FramePrefetcher(double lookahead_seconds, int max_depth, size_t prefetch_workers)
+: m_lookahead_seconds(lookahead_seconds)
+, m_max_depth(std::max(max_depth, 1))
+, m_prefetch_workers(std::max<size_t>(prefetch_workers, 1))
+{ }
+
+FramePrefetcher &FramePrefetcher::instance()
+{
+    // the render queue keeps one worker free of prefetch work
+    static FramePrefetcher prefetcher(kPrefetchLookaheadSeconds, kMaxPrefetchDepth,
+                                      std::max<size_t>(RenderQueue::instance().workerCount(), 2) - 1);
+    return prefetcher;
+}
+
+bool FramePrefetcher::paramsStable(uint64_t instance_id, uint64_t params_hash)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_instances.find(instance_id);
+    if (it != m_instances.end() && it->second.params_hash == params_hash)
+        return true;
+
+    InstanceState &state = m_instances[instance_id];
+    state.params_hash = params_hash;
+    state.handed_out.clear();
+    return false;
+}
+
+void FramePrefetcher::recordJobTime(double seconds)
+{
+    if (seconds <= 0.0)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_avg_job_seconds == 0.0)
+        m_avg_job_seconds = seconds;
+    else
+        m_avg_job_seconds += kJobTimeSmoothing * (seconds - m_avg_job_seconds);
+}
+
+int FramePrefetcher::depth() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_avg_job_seconds == 0.0)
+        return 1;
+
+    double frames = m_lookahead_seconds * static_cast<double>(m_prefetch_workers) / m_avg_job_seconds;
+    return std::clamp(static_cast<int>(std::floor(frames)), 1, m_max_depth);
+}
+
+double FramePrefetcher::averageJobSeconds() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_avg_job_seconds;
+}
+
+std::vector<int> FramePrefetcher::framesToPrefetch(uint64_t instance_id, uint64_t params_hash, int frame, int last_frame)
+{
+    int ahead = depth();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<int> frames;
+    auto it = m_instances.find(instance_id);
+    if (it == m_instances.end() || it->second.params_hash != params_hash)
+        return frames;
+
+    // frames behind the playhead are rendered or skipped, going back to them starts over
+    std::set<int> &handed_out = it->second.handed_out;
+    handed_out.erase(handed_out.begin(), handed_out.upper_bound(frame));
+
+    for (int next = frame + 1; next <= std::min(frame + ahead, last_frame); next++)
+    {
+        if (handed_out.insert(next).second)
+            frames.push_back(next);
+    }
+    return frames;
+}
+
+void FramePrefetcher::forget(uint64_t instance_id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_instances.erase(instance_id);
+}
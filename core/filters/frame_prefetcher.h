@@ -0,0 +1,50 @@
+#ifndef FRAME_PREFETCHER_H
+#define FRAME_PREFETCHER_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+
+// Works out which frames after the one just rendered are worth starting on. An instance
+// only prefetches once it renders again with the params it used last time, a slider
+// being dragged would otherwise queue work that is stale before it starts. How far ahead
+// it goes follows the backend's measured throughput: as many frames as the prefetch
+// workers get through in the lookahead window, at least one and at most max_depth.
+class FramePrefetcher
+{
+public:
+    FramePrefetcher(double lookahead_seconds, int max_depth, size_t prefetch_workers);
+
+    static FramePrefetcher &instance();
+
+    // true when params_hash is what the instance rendered with last time, remembers it either way
+    bool paramsStable(uint64_t instance_id, uint64_t params_hash);
+    // how long a backend job took, prefetched or not
+    void recordJobTime(double seconds);
+
+    int depth() const;
+    double averageJobSeconds() const;
+
+    // frames after frame, up to depth() of them and no further than last_frame, that haven't
+    // been handed out for these params yet
+    std::vector<int> framesToPrefetch(uint64_t instance_id, uint64_t params_hash, int frame, int last_frame);
+    void forget(uint64_t instance_id);
+
+protected:
+    struct InstanceState
+    {
+        uint64_t params_hash {0};
+        std::set<int> handed_out;
+    };
+
+    mutable std::mutex m_mutex;
+    std::map<uint64_t, InstanceState> m_instances;
+    double m_lookahead_seconds;
+    int m_max_depth;
+    size_t m_prefetch_workers;
+    double m_avg_job_seconds {0.0}; // 0 until the first job was measured
+};
+
+#endif // FRAME_PREFETCHER_H
@@ -0,0 +1,100 @@
+#include "in_flight_jobs.h"
+#include <algorithm>
+
+InFlightJobs &InFlightJobs::instance()
+{
+    static InFlightJobs jobs;
+    return jobs;
+}
+
+size_t InFlightJobs::supersede(uint64_t instance_id, uint64_t params_hash)
+{
+    size_t superseded = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_current_params[instance_id] = params_hash;
+        auto instance = m_jobs.find(instance_id);
+        if (instance == m_jobs.end())
+            return 0;
+
+        for (auto &job : instance->second)
+        {
+            if (job.params_hash != params_hash && !job.superseded)
+            {
+                job.superseded = true;
+                superseded++;
+            }
+        }
+        m_superseded_count += superseded;
+    }
+    if (superseded > 0)
+        m_superseded.notify_all();
+    return superseded;
+}
+
+bool InFlightJobs::isCurrent(uint64_t instance_id, uint64_t params_hash) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto current = m_current_params.find(instance_id);
+    return current == m_current_params.end() || current->second == params_hash;
+}
+
+bool InFlightJobs::add(uint64_t instance_id, uint64_t params_hash, const std::string &job_id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto current = m_current_params.find(instance_id);
+    if (current != m_current_params.end() && current->second != params_hash)
+    {
+        m_superseded_count++;
+        return false;
+    }
+    m_jobs[instance_id].push_back(Job{job_id, params_hash, false});
+    return true;
+}
+
+void InFlightJobs::remove(uint64_t instance_id, const std::string &job_id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto instance = m_jobs.find(instance_id);
+    if (instance == m_jobs.end())
+        return;
+
+    std::vector<Job> &jobs = instance->second;
+    jobs.erase(std::remove_if(jobs.begin(), jobs.end(), [&](const Job &job) { return job.job_id == job_id; }), jobs.end());
+    if (jobs.empty())
+        m_jobs.erase(instance);
+}
+
+bool InFlightJobs::waitSuperseded(uint64_t instance_id, const std::string &job_id, std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_superseded.wait_for(lock, timeout, [&]() { return isSuperseded(instance_id, job_id); });
+}
+
+size_t InFlightJobs::count(uint64_t instance_id) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto instance = m_jobs.find(instance_id);
+    return instance == m_jobs.end() ? 0 : instance->second.size();
+}
+
+size_t InFlightJobs::supersededCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_superseded_count;
+}
+
+// called with m_mutex held
+bool InFlightJobs::isSuperseded(uint64_t instance_id, const std::string &job_id) const
+{
+    auto instance = m_jobs.find(instance_id);
+    if (instance == m_jobs.end())
+        return false;
+
+    for (const auto &job : instance->second)
+    {
+        if (job.job_id == job_id)
+            return job.superseded;
+    }
+    return false;
+}
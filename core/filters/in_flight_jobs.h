@@ -0,0 +1,55 @@
+#ifndef IN_FLIGHT_JOBS_H
+#define IN_FLIGHT_JOBS_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// The backend jobs each effect instance has running, with the params they were started for.
+// Once an instance renders with other params, a slider being dragged or the prompt being
+// edited, the jobs it started for older params are superseded: their results would only be
+// thrown away, so the threads polling them are woken up to cancel them and stop. Thread safe.
+class InFlightJobs
+{
+public:
+    static InFlightJobs &instance();
+
+    // the instance renders with params_hash now, its jobs for other params are superseded.
+    // Returns how many were
+    size_t supersede(uint64_t instance_id, uint64_t params_hash);
+    // false once the instance has moved on from params_hash, a job for them isn't worth starting
+    bool isCurrent(uint64_t instance_id, uint64_t params_hash) const;
+
+    // false, and the job isn't tracked, when params_hash was superseded before it started
+    bool add(uint64_t instance_id, uint64_t params_hash, const std::string &job_id);
+    void remove(uint64_t instance_id, const std::string &job_id);
+    // waits up to timeout for the job to be superseded, true if it was. A job that isn't
+    // tracked just waits out the timeout, it can stand in for the sleep between two polls
+    bool waitSuperseded(uint64_t instance_id, const std::string &job_id, std::chrono::milliseconds timeout);
+
+    size_t count(uint64_t instance_id) const;
+    // jobs superseded since startup
+    size_t supersededCount() const;
+
+protected:
+    struct Job
+    {
+        std::string job_id;
+        uint64_t params_hash {0};
+        bool superseded {false};
+    };
+
+    bool isSuperseded(uint64_t instance_id, const std::string &job_id) const;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_superseded;
+    std::map<uint64_t, std::vector<Job>> m_jobs;
+    std::map<uint64_t, uint64_t> m_current_params;
+    size_t m_superseded_count {0};
+};
+
+#endif // IN_FLIGHT_JOBS_H
@@ -0,0 +1,74 @@
+#include "render_latency.h"
+#include <algorithm>
+
+RenderLatency &RenderLatency::instance()
+{
+    static RenderLatency latency;
+    return latency;
+}
+
+void RenderLatency::requested(uint64_t instance_id, uint64_t render_key, Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_waiting.find(instance_id);
+    if (it != m_waiting.end() && it->second.render_key == render_key)
+        return;
+    m_waiting[instance_id] = Waiting{render_key, now, false};
+}
+
+double RenderLatency::firstFeedback(uint64_t instance_id, uint64_t render_key, Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_waiting.find(instance_id);
+    if (it == m_waiting.end() || it->second.render_key != render_key || it->second.fed_back)
+        return -1.0;
+
+    double seconds = std::chrono::duration<double>(now - it->second.requested).count();
+    it->second.fed_back = true;
+    record(m_first_feedback, seconds);
+    return seconds;
+}
+
+double RenderLatency::finished(uint64_t instance_id, uint64_t render_key, Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_waiting.find(instance_id);
+    if (it == m_waiting.end() || it->second.render_key != render_key)
+        return -1.0;
+
+    double seconds = std::chrono::duration<double>(now - it->second.requested).count();
+    if (!it->second.fed_back)
+        record(m_first_feedback, seconds);
+    record(m_final, seconds);
+    m_waiting.erase(it);
+    return seconds;
+}
+
+RenderLatency::Stats RenderLatency::firstFeedbackStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_first_feedback;
+}
+
+RenderLatency::Stats RenderLatency::finalStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_final;
+}
+
+std::string RenderLatency::statsString() const
+{
+    Stats first_feedback = firstFeedbackStats();
+    Stats final_image = finalStats();
+    auto ms = [](double seconds) { return std::to_string(static_cast<long long>(seconds * 1000.0)); };
+    return "Queued render latency: first feedback mean=" + ms(first_feedback.mean_seconds) + "ms max=" + ms(first_feedback.max_seconds) +
+           "ms (" + std::to_string(first_feedback.count) + "), final mean=" + ms(final_image.mean_seconds) + "ms max=" +
+           ms(final_image.max_seconds) + "ms (" + std::to_string(final_image.count) + ")";
+}
+
+void RenderLatency::record(Stats &stats, double seconds)
+{
+    stats.count++;
+    stats.mean_seconds += (seconds - stats.mean_seconds) / static_cast<double>(stats.count);
+    stats.max_seconds = std::max(stats.max_seconds, seconds);
+}
@@ -0,0 +1,57 @@
+#ifndef RENDER_LATENCY_H
+#define RENDER_LATENCY_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+// How long an effect instance waits for a queued render to show up: once to the first
+// image made for it, a draft when renders are progressive, and once to its final image.
+// Each instance waits on one render at a time, asking for another supersedes it and the
+// superseded one isn't measured. Thread safe.
+class RenderLatency
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats
+    {
+        size_t count {0};
+        double mean_seconds {0.0};
+        double max_seconds {0.0};
+    };
+
+    static RenderLatency &instance();
+
+    // asking again for the render already waited on keeps the time of the first ask
+    void requested(uint64_t instance_id, uint64_t render_key, Clock::time_point now = Clock::now());
+    // a draft of the render is on screen, seconds since it was requested the first time
+    // this is called for it, negative otherwise
+    double firstFeedback(uint64_t instance_id, uint64_t render_key, Clock::time_point now = Clock::now());
+    // the final image is on screen, seconds since it was requested or negative if it wasn't
+    // waited on. Counts as the first feedback as well when no draft came before it
+    double finished(uint64_t instance_id, uint64_t render_key, Clock::time_point now = Clock::now());
+
+    Stats firstFeedbackStats() const;
+    Stats finalStats() const;
+    std::string statsString() const;
+
+protected:
+    struct Waiting
+    {
+        uint64_t render_key {0};
+        Clock::time_point requested;
+        bool fed_back {false};
+    };
+
+    static void record(Stats &stats, double seconds);
+
+    mutable std::mutex m_mutex;
+    std::map<uint64_t, Waiting> m_waiting;
+    Stats m_first_feedback;
+    Stats m_final;
+};
+
+#endif // RENDER_LATENCY_H
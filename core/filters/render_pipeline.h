@@ -0,0 +1,104 @@
+#ifndef RENDER_PIPELINE_H
+#define RENDER_PIPELINE_H
+
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "bounded_queue.h"
+
+// Renders a sequence of jobs in three stages on their own threads: uploading the inputs,
+// inference on the backend and downloading/decoding the result. While frame N is being
+// inferred frame N+1 uploads and frame N-1 downloads, so a sequence goes as fast as its
+// slowest stage rather than the sum of all three. The stages are joined by bounded queues,
+// a stage that falls behind blocks the one feeding it instead of letting work pile up.
+template <typename Job>
+class RenderPipeline
+{
+public:
+    // false drops the job, the rest of its stages are skipped
+    using Stage = std::function<bool(Job &job)>;
+    // called on the stage thread that finished or dropped the job
+    using Done = std::function<void(Job &job, bool success)>;
+
+    RenderPipeline(Stage upload, Stage infer, Stage download, size_t queue_depth)
+    : m_upload(std::move(upload)),
+      m_infer(std::move(infer)),
+      m_download(std::move(download)),
+      m_submitted(queue_depth),
+      m_uploaded(queue_depth),
+      m_inferred(queue_depth)
+    { }
+
+    ~RenderPipeline()
+    {
+        finish();
+    }
+
+    RenderPipeline(const RenderPipeline &) = delete;
+    RenderPipeline &operator=(const RenderPipeline &) = delete;
+
+    void start(Done on_done)
+    {
+        m_on_done = std::move(on_done);
+        m_threads.emplace_back(&RenderPipeline::runStage, this, std::ref(m_submitted), std::ref(m_upload), &m_uploaded);
+        m_threads.emplace_back(&RenderPipeline::runStage, this, std::ref(m_uploaded), std::ref(m_infer), &m_inferred);
+        m_threads.emplace_back(&RenderPipeline::runStage, this, std::ref(m_inferred), std::ref(m_download), nullptr);
+    }
+
+    // blocks while the upload stage is a full queue behind, false once finished
+    bool submit(Job job)
+    {
+        return m_submitted.push(std::move(job));
+    }
+
+    // no more jobs, returns once every submitted one is done
+    void finish()
+    {
+        m_submitted.close();
+        for (auto &thread : m_threads)
+        {
+            if (thread.joinable())
+                thread.join();
+        }
+        m_threads.clear();
+    }
+
+    // how often submit() or a stage had to wait for the stage after it to make room
+    size_t submitStalls() const { return m_submitted.stallCount(); }
+    size_t uploadStalls() const { return m_uploaded.stallCount(); }
+    size_t inferStalls() const { return m_inferred.stallCount(); }
+
+protected:
+    void runStage(BoundedQueue<Job> &in, Stage &stage, BoundedQueue<Job> *out)
+    {
+        Job job;
+        while (in.pop(job))
+        {
+            if (!stage(job))
+            {
+                if (m_on_done)
+                    m_on_done(job, false);
+                continue;
+            }
+            if (out)
+                out->push(std::move(job));
+            else if (m_on_done)
+                m_on_done(job, true);
+        }
+        // the stage after this one drains what it has and stops
+        if (out)
+            out->close();
+    }
+
+    Stage m_upload;
+    Stage m_infer;
+    Stage m_download;
+    Done m_on_done;
+    BoundedQueue<Job> m_submitted;
+    BoundedQueue<Job> m_uploaded;
+    BoundedQueue<Job> m_inferred;
+    std::vector<std::thread> m_threads;
+};
+
+#endif // RENDER_PIPELINE_H
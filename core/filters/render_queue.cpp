@@ -0,0 +1,340 @@
+#include "render_queue.h"
+#include "logger.h"
+#include <algorithm>
+
+// one interactive job and one prefetch job can run next to each other, more would
+// mostly queue up on the backend's GPU
+static const size_t kDefaultRenderWorkers = 2;
+// results nobody came back for, e.g. of an instance that was deleted, are dropped past this
+static const size_t kMaxFinishedResults = 256;
+
+RenderQueue::RenderQueue(size_t worker_count)
+: m_worker_count(std::max<size_t>(worker_count, 1))
+{ }
+
+RenderQueue::~RenderQueue()
+{
+    shutdown();
+}
+
+RenderQueue &RenderQueue::instance()
+{
+    static RenderQueue queue(kDefaultRenderWorkers);
+    return queue;
+}
+
+bool RenderQueue::submit(uint64_t instance_id, uint64_t render_key, int frame, Work work, Completion on_done, RenderLane lane)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping)
+            return false;
+
+        JobKey key {instance_id, render_key, frame};
+        if (!m_pending.emplace(key, PendingJob{lane, std::move(on_done)}).second)
+            return false;
+
+        if (lane == RenderLane::Interactive)
+            m_interactive.push_back(Job{key, std::move(work)});
+        else
+            m_prefetch.push_back(Job{key, std::move(work)});
+        // workers are started with the first job, hosts that never render async don't pay for them
+        if (m_workers.empty())
+            startWorkers();
+    }
+    m_wake.notify_one();
+    return true;
+}
+
+bool RenderQueue::submitBatch(uint64_t instance_id, const std::vector<std::pair<uint64_t, int>> &frames, Work work, RenderLane lane)
+{
+    if (frames.empty())
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping)
+            return false;
+        for (const auto &frame : frames)
+        {
+            if (m_pending.count(JobKey{instance_id, frame.first, frame.second}) > 0)
+                return false;
+        }
+
+        JobKey key {instance_id, frames[0].first, frames[0].second};
+        m_pending.emplace(key, PendingJob{lane, nullptr});
+        for (size_t i = 1; i < frames.size(); i++)
+            m_pending.emplace(JobKey{instance_id, frames[i].first, frames[i].second}, PendingJob{lane, nullptr, true, key});
+
+        if (lane == RenderLane::Interactive)
+            m_interactive.push_back(Job{key, std::move(work)});
+        else
+            m_prefetch.push_back(Job{key, std::move(work)});
+        if (m_workers.empty())
+            startWorkers();
+    }
+    m_wake.notify_one();
+    return true;
+}
+
+void RenderQueue::publish(const Result &result)
+{
+    Result published = result;
+    Completion on_done;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        finishPending(published, on_done);
+    }
+    m_job_done.notify_all();
+
+    if (on_done)
+        on_done(published);
+}
+
+bool RenderQueue::isPending(uint64_t instance_id, uint64_t render_key, int frame) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pending.count(JobKey{instance_id, render_key, frame}) > 0;
+}
+
+bool RenderQueue::promote(uint64_t instance_id, uint64_t render_key, int frame, Completion on_done)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        JobKey key {instance_id, render_key, frame};
+        auto pending = m_pending.find(key);
+        if (pending == m_pending.end())
+            return false;
+
+        if (!pending->second.on_done)
+            pending->second.on_done = std::move(on_done);
+        if (pending->second.lane == RenderLane::Interactive)
+            return true;
+        pending->second.lane = RenderLane::Interactive;
+
+        // a frame of a batch takes the whole batch along
+        promoteQueued(pending->second.in_batch ? pending->second.batch : key);
+    }
+    m_wake.notify_one();
+    return true;
+}
+
+void RenderQueue::promoteQueued(const JobKey &key)
+{
+    // still queued, a running one just carries on
+    auto queued = std::find_if(m_prefetch.begin(), m_prefetch.end(), [&](const Job &job) { return job.key == key; });
+    if (queued == m_prefetch.end())
+        return;
+    m_interactive.push_back(std::move(*queued));
+    m_prefetch.erase(queued);
+}
+
+bool RenderQueue::waitFor(uint64_t instance_id, uint64_t render_key, int frame)
+{
+    if (!promote(instance_id, render_key, frame))
+        return false;
+
+    JobKey key {instance_id, render_key, frame};
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_job_done.wait(lock, [&]() { return m_pending.count(key) == 0; });
+    return true;
+}
+
+size_t RenderQueue::cancelQueued(uint64_t instance_id, RenderLane lane)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::deque<Job> &queued = lane == RenderLane::Interactive ? m_interactive : m_prefetch;
+    size_t cancelled = 0;
+    for (auto it = queued.begin(); it != queued.end();)
+    {
+        if (std::get<0>(it->key) == instance_id)
+        {
+            erasePending(it->key);
+            it = queued.erase(it);
+            cancelled++;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    if (cancelled > 0)
+        m_job_done.notify_all();
+    return cancelled;
+}
+
+bool RenderQueue::takeResults(uint64_t instance_id, std::vector<Result> &out)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t taken = out.size();
+    for (auto it = m_finished.begin(); it != m_finished.end();)
+    {
+        if (it->instance_id == instance_id)
+        {
+            out.push_back(std::move(*it));
+            it = m_finished.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    return out.size() > taken;
+}
+
+std::string RenderQueue::lastImageId(uint64_t instance_id, std::string *out_node_url) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_last_image.find(instance_id);
+    if (it == m_last_image.end())
+        return std::string();
+    if (out_node_url)
+        *out_node_url = it->second.node_url;
+    return it->second.image_id;
+}
+
+size_t RenderQueue::pendingCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pending.size();
+}
+
+size_t RenderQueue::queuedCount(RenderLane lane) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return lane == RenderLane::Interactive ? m_interactive.size() : m_prefetch.size();
+}
+
+size_t RenderQueue::finishedCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_finished.size();
+}
+
+void RenderQueue::shutdown()
+{
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        for (const auto &job : m_interactive)
+            erasePending(job.key);
+        for (const auto &job : m_prefetch)
+            erasePending(job.key);
+        m_interactive.clear();
+        m_prefetch.clear();
+        workers.swap(m_workers);
+    }
+    m_wake.notify_all();
+    m_job_done.notify_all();
+
+    for (auto &worker : workers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+}
+
+void RenderQueue::finishPending(Result &result, Completion &on_done)
+{
+    // a prefetch promoted while it ran had somebody waiting for it after all
+    auto pending = m_pending.find(JobKey{result.instance_id, result.render_key, result.frame});
+    if (pending != m_pending.end())
+    {
+        result.lane = pending->second.lane;
+        on_done = std::move(pending->second.on_done);
+        m_pending.erase(pending);
+    }
+
+    // frames further ahead make a poor stand in for the one being looked at
+    if (result.success && result.lane == RenderLane::Interactive)
+        m_last_image[result.instance_id] = result;
+    m_finished.push_back(result);
+    if (m_finished.size() > kMaxFinishedResults)
+        m_finished.pop_front();
+}
+
+void RenderQueue::erasePending(const JobKey &key)
+{
+    m_pending.erase(key);
+    for (auto it = m_pending.begin(); it != m_pending.end();)
+    {
+        if (it->second.in_batch && it->second.batch == key)
+            it = m_pending.erase(it);
+        else
+            ++it;
+    }
+}
+
+void RenderQueue::startWorkers()
+{
+    for (size_t i = 0; i < m_worker_count; i++)
+        m_workers.emplace_back(&RenderQueue::workerLoop, this);
+}
+
+size_t RenderQueue::prefetchSlots() const
+{
+    return m_worker_count > 1 ? m_worker_count - 1 : 1;
+}
+
+bool RenderQueue::hasRunnableJob() const
+{
+    return !m_interactive.empty() || (!m_prefetch.empty() && m_prefetch_running < prefetchSlots());
+}
+
+void RenderQueue::workerLoop()
+{
+    while (true)
+    {
+        Job job;
+        RenderLane lane = RenderLane::Interactive;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this]() { return m_stopping || hasRunnableJob(); });
+            if (m_stopping)
+                return;
+
+            if (!m_interactive.empty())
+            {
+                job = std::move(m_interactive.front());
+                m_interactive.pop_front();
+            }
+            else
+            {
+                job = std::move(m_prefetch.front());
+                m_prefetch.pop_front();
+                lane = RenderLane::Prefetch;
+                m_prefetch_running++;
+            }
+        }
+
+        Result result;
+        std::tie(result.instance_id, result.render_key, result.frame) = job.key;
+        result.lane = lane;
+        try
+        {
+            job.work(result);
+        }
+        catch (const std::exception &e)
+        {
+            LogError(std::string("Render job failed: ") + e.what());
+            result.success = false;
+        }
+
+        Completion on_done;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (lane == RenderLane::Prefetch)
+                m_prefetch_running--;
+            finishPending(result, on_done);
+            // frames of a batch that were never published aren't coming anymore
+            erasePending(job.key);
+        }
+        // a prefetch slot may have freed up
+        m_wake.notify_all();
+        m_job_done.notify_all();
+
+        if (on_done)
+            on_done(result);
+    }
+}
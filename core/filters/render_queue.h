@@ -0,0 +1,127 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+enum class RenderLane
+{
+    Interactive, // somebody is waiting for the frame
+    Prefetch     // a frame the host is expected to ask for soon
+};
+
+// Runs render jobs off the host's render thread. A job is identified by the effect
+// instance it belongs to, its render key and the frame, submitting one that is already
+// queued or running does nothing. Finished jobs wait here until the instance's next
+// render takes them, the completion callback is how the host gets asked for that render.
+// Interactive jobs always start before queued prefetch ones, and one worker is kept
+// free of prefetch work so an interactive job never waits for a whole prefetch.
+// A batch job renders several frames and publishes each one's result as it comes in,
+// its other frames count as pending until then.
+class RenderQueue
+{
+public:
+    struct Result
+    {
+        uint64_t instance_id {0};
+        uint64_t render_key {0};
+        int frame {0};
+        bool success {false};
+        std::string image_id;
+        std::string node_url; // the backend holding image_id
+        double seconds {0.0}; // from the job starting to its result being downloaded
+        RenderLane lane {RenderLane::Interactive};
+    };
+
+    // fills in success, image_id, node_url and seconds, the ids are already set
+    using Work = std::function<void(Result &result)>;
+    // called on the worker thread once the result can be taken
+    using Completion = std::function<void(const Result &result)>;
+
+    explicit RenderQueue(size_t worker_count);
+    ~RenderQueue();
+
+    RenderQueue(const RenderQueue &) = delete;
+    RenderQueue &operator=(const RenderQueue &) = delete;
+
+    static RenderQueue &instance();
+
+    // false when the same job is already queued or running, or after shutdown
+    bool submit(uint64_t instance_id, uint64_t render_key, int frame, Work work, Completion on_done = nullptr,
+                RenderLane lane = RenderLane::Interactive);
+    // frames are (render key, frame), the first one is the job's own and goes into work's result,
+    // work publishes the others. False if any of them is already pending
+    bool submitBatch(uint64_t instance_id, const std::vector<std::pair<uint64_t, int>> &frames, Work work,
+                     RenderLane lane = RenderLane::Prefetch);
+    // the result of one of a running batch job's other frames
+    void publish(const Result &result);
+    bool isPending(uint64_t instance_id, uint64_t render_key, int frame) const;
+    // moves a queued prefetch job to the interactive lane, on_done fills in a missing completion.
+    // false if the job isn't queued or running
+    bool promote(uint64_t instance_id, uint64_t render_key, int frame, Completion on_done = nullptr);
+    // promotes the job and blocks until it is done, false if it wasn't pending
+    bool waitFor(uint64_t instance_id, uint64_t render_key, int frame);
+    // drops the instance's jobs in lane that haven't started yet, returns how many
+    size_t cancelQueued(uint64_t instance_id, RenderLane lane);
+
+    // moves every finished result of the instance into out, oldest first
+    bool takeResults(uint64_t instance_id, std::vector<Result> &out);
+    // the most recent image an instance's interactive jobs produced, kept after its result was taken
+    std::string lastImageId(uint64_t instance_id, std::string *out_node_url = nullptr) const;
+
+    size_t pendingCount() const;
+    size_t queuedCount(RenderLane lane) const;
+    size_t finishedCount() const;
+    size_t workerCount() const { return m_worker_count; }
+
+    // drops the jobs that haven't started and waits for the running ones
+    void shutdown();
+
+protected:
+    using JobKey = std::tuple<uint64_t, uint64_t, int>; // instance id, render key, frame
+
+    struct Job
+    {
+        JobKey key;
+        Work work;
+    };
+
+    struct PendingJob
+    {
+        RenderLane lane {RenderLane::Interactive};
+        Completion on_done;
+        bool in_batch {false};
+        JobKey batch; // the job rendering this frame when in_batch
+    };
+
+    void startWorkers();
+    void finishPending(Result &result, Completion &on_done);
+    void erasePending(const JobKey &key);
+    void promoteQueued(const JobKey &key);
+    void workerLoop();
+    bool hasRunnableJob() const;
+    size_t prefetchSlots() const;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_job_done;
+    std::deque<Job> m_interactive;
+    std::deque<Job> m_prefetch;
+    std::map<JobKey, PendingJob> m_pending; // queued or running
+    size_t m_prefetch_running {0};
+    std::deque<Result> m_finished;
+    std::map<uint64_t, Result> m_last_image;
+    std::vector<std::thread> m_workers;
+    size_t m_worker_count {1};
+    bool m_stopping {false};
+};
+
+#endif // RENDER_QUEUE_H
@@ -0,0 +1,74 @@
+#include "uploaded_frame_ring.h"
+#include <algorithm>
+
+// room for a window of a dozen frames either side plus the frames sliding in
+static const size_t kRingFramesPerInstance = 32;
+
+UploadedFrameRing::UploadedFrameRing(size_t frames_per_instance)
+: m_frames_per_instance(std::max<size_t>(frames_per_instance, 1))
+{ }
+
+UploadedFrameRing &UploadedFrameRing::instance()
+{
+    static UploadedFrameRing ring(kRingFramesPerInstance);
+    return ring;
+}
+
+bool UploadedFrameRing::find(uint64_t instance_id, int frame, UploadedFrame &out) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto instance = m_instances.find(instance_id);
+    if (instance == m_instances.end())
+        return false;
+
+    for (const auto &uploaded : instance->second)
+    {
+        if (uploaded.frame == frame)
+        {
+            out = uploaded;
+            return true;
+        }
+    }
+    return false;
+}
+
+void UploadedFrameRing::add(uint64_t instance_id, const UploadedFrame &uploaded)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::deque<UploadedFrame> &frames = m_instances[instance_id];
+    frames.erase(std::remove_if(frames.begin(), frames.end(), [&](const UploadedFrame &existing) { return existing.frame == uploaded.frame; }),
+                 frames.end());
+    frames.push_back(uploaded);
+    while (frames.size() > m_frames_per_instance)
+        frames.pop_front();
+}
+
+void UploadedFrameRing::checkFrame(uint64_t instance_id, int frame, uint64_t content_hash)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto instance = m_instances.find(instance_id);
+    if (instance == m_instances.end())
+        return;
+
+    for (const auto &uploaded : instance->second)
+    {
+        if (uploaded.frame == frame && uploaded.content_hash != content_hash)
+        {
+            m_instances.erase(instance);
+            return;
+        }
+    }
+}
+
+void UploadedFrameRing::forget(uint64_t instance_id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_instances.erase(instance_id);
+}
+
+size_t UploadedFrameRing::size(uint64_t instance_id) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto instance = m_instances.find(instance_id);
+    return instance != m_instances.end() ? instance->second.size() : 0;
+}
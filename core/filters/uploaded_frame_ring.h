@@ -0,0 +1,45 @@
+#ifndef UPLOADED_FRAME_RING_H
+#define UPLOADED_FRAME_RING_H
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+
+struct UploadedFrame
+{
+    int frame {0};
+    std::string node;       // base url of the backend holding the image
+    std::string image_id;
+    uint64_t content_hash {0};
+    int scale {1};          // the proxy resolution it was uploaded at, 1 for full size
+};
+
+// The img_before/img_after frames recently sent for each effect instance. The windows of
+// consecutive frames overlap in all but one frame, frames found here are sent by id without
+// being fetched from the host or uploaded again. Each instance keeps its most recent
+// uploads, the oldest are dropped once frames_per_instance is reached. Thread safe.
+class UploadedFrameRing
+{
+public:
+    explicit UploadedFrameRing(size_t frames_per_instance);
+
+    static UploadedFrameRing &instance();
+
+    bool find(uint64_t instance_id, int frame, UploadedFrame &out) const;
+    void add(uint64_t instance_id, const UploadedFrame &uploaded);
+    // content_hash is what the host has for frame now, if the ring's upload was made from
+    // other pixels the layer changed upstream and none of the instance's frames can be trusted
+    void checkFrame(uint64_t instance_id, int frame, uint64_t content_hash);
+    void forget(uint64_t instance_id);
+
+    size_t size(uint64_t instance_id) const;
+
+protected:
+    mutable std::mutex m_mutex;
+    std::map<uint64_t, std::deque<UploadedFrame>> m_instances;
+    size_t m_frames_per_instance;
+};
+
+#endif // UPLOADED_FRAME_RING_H
@@ -0,0 +1,62 @@
+#ifndef HASH_UTILS_H
+#define HASH_UTILS_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+constexpr uint64_t kHashSeed = 0x9e3779b97f4a7c15ULL;
+
+// MurmurHash64A, fast enough to run over a full frame on every render and
+// good enough to key caches with. Not for anything security related.
+inline uint64_t hash64(const void *data, size_t size, uint64_t seed = kHashSeed)
+{
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+
+    uint64_t h = seed ^ (size * m);
+
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    const unsigned char *end = bytes + (size / 8) * 8;
+    for (; bytes != end; bytes += 8)
+    {
+        uint64_t k;
+        std::memcpy(&k, bytes, sizeof(k));
+
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+
+        h ^= k;
+        h *= m;
+    }
+
+    switch (size & 7)
+    {
+        case 7: h ^= uint64_t(bytes[6]) << 48; [[fallthrough]];
+        case 6: h ^= uint64_t(bytes[5]) << 40; [[fallthrough]];
+        case 5: h ^= uint64_t(bytes[4]) << 32; [[fallthrough]];
+        case 4: h ^= uint64_t(bytes[3]) << 24; [[fallthrough]];
+        case 3: h ^= uint64_t(bytes[2]) << 16; [[fallthrough]];
+        case 2: h ^= uint64_t(bytes[1]) << 8; [[fallthrough]];
+        case 1: h ^= uint64_t(bytes[0]);
+                h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
+
+inline uint64_t hash64(const std::string &text, uint64_t seed = kHashSeed)
+{
+    return hash64(text.data(), text.size(), seed);
+}
+
+inline uint64_t hashCombine(uint64_t seed, uint64_t value)
+{
+    return hash64(&value, sizeof(value), seed);
+}
+
+#endif // HASH_UTILS_H
@@ -0,0 +1,188 @@
+#include "render_result_index.h"
+#include <algorithm>
+#include <cstring>
+
+// blob layout: version(u8) node_count(u8), per node url_length(u8) url, then count(u16) and per
+// entry frame(i32) params_hash(u64) node(u8) id_length(u8) id
+static const uint8_t kRenderIndexVersion = 3;
+static const size_t kHeaderBytes = 2 * sizeof(uint8_t) + sizeof(uint16_t);
+static const size_t kMaxStringBytes = 255;
+static const size_t kMaxNodes = 255;
+
+static size_t entryBytes(const RenderResult &result)
+{
+    return sizeof(int32_t) + sizeof(uint64_t) + 2 * sizeof(uint8_t) + result.img_id.size();
+}
+
+static size_t nodeBytes(const std::string &node_url)
+{
+    return sizeof(uint8_t) + node_url.size();
+}
+
+static void writeString(std::string &out_data, const std::string &value)
+{
+    out_data.push_back(static_cast<char>(static_cast<uint8_t>(value.size())));
+    out_data.append(value);
+}
+
+template <typename T>
+static void writeValue(std::string &out_data, T value)
+{
+    out_data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template <typename T>
+static bool readValue(const std::string &data, size_t &pos, T &out_value)
+{
+    if (data.size() - pos < sizeof(out_value))
+        return false;
+    std::memcpy(&out_value, data.data() + pos, sizeof(out_value));
+    pos += sizeof(out_value);
+    return true;
+}
+
+static bool readString(const std::string &data, size_t &pos, std::string &out_value)
+{
+    uint8_t size = 0;
+    if (!readValue(data, pos, size) || data.size() - pos < size)
+        return false;
+    out_value = data.substr(pos, size);
+    pos += size;
+    return true;
+}
+
+RenderResultIndex::RenderResultIndex(size_t max_bytes)
+: m_max_bytes(max_bytes),
+  m_results(max_bytes > kHeaderBytes ? max_bytes - kHeaderBytes : 0)
+{ }
+
+int RenderResultIndex::internNode(const std::string &node_url)
+{
+    auto node = std::find(m_node_urls.begin(), m_node_urls.end(), node_url);
+    if (node != m_node_urls.end())
+        return static_cast<int>(node - m_node_urls.begin());
+    if (m_node_urls.size() >= kMaxNodes)
+        return -1;
+
+    // the table comes out of the same budget, older results make room for it
+    size_t table_bytes = kHeaderBytes;
+    for (const auto &url : m_node_urls)
+        table_bytes += nodeBytes(url);
+    table_bytes += nodeBytes(node_url);
+    if (table_bytes >= m_max_bytes)
+        return -1;
+    m_node_urls.push_back(node_url);
+    m_results.setCapacity(m_max_bytes - table_bytes);
+    return static_cast<int>(m_node_urls.size() - 1);
+}
+
+bool RenderResultIndex::find(int frame, uint64_t params_hash, std::string &out_img_id, std::string *out_node_url)
+{
+    RenderResult result;
+    if (!m_results.get({frame, params_hash}, result))
+        return false;
+    out_img_id = result.img_id;
+    if (out_node_url)
+        *out_node_url = result.node_url;
+    return true;
+}
+
+void RenderResultIndex::add(int frame, uint64_t params_hash, const std::string &img_id, const std::string &node_url)
+{
+    if (img_id.empty() || img_id.size() > kMaxStringBytes || node_url.size() > kMaxStringBytes || internNode(node_url) < 0)
+        return;
+    RenderResult result {img_id, node_url};
+    m_results.put({frame, params_hash}, result, entryBytes(result));
+}
+
+void RenderResultIndex::remove(int frame, uint64_t params_hash)
+{
+    m_results.erase({frame, params_hash});
+}
+
+bool RenderResultIndex::findNode(const std::string &img_id, std::string &out_node_url) const
+{
+    bool found = false;
+    m_results.forEach([&](const RenderResultKey &, const RenderResult &result)
+    {
+        if (!found && result.img_id == img_id)
+        {
+            out_node_url = result.node_url;
+            found = true;
+        }
+    });
+    return found;
+}
+
+std::string RenderResultIndex::serialize() const
+{
+    // oldest first so deserialize() rebuilds the same recency order
+    std::vector<std::pair<RenderResultKey, RenderResult>> entries;
+    m_results.forEach([&entries](const RenderResultKey &key, const RenderResult &result)
+    {
+        entries.emplace_back(key, result);
+    });
+
+    std::string data;
+    data.reserve(m_max_bytes);
+    writeValue(data, kRenderIndexVersion);
+    writeValue(data, static_cast<uint8_t>(m_node_urls.size()));
+    for (const auto &node_url : m_node_urls)
+        writeString(data, node_url);
+    writeValue(data, static_cast<uint16_t>(entries.size()));
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+    {
+        auto node = std::find(m_node_urls.begin(), m_node_urls.end(), it->second.node_url);
+        writeValue(data, static_cast<int32_t>(it->first.frame));
+        writeValue(data, it->first.params_hash);
+        writeValue(data, static_cast<uint8_t>(node - m_node_urls.begin()));
+        writeString(data, it->second.img_id);
+    }
+    return data;
+}
+
+bool RenderResultIndex::deserialize(const std::string &data)
+{
+    m_results.clear();
+    m_node_urls.clear();
+    m_results.setCapacity(m_max_bytes > kHeaderBytes ? m_max_bytes - kHeaderBytes : 0);
+    if (data.empty())
+        return true;
+
+    size_t pos = 0;
+    uint8_t version = 0;
+    uint8_t node_count = 0;
+    if (!readValue(data, pos, version) || version != kRenderIndexVersion || !readValue(data, pos, node_count))
+        return false;
+
+    // only the nodes entries still refer to are interned again, add() does that as it goes
+    std::vector<std::string> node_urls(node_count);
+    for (auto &node_url : node_urls)
+    {
+        if (!readString(data, pos, node_url))
+            return false;
+    }
+
+    uint16_t count = 0;
+    if (!readValue(data, pos, count))
+        return false;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        int32_t frame = 0;
+        uint64_t params_hash = 0;
+        uint8_t node = 0;
+        std::string img_id;
+        if (!readValue(data, pos, frame) ||
+            !readValue(data, pos, params_hash) ||
+            !readValue(data, pos, node) ||
+            node >= node_urls.size() ||
+            !readString(data, pos, img_id))
+        {
+            m_results.clear();
+            m_node_urls.clear();
+            return false;
+        }
+        add(frame, params_hash, img_id, node_urls[node]);
+    }
+    return true;
+}
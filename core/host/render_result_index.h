@@ -0,0 +1,68 @@
+#ifndef RENDER_RESULT_INDEX_H
+#define RENDER_RESULT_INDEX_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "lru_cache.h"
+
+// upper bound on the serialized index, hosts keep it in their per instance storage
+constexpr size_t kRenderIndexMaxBytes = 4096;
+
+struct RenderResultKey
+{
+    int frame {0};
+    uint64_t params_hash {0};
+
+    bool operator==(const RenderResultKey &other) const
+    {
+        return frame == other.frame && params_hash == other.params_hash;
+    }
+};
+
+struct RenderResultKeyHash
+{
+    size_t operator()(const RenderResultKey &key) const
+    {
+        return static_cast<size_t>(key.params_hash ^ (static_cast<uint64_t>(key.frame) * 0x9e3779b97f4a7c15ULL));
+    }
+};
+
+// what was rendered for a frame, image ids are only unique per backend so the node goes with it
+struct RenderResult
+{
+    std::string img_id;
+    std::string node_url; // base url of the backend holding the image
+};
+
+// Remembers which backend image was rendered for a frame with a given set of params,
+// so going back to a frame that was already rendered doesn't run the model again.
+// Serializes to a small blob for the host to store with the effect instance, the
+// least recently used results are dropped once that blob would outgrow max_bytes.
+// Node urls are written once in a table at the start of the blob, entries refer to them by index.
+class RenderResultIndex
+{
+public:
+    explicit RenderResultIndex(size_t max_bytes = kRenderIndexMaxBytes);
+
+    bool find(int frame, uint64_t params_hash, std::string &out_img_id, std::string *out_node_url = nullptr);
+    void add(int frame, uint64_t params_hash, const std::string &img_id, const std::string &node_url = "");
+    void remove(int frame, uint64_t params_hash);
+    // the node an indexed image was rendered on, for ids the host kept without it
+    bool findNode(const std::string &img_id, std::string &out_node_url) const;
+
+    std::string serialize() const;
+    bool deserialize(const std::string &data);
+
+    size_t size() const { return m_results.size(); }
+
+protected:
+    // index of node_url in m_node_urls, added if it's new, -1 once the table is full
+    int internNode(const std::string &node_url);
+
+    size_t m_max_bytes;
+    std::vector<std::string> m_node_urls;
+    LruCache<RenderResultKey, RenderResult, RenderResultKeyHash> m_results;
+};
+
+#endif // RENDER_RESULT_INDEX_H
@@ -41,6 +41,18 @@ ParamValue VideoHost::getParamValue(int paramId) const
     return m_delegate->getParamValue(paramId);
 }
 
+const ParamSnapshot &VideoHost::paramSnapshot()
+{
+    LOG_ASSERT(m_delegate != nullptr, "delegate is null");
+    if (!m_param_snapshot_taken && m_delegate)
+    {
+        m_param_snapshot.clear();
+        m_delegate->fillParamSnapshot(m_param_snapshot);
+        m_param_snapshot_taken = true;
+    }
+    return m_param_snapshot;
+}
+
 int VideoHost::paramIDFromHostIndex(int hostIndex) const
 {
     LOG_ASSERT(m_delegate != nullptr, "delegate is null");
@@ -58,6 +70,8 @@ bool VideoHost::registerParams(bool addToHost)
 
     if (m_delegate && m_filter)
     {
+        // the set of params is about to change, read the values again next time
+        m_param_snapshot_taken = false;
         m_filter->clearPersistentParams();
         std::vector<ParameterPtr> filterParams = m_filter->parameters();
         if (cpr::Get(cpr::Url{"https://deepmake.com/version"}).error.code == cpr::ErrorCode::OK)
@@ -162,6 +176,7 @@ bool VideoHost::updateParams(int changedParamHostIndex)
             if (param_id == m_configMenuBtnID)
             {
                 api_connection.openConfigMenu(rendererFilter->selectedFilterName());
+                rendererFilter->refreshPluginConfig(rendererFilter->selectedFilterName());
                 return true;
             }
             if (param_id == m_logoutBtnID)
@@ -256,23 +271,43 @@ void VideoHost::setRenderedImageID(const std::string &img_id)
     }
 }
 
-std::string VideoHost::getCachedParams()
+uint64_t VideoHost::getCachedParamsHash()
 {
-    std::string params;
+    uint64_t params_hash = 0;
     LOG_ASSERT(m_delegate != nullptr, "delegate is null");
     if (m_delegate)
     {
-        params = m_delegate->getCachedParams();
+        params_hash = m_delegate->getCachedParamsHash();
     }
-    return params;
+    return params_hash;
 }
 
-void VideoHost::setCachedParams(const std::string &params)
+void VideoHost::setCachedParamsHash(uint64_t params_hash)
 {
     LOG_ASSERT(m_delegate != nullptr, "delegate is null");
     if (m_delegate)
     {
-        m_delegate->setCachedParams(params);
+        m_delegate->setCachedParamsHash(params_hash);
+    }
+}
+
+std::string VideoHost::getRenderIndex()
+{
+    std::string index;
+    LOG_ASSERT(m_delegate != nullptr, "delegate is null");
+    if (m_delegate)
+    {
+        index = m_delegate->getRenderIndex();
+    }
+    return index;
+}
+
+void VideoHost::setRenderIndex(const std::string &index)
+{
+    LOG_ASSERT(m_delegate != nullptr, "delegate is null");
+    if (m_delegate)
+    {
+        m_delegate->setRenderIndex(index);
     }
 }
 
@@ -598,10 +633,13 @@ void VideoHost::handleLoginButtonPressed()
     std::future<bool> loginFuture = std::async(std::launch::async, [&](){
         api_connection.openLoginMenu();
         int checkCount = 0;
+        // the login state is about to change so don't let the response cache hide it
+        api_connection.invalidateLoginCache();
         while (!api_connection.getLoginStatus() && checkCount < 60)
         {
             checkCount++;
             std::this_thread::sleep_for(std::chrono::seconds(1));
+            api_connection.invalidateLoginCache();
         }
         return api_connection.getLoginStatus();
     });
@@ -635,8 +673,8 @@ void VideoHost::handleLoginButtonPressed()
 
 void VideoHost::handleLogoutButtonPressed()
 {
-    cpr::Response response = cpr::Get(cpr::Url{m_base_url + "login/logout"});
-    if (response.status_code == 200)
+    ApiConnection api_connection;
+    if (api_connection.logout())
     {
         LogInfo("Logout Successful = " + std::to_string(bIsLoggedIn()));
         setIsLoggedIn(false);
@@ -21,6 +21,8 @@ public:
     int numOfParams() const {return m_numOfParams;}
     int paramIDFromHostIndex(int hostIndex) const;
     ParamValue getParamValue(int paramId) const;
+    //taken from the host the first time it's asked for, filter code reads params through this
+    const ParamSnapshot &paramSnapshot();
     ArkImagePtr sourceImg() const {return m_delegate->sourceImg();}
     ArkImagePtr destImg() const {return m_delegate->destImg();}
     
@@ -31,8 +33,11 @@ public:
     std::string getRenderedImageID();
     void setRenderedImageID(const std::string &img_id);
     
-    std::string getCachedParams();
-    void setCachedParams(const std::string &params);
+    uint64_t getCachedParamsHash();
+    void setCachedParamsHash(uint64_t params_hash);
+
+    std::string getRenderIndex();
+    void setRenderIndex(const std::string &index);
 
     bool getCachedLicenseStatus() const;
     void setCachedLicenseStatus(bool status);
@@ -41,7 +46,6 @@ public:
     void hideShowControl(int id, bool hide);
     VideoHostDelegatePtr getDelegate() {return m_delegate;}
     DrawHelper& getDrawHelper() {return m_delegate->getDrawHelper();}
-    std::string m_base_url = "http://localhost:8000/";//I think this should be in the config file
     
 protected:
     bool addParameterToHost(const ParameterPtr param);
@@ -74,6 +78,8 @@ protected:
     VideoHostDelegatePtr m_delegate;
     VideoFilterPtr m_filter;
     int m_numOfParams {0};
+    ParamSnapshot m_param_snapshot;
+    bool m_param_snapshot_taken {false};
     std::string cachedUsername = "TestUser@Deepmake.com";
     std::string selectedFilterName;
     static bool &bIsLoggedIn()
@@ -4,9 +4,15 @@
 
 #include <memory>
 #include "parameter.h"
+#include "param_snapshot.h"
 #include "images/ark_image.h"
 #include "draw_helper.h"
 #include <string>
+#include <cstdint>
+#include <functional>
+
+//tells the host a queued render finished, called from a render worker thread
+using RenderCompletion = std::function<void()>;
 
 class VideoHostDelegate
 {
@@ -22,6 +28,8 @@ public:
 
     virtual bool registerParam(const ParameterPtr param) = 0;
     virtual ParamValue getParamValue(int paramFilterIndex) const = 0;
+    //reads every registered param value in one pass, slot is the host's own param index
+    virtual void fillParamSnapshot(ParamSnapshot &snapshot) const = 0;
     virtual int hostIndexFromParamId(int paramId) const = 0;
     virtual int paramIdFromHostIndex(int hostIndex) const = 0;
 
@@ -31,9 +39,21 @@ public:
     virtual std::string getRenderedImageID() = 0;
     virtual void setRenderedImageID(const std::string &img_id) = 0;
 
-    virtual std::string getCachedParams() = 0;
-    virtual void setCachedParams(const std::string &params) = 0;
+    //hash of the params the most recent image was rendered with, 0 if there isn't one
+    virtual uint64_t getCachedParamsHash() = 0;
+    virtual void setCachedParamsHash(uint64_t params_hash) = 0;
+
+    //serialized RenderResultIndex, empty if the host has nowhere to keep it
+    virtual std::string getRenderIndex() = 0;
+    virtual void setRenderIndex(const std::string &index) = 0;
     
+    //identifies the effect instance across host calls, 0 if the host can't tell instances apart
+    virtual uint64_t instanceId() = 0;
+    //true while someone is waiting to see the frame, false for final renders that need the real result
+    virtual bool isInteractiveRender() = 0;
+    //asks the host to render this instance again, must be safe to call from any thread
+    virtual RenderCompletion renderCompletion() = 0;
+
     virtual bool getCachedLicenseStatus() = 0;
     virtual void setCachedLicenseStatus(bool status) = 0;
 
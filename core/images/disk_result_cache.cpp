@@ -0,0 +1,224 @@
+#include "disk_result_cache.h"
+#include "utils.h"
+#include "logger.h"
+#include <filesystem>
+#include <fstream>
+#include <unordered_set>
+#include <vector>
+#include <cstring>
+
+static const char kIndexMagic[4] = {'A', 'R', 'K', 'R'};
+static const uint32_t kIndexVersion = 1;
+static const char *kIndexFileName = "index.bin";
+static const char *kResultExtension = ".img";
+static const uint64_t kDefaultMaxBytes = 2ULL * 1024 * 1024 * 1024;
+
+static bool writeFileAtomically(const std::string &path, const char *data, size_t size)
+{
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        file.write(data, static_cast<std::streamsize>(size));
+        if (!file)
+            return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    return !ec;
+}
+
+DiskResultCache::DiskResultCache(const std::string &directory, uint64_t max_bytes)
+: m_directory(directory)
+, m_entries(static_cast<size_t>(max_bytes))
+{
+    std::error_code ec;
+    std::filesystem::create_directories(m_directory, ec);
+    if (ec)
+        LogError("Failed to create result cache directory " + m_directory + ": " + ec.message());
+
+    m_entries.setEvictionHandler([this](const uint64_t &key, const uint64_t &)
+    {
+        std::error_code remove_ec;
+        std::filesystem::remove(pathForKey(key), remove_ec);
+    });
+    loadIndex();
+}
+
+DiskResultCache::~DiskResultCache()
+{
+    flush();
+}
+
+DiskResultCache &DiskResultCache::instance()
+{
+    static DiskResultCache cache((std::filesystem::path(tmpDirectory()) / "deepmake_result_cache").string(), kDefaultMaxBytes);
+    return cache;
+}
+
+bool DiskResultCache::contains(uint64_t key)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.contains(key);
+}
+
+bool DiskResultCache::load(uint64_t key, std::string &out_data)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    uint64_t size = 0;
+    if (!m_entries.get(key, size))
+        return false;
+    m_index_dirty = true;
+
+    std::ifstream file(pathForKey(key), std::ios::binary);
+    if (file)
+    {
+        out_data.resize(static_cast<size_t>(size));
+        file.read(&out_data[0], static_cast<std::streamsize>(size));
+        if (file.gcount() == static_cast<std::streamsize>(size))
+            return true;
+    }
+
+    LogWarning("Dropping unreadable cached result " + pathForKey(key));
+    m_entries.erase(key);
+    out_data.clear();
+    return false;
+}
+
+bool DiskResultCache::store(uint64_t key, const std::string &data)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (data.empty() || data.size() > m_entries.capacity())
+        return false;
+
+    if (!writeFileAtomically(pathForKey(key), data.data(), data.size()))
+    {
+        LogError("Failed to write cached result " + pathForKey(key));
+        return false;
+    }
+    m_entries.put(key, data.size(), data.size());
+    m_index_dirty = true;
+    // new files without an index entry would be deleted as orphans on the next start
+    return saveIndex();
+}
+
+void DiskResultCache::flush()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_index_dirty)
+        saveIndex();
+}
+
+size_t DiskResultCache::size()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+uint64_t DiskResultCache::totalBytes()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.totalCost();
+}
+
+std::string DiskResultCache::pathForKey(uint64_t key) const
+{
+    char name[17];
+    snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(m_directory) / (std::string(name) + kResultExtension)).string();
+}
+
+std::string DiskResultCache::indexPath() const
+{
+    return (std::filesystem::path(m_directory) / kIndexFileName).string();
+}
+
+// index layout: magic, version(u32), count(u32), then key(u64) size(u64) from least to most recently used
+void DiskResultCache::loadIndex()
+{
+    std::ifstream file(indexPath(), std::ios::binary);
+    if (file)
+    {
+        char magic[sizeof(kIndexMagic)] = {};
+        uint32_t version = 0;
+        uint32_t count = 0;
+        file.read(magic, sizeof(magic));
+        file.read(reinterpret_cast<char *>(&version), sizeof(version));
+        file.read(reinterpret_cast<char *>(&count), sizeof(count));
+        if (file && std::memcmp(magic, kIndexMagic, sizeof(kIndexMagic)) == 0 && version == kIndexVersion)
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                uint64_t key = 0;
+                uint64_t size = 0;
+                file.read(reinterpret_cast<char *>(&key), sizeof(key));
+                file.read(reinterpret_cast<char *>(&size), sizeof(size));
+                if (!file)
+                    break;
+
+                std::error_code ec;
+                if (std::filesystem::file_size(pathForKey(key), ec) == size && !ec)
+                    m_entries.put(key, size, static_cast<size_t>(size));
+            }
+        }
+        else
+        {
+            LogWarning("Ignoring invalid result cache index " + indexPath());
+        }
+    }
+
+    // anything on disk the index doesn't know about can't be evicted, so remove it now
+    std::error_code ec;
+    for (const auto &dir_entry : std::filesystem::directory_iterator(m_directory, ec))
+    {
+        const std::filesystem::path &path = dir_entry.path();
+        if (path.filename() == kIndexFileName)
+            continue;
+
+        bool known = false;
+        if (path.extension() == kResultExtension)
+        {
+            try
+            {
+                known = m_entries.contains(std::stoull(path.stem().string(), nullptr, 16));
+            }
+            catch (...)
+            {
+            }
+        }
+        if (!known)
+        {
+            std::error_code remove_ec;
+            std::filesystem::remove(path, remove_ec);
+        }
+    }
+    m_index_dirty = false;
+}
+
+bool DiskResultCache::saveIndex()
+{
+    std::vector<std::pair<uint64_t, uint64_t>> entries;
+    m_entries.forEach([&entries](const uint64_t &key, const uint64_t &size)
+    {
+        entries.emplace_back(key, size);
+    });
+
+    std::string data(kIndexMagic, sizeof(kIndexMagic));
+    uint32_t count = static_cast<uint32_t>(entries.size());
+    data.append(reinterpret_cast<const char *>(&kIndexVersion), sizeof(kIndexVersion));
+    data.append(reinterpret_cast<const char *>(&count), sizeof(count));
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+    {
+        data.append(reinterpret_cast<const char *>(&it->first), sizeof(it->first));
+        data.append(reinterpret_cast<const char *>(&it->second), sizeof(it->second));
+    }
+
+    if (!writeFileAtomically(indexPath(), data.data(), data.size()))
+    {
+        LogError("Failed to write result cache index " + indexPath());
+        return false;
+    }
+    m_index_dirty = false;
+    return true;
+}
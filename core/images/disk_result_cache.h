@@ -0,0 +1,42 @@
+#ifndef DISK_RESULT_CACHE_H
+#define DISK_RESULT_CACHE_H
+
+#include <string>
+#include <cstdint>
+#include <mutex>
+#include "lru_cache.h"
+
+// Encoded render results on disk, addressed by a hash of everything that went into
+// producing them (plugin, endpoint, params and source pixels), so they outlive the
+// host session. Files live in one directory next to an index file that keeps the
+// sizes and the LRU order, the oldest results are deleted once over max_bytes.
+class DiskResultCache
+{
+public:
+    DiskResultCache(const std::string &directory, uint64_t max_bytes);
+    ~DiskResultCache();
+
+    static DiskResultCache &instance();
+
+    bool load(uint64_t key, std::string &out_data);
+    // doesn't touch the file or the LRU order
+    bool contains(uint64_t key);
+    bool store(uint64_t key, const std::string &data);
+    void flush();
+
+    size_t size();
+    uint64_t totalBytes();
+
+protected:
+    std::string pathForKey(uint64_t key) const;
+    std::string indexPath() const;
+    void loadIndex();
+    bool saveIndex();
+
+    std::mutex m_mutex;
+    std::string m_directory;
+    LruCache<uint64_t, uint64_t> m_entries; // key -> file size, cost is the size as well
+    bool m_index_dirty {false};
+};
+
+#endif // DISK_RESULT_CACHE_H
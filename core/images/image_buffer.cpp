@@ -42,7 +42,7 @@ bool ImageBuffer::init(int width, int height, ImageFormat format, ChannelOrder c
     return true;
 }
 
-bool ImageBuffer::init(unsigned char* buffer, int width, int height, ImageFormat format, ChannelOrder channelOrder)
+bool ImageBuffer::init(unsigned char* buffer, int width, int height, ImageFormat format, ChannelOrder channelOrder, bool takeOwnership)
 {
     m_width = width;
     m_height = height;
@@ -71,7 +71,7 @@ bool ImageBuffer::init(unsigned char* buffer, int width, int height, ImageFormat
 
     m_strideBytes = m_width * m_bytesPerPixel;
     m_data = buffer;
-    m_all_your_datas_are_belong_to_us = false;
+    m_all_your_datas_are_belong_to_us = takeOwnership; // must come from malloc, it's released with free()
 
     return true;
 }
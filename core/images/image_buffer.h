@@ -11,7 +11,7 @@ public:
     ImageBuffer() = default;
     virtual ~ImageBuffer();
     bool init(int width, int height, ImageFormat format, ChannelOrder channelOrder);
-    bool init(unsigned char* buffer, int width, int height, ImageFormat format, ChannelOrder channelOrder);
+    bool init(unsigned char* buffer, int width, int height, ImageFormat format, ChannelOrder channelOrder, bool takeOwnership = false);
 
     virtual int width();
     virtual int height();
@@ -3,10 +3,12 @@
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb_image_write.h"
 #include "image_utils.h"
+#include "hash_utils.h"
 #include <string>
 #include <iostream>
 #include <fstream>
 #include <cmath>
+#include <algorithm>
 
 using namespace std;
 
@@ -421,7 +423,8 @@ ArkImagePtr getImage(const std::string img_text)
     if (image != nullptr) 
     {
         image_buffer = std::make_shared<ImageBuffer>();
-        if(!image_buffer->init(image, width, height, ImageFormat::RGB8, ChannelOrder::RGBA))
+        // stb allocates with malloc so the buffer can hand it back with free()
+        if(!image_buffer->init(image, width, height, ImageFormat::RGB8, ChannelOrder::RGBA, true))
             stbi_image_free(image);  // Remember to free the allocated memory
     }
     return image_buffer;
@@ -456,6 +459,113 @@ std::string imageToPNG(ArkImagePtr img)
     return std::move(ret_string);
 }
 
+static void appendToString(void *context, void *data, int size)
+{
+    static_cast<std::string *>(context)->append(static_cast<const char *>(data), static_cast<size_t>(size));
+}
+
+// averages downscale x downscale blocks of an RGBA8 image
+static std::shared_ptr<ImageBuffer> downscaleRGBA8(const ArkImagePtr img, int downscale)
+{
+    int width = std::max(1, img->width() / downscale);
+    int height = std::max(1, img->height() / downscale);
+    std::shared_ptr<ImageBuffer> scaled = std::make_shared<ImageBuffer>();
+    scaled->init(width, height, ImageFormat::RGBA8, ChannelOrder::RGBA);
+
+    const uint8_t *src = static_cast<const uint8_t *>(img->data());
+    uint8_t *dst = static_cast<uint8_t *>(scaled->data());
+    int src_stride = img->strideBytes();
+    int dst_stride = scaled->strideBytes();
+    int block = downscale * downscale;
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            int sum[4] = {0, 0, 0, 0};
+            for (int by = 0; by < downscale; by++)
+            {
+                const uint8_t *row = src + static_cast<size_t>(src_stride) * (y * downscale + by) + static_cast<size_t>(x * downscale) * 4;
+                for (int bx = 0; bx < downscale; bx++)
+                {
+                    for (int c = 0; c < 4; c++)
+                        sum[c] += row[bx * 4 + c];
+                }
+            }
+            uint8_t *pixel = dst + static_cast<size_t>(dst_stride) * y + static_cast<size_t>(x) * 4;
+            for (int c = 0; c < 4; c++)
+                pixel[c] = static_cast<uint8_t>(sum[c] / block);
+        }
+    }
+    return scaled;
+}
+
+// img as tightly packed 8 bit RGBA, img itself when it already is
+static ArkImagePtr packedRGBA8(const ArkImagePtr img)
+{
+    bool is_rgba8 = img->format() == ImageFormat::RGBA8 && img->channelOrder() == ChannelOrder::RGBA;
+    if (is_rgba8 && img->strideBytes() == img->width() * 4)
+        return img;
+
+    std::shared_ptr<ImageBuffer> imgBuf = std::make_shared<ImageBuffer>();
+    imgBuf->init(img->width(), img->height(), ImageFormat::RGBA8, ChannelOrder::RGBA);
+    if (is_rgba8)
+    {
+        // only the row padding differs
+        size_t row_bytes = static_cast<size_t>(img->width()) * 4;
+        for (int y = 0; y < img->height(); y++)
+        {
+            memcpy(static_cast<uint8_t *>(imgBuf->data()) + static_cast<size_t>(imgBuf->strideBytes()) * y,
+                   static_cast<const uint8_t *>(img->data()) + static_cast<size_t>(img->strideBytes()) * y,
+                   row_bytes);
+        }
+    }
+    else
+    {
+        copyImage(img, imgBuf);
+    }
+    return imgBuf;
+}
+
+ArkImagePtr downscaleImage(const ArkImagePtr src, int factor)
+{
+    if (!src || !src->data())
+        return nullptr;
+    if (factor <= 1)
+        return cloneImage(src);
+    return downscaleRGBA8(packedRGBA8(src), factor);
+}
+
+std::string encodeImage(ArkImagePtr img, ImageCodec codec, int quality, int downscale)
+{
+    std::string encoded;
+    if (img == nullptr)
+        return encoded;
+
+    // every codec is written from tightly packed 8 bit RGBA, the BMP and JPEG writers take no stride
+    ArkImagePtr imgToWrite = packedRGBA8(img);
+    if (downscale > 1)
+    {
+        imgToWrite = downscaleRGBA8(imgToWrite, downscale);
+    }
+
+    const unsigned char *pixels = static_cast<const unsigned char *>(imgToWrite->data());
+    int width = imgToWrite->width();
+    int height = imgToWrite->height();
+    switch (codec)
+    {
+        case ImageCodec::PNG:
+            stbi_write_png_to_func(appendToString, &encoded, width, height, 4, pixels, imgToWrite->strideBytes());
+            break;
+        case ImageCodec::BMP:
+            stbi_write_bmp_to_func(appendToString, &encoded, width, height, 4, pixels);
+            break;
+        case ImageCodec::JPEG:
+            stbi_write_jpg_to_func(appendToString, &encoded, width, height, 4, pixels, quality);
+            break;
+    }
+    return encoded;
+}
+
 // Function to resize an ArkImage using bilinear interpolation
 // Currently only handles scaling up
 ArkImage* resizeImageUp(ArkImage *inputImage, int newWidth, int newHeight)
@@ -503,10 +613,13 @@ ArkImage* resizeImageUp(ArkImage *inputImage, int newWidth, int newHeight)
             // Perform bilinear interpolation
             for (int channel = 0; channel < inputImage->numChannels(); ++channel)
             {
+                // the last row and column have no neighbour past them, they blend with themselves
+                int xStep = xInt + 1 < inputImage->width() ? inputImage->bytesPerPixel() : 0;
+                int yStep = yInt + 1 < inputImage->height() ? inputImage->strideBytes() : 0;
                 int topLeftIndex = (yInt * inputImage->strideBytes()) + (xInt * inputImage->bytesPerPixel()) + channel;
-                int topRightIndex = topLeftIndex + inputImage->bytesPerPixel();
-                int bottomLeftIndex = topLeftIndex + inputImage->strideBytes();
-                int bottomRightIndex = bottomLeftIndex + inputImage->bytesPerPixel();
+                int topRightIndex = topLeftIndex + xStep;
+                int bottomLeftIndex = topLeftIndex + yStep;
+                int bottomRightIndex = bottomLeftIndex + xStep;
 
                 // Bilinear interpolation formula
                 double topInterpolation = inputData[topLeftIndex] * (1.0 - xFrac) + inputData[topRightIndex] * xFrac;
@@ -523,3 +636,46 @@ ArkImage* resizeImageUp(ArkImage *inputImage, int newWidth, int newHeight)
     return outputImage;
 }
 
+
+uint64_t imageContentHash(const ArkImagePtr img)
+{
+    if (!img || !img->data())
+        return 0;
+
+    // hash the layout along with the pixels so an identical buffer in a different format doesn't collide
+    uint64_t hash = kHashSeed;
+    hash = hashCombine(hash, static_cast<uint64_t>(img->width()));
+    hash = hashCombine(hash, static_cast<uint64_t>(img->height()));
+    hash = hashCombine(hash, static_cast<uint64_t>(img->format()));
+    hash = hashCombine(hash, static_cast<uint64_t>(img->channelOrder()));
+
+    // row by row so the stride padding doesn't end up in the hash
+    const uint8_t *data = static_cast<const uint8_t *>(img->data());
+    const size_t row_bytes = static_cast<size_t>(img->width()) * img->bytesPerPixel();
+    for (int y = 0; y < img->height(); y++)
+    {
+        hash = hash64(data + static_cast<ptrdiff_t>(y) * img->strideBytes(), row_bytes, hash);
+    }
+    return hash;
+}
+
+ArkImagePtr cloneImage(const ArkImagePtr src)
+{
+    if (!src || !src->data())
+        return nullptr;
+
+    std::shared_ptr<ImageBuffer> clone = std::make_shared<ImageBuffer>();
+    clone->init(src->width(), src->height(), src->format(), src->channelOrder());
+    if (!clone->data())
+        return nullptr;
+
+    // host buffers can be padded, the clone is packed
+    const uint8_t *src_data = static_cast<const uint8_t *>(src->data());
+    uint8_t *dst_data = static_cast<uint8_t *>(clone->data());
+    const size_t row_bytes = static_cast<size_t>(clone->strideBytes());
+    for (int y = 0; y < src->height(); y++)
+    {
+        memcpy(dst_data + static_cast<ptrdiff_t>(y) * clone->strideBytes(), src_data + static_cast<ptrdiff_t>(y) * src->strideBytes(), row_bytes);
+    }
+    return clone;
+}
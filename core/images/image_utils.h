@@ -4,14 +4,29 @@
 #include "ark_image.h"
 #include "image_buffer.h"
 #include <string>
+#include <cstdint>
+
+enum class ImageCodec
+{
+    PNG,
+    BMP, // uncompressed, for links where encoding costs more than it saves
+    JPEG // lossy, drops alpha
+};
 
 bool copyImage(const ArkImagePtr src, ArkImagePtr dest, int downsampleX = 1, int downsampleY = 1);
 bool copyAlphaToImage(const ArkImagePtr src, ArkImagePtr dst);
 ArkImagePtr getImage(const std::string img_text);
 std::string imageToPNG(ArkImagePtr img);
+// quality is only used by JPEG, downscale shrinks both sides by that integer factor
+std::string encodeImage(ArkImagePtr img, ImageCodec codec, int quality = 90, int downscale = 1);
 void fillImageBlack(const ArkImagePtr img);
 void fillImage(const ArkImagePtr img, const Color &color);
 ArkImage* resizeImageUp(ArkImage *inputImage, int newWidth, int newHeight);
+uint64_t imageContentHash(const ArkImagePtr img);
+// deep copy into memory we own, for images that have to outlive the host buffer they came from
+ArkImagePtr cloneImage(const ArkImagePtr src);
+// owned copy with both sides shrunk by factor, box filtered, as packed 8 bit RGBA
+ArkImagePtr downscaleImage(const ArkImagePtr src, int factor);
 
 inline uint16_t normalizePixelValueTo16(float pixelValue)
 {
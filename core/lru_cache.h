@@ -0,0 +1,120 @@
+#ifndef LRU_CACHE_H
+#define LRU_CACHE_H
+
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+// Least recently used cache bounded by a total cost. Every entry costs 1 unless
+// told otherwise, so capacity is an entry count by default and a byte budget
+// when the caller passes sizes. Not thread safe, guard it if shared.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache
+{
+public:
+    explicit LruCache(size_t capacity)
+    : m_capacity(capacity)
+    { }
+
+    bool get(const Key &key, Value &out_value)
+    {
+        auto it = m_index.find(key);
+        if (it == m_index.end())
+            return false;
+
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        out_value = it->second->value;
+        return true;
+    }
+
+    bool contains(const Key &key) const
+    {
+        return m_index.find(key) != m_index.end();
+    }
+
+    // entries costing more than the whole capacity are not stored
+    void put(const Key &key, const Value &value, size_t cost = 1)
+    {
+        erase(key);
+        if (cost > m_capacity)
+            return;
+
+        m_entries.push_front({key, value, cost});
+        m_index[key] = m_entries.begin();
+        m_total_cost += cost;
+        evict();
+    }
+
+    bool erase(const Key &key)
+    {
+        auto it = m_index.find(key);
+        if (it == m_index.end())
+            return false;
+
+        m_total_cost -= it->second->cost;
+        m_entries.erase(it->second);
+        m_index.erase(it);
+        return true;
+    }
+
+    void clear()
+    {
+        m_entries.clear();
+        m_index.clear();
+        m_total_cost = 0;
+    }
+
+    // called for entries pushed out by the capacity, not for erase() or clear()
+    void setEvictionHandler(std::function<void(const Key &, const Value &)> handler)
+    {
+        m_eviction_handler = std::move(handler);
+    }
+
+    void setCapacity(size_t capacity)
+    {
+        m_capacity = capacity;
+        evict();
+    }
+
+    size_t size() const { return m_index.size(); }
+    size_t totalCost() const { return m_total_cost; }
+    size_t capacity() const { return m_capacity; }
+
+    // most recently used first
+    template <typename Func>
+    void forEach(Func func) const
+    {
+        for (const auto &entry : m_entries)
+            func(entry.key, entry.value);
+    }
+
+protected:
+    struct Entry
+    {
+        Key key;
+        Value value;
+        size_t cost;
+    };
+
+    void evict()
+    {
+        while (m_total_cost > m_capacity && !m_entries.empty())
+        {
+            Entry &oldest = m_entries.back();
+            if (m_eviction_handler)
+                m_eviction_handler(oldest.key, oldest.value);
+            m_total_cost -= oldest.cost;
+            m_index.erase(oldest.key);
+            m_entries.pop_back();
+        }
+    }
+
+    size_t m_capacity;
+    size_t m_total_cost {0};
+    std::list<Entry> m_entries;
+    std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> m_index;
+    std::function<void(const Key &, const Value &)> m_eviction_handler;
+};
+
+#endif // LRU_CACHE_H
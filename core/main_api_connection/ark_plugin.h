@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <cstdint>
 #include <iostream>
 #include <regex>
 #include "parameter.h"
@@ -212,19 +213,6 @@ struct Endpoint
         return count;
     }
 
-    bool setInputId(const std::string &param_name, const std::string &img_id)
-    {
-        for (auto& param : endpoint_params)
-        {
-            if (param.name == param_name)
-            {
-                param.string_val = img_id;
-                return true;
-            }
-        }
-        return false;
-    }
-
     ParameterType paramTypeFromString(const std::string param_string) const
     {
         ParameterType param_type{ParameterType::Unknown};
@@ -329,6 +317,7 @@ struct Config
     std::string model_name;
     std::string model_dtype;
     bool save_output {false};
+    uint64_t hash {0}; // of the whole config object, settings we don't parse change the output too
 };
 
 struct ArkPlugin
@@ -0,0 +1,117 @@
+#include "backend_pool.h"
+#include "circuit_breaker.h"
+#include "logger.h"
+#include <algorithm>
+
+BackendPool::BackendPool(const std::vector<BackendNode> &nodes)
+{
+    for (const auto &node : nodes)
+    {
+        NodeState state;
+        state.node = node;
+        if (state.node.base_url.empty() || state.node.base_url.back() != '/')
+            state.node.base_url += '/';
+        m_nodes.push_back(state);
+    }
+}
+
+BackendPool &BackendPool::instance()
+{
+    static BackendPool pool(ApiConnection::configuredBackends());
+    return pool;
+}
+
+bool BackendPool::isHealthy(const BackendNode &node) const
+{
+    return !CircuitBreaker::forBackend(node.base_url + node.unix_socket).isOpen();
+}
+
+bool BackendPool::acquire(BackendNode &out_node, const std::vector<std::string> &exclude)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    int best = -1;
+    bool best_healthy = false;
+    for (size_t i = 0; i < m_nodes.size(); i++)
+    {
+        size_t index = (m_next + i) % m_nodes.size();
+        const NodeState &state = m_nodes[index];
+        if (std::find(exclude.begin(), exclude.end(), state.node.base_url) != exclude.end())
+            continue;
+
+        bool healthy = isHealthy(state.node);
+        if (best < 0 ||
+            (healthy && !best_healthy) ||
+            (healthy == best_healthy && state.outstanding < m_nodes[best].outstanding))
+        {
+            best = static_cast<int>(index);
+            best_healthy = healthy;
+        }
+    }
+
+    if (best < 0)
+        return false;
+
+    m_nodes[best].outstanding++;
+    m_next = (static_cast<size_t>(best) + 1) % m_nodes.size();
+    out_node = m_nodes[best].node;
+    return true;
+}
+
+void BackendPool::release(const BackendNode &node)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto &state : m_nodes)
+    {
+        if (state.node.base_url == node.base_url && state.outstanding > 0)
+        {
+            state.outstanding--;
+            return;
+        }
+    }
+}
+
+BackendNode BackendPool::nodeForUrl(const std::string &base_url) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto &state : m_nodes)
+    {
+        if (state.node.base_url == base_url)
+            return state.node;
+    }
+    return m_nodes.empty() ? BackendNode{} : m_nodes.front().node;
+}
+
+bool BackendPool::hasAvailableNode() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto &state : m_nodes)
+    {
+        if (isHealthy(state.node))
+            return true;
+    }
+    return false;
+}
+
+int BackendPool::outstanding(const std::string &base_url) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto &state : m_nodes)
+    {
+        if (state.node.base_url == base_url)
+            return state.outstanding;
+    }
+    return 0;
+}
+
+BackendLease::BackendLease(BackendPool &pool, const std::vector<std::string> &exclude)
+: m_pool(pool)
+{
+    m_valid = m_pool.acquire(m_node, exclude);
+}
+
+BackendLease::~BackendLease()
+{
+    if (m_valid)
+        m_pool.release(m_node);
+}
@@ -0,0 +1,66 @@
+#ifndef BACKEND_POOL_H
+#define BACKEND_POOL_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include "main_api_connection.h"
+
+// The backends work can be spread over (Backend_Pool in Config.json, or just the default one).
+// Jobs go to the healthy node with the fewest jobs outstanding, nodes whose circuit breaker
+// is open are only picked when nothing else is left.
+class BackendPool
+{
+public:
+    explicit BackendPool(const std::vector<BackendNode> &nodes);
+
+    static BackendPool &instance();
+
+    // nodes whose base url is in exclude are skipped, false when that leaves nothing
+    bool acquire(BackendNode &out_node, const std::vector<std::string> &exclude = {});
+    void release(const BackendNode &node);
+
+    // results only exist on the node that rendered them, the node with base_url. Urls that
+    // are no longer configured, or empty ones, fall back to the first node
+    BackendNode nodeForUrl(const std::string &base_url) const;
+
+    bool hasAvailableNode() const;
+    size_t size() const { return m_nodes.size(); }
+    int outstanding(const std::string &base_url) const;
+
+protected:
+    struct NodeState
+    {
+        BackendNode node;
+        int outstanding {0};
+    };
+
+    bool isHealthy(const BackendNode &node) const;
+
+    mutable std::mutex m_mutex;
+    std::vector<NodeState> m_nodes;
+    size_t m_next {0}; // rotates ties so equally loaded nodes take turns
+};
+
+// Holds a job slot on one node for as long as the job runs, so its uploads, execution,
+// status polls and result download all go to the same backend
+class BackendLease
+{
+public:
+    explicit BackendLease(BackendPool &pool, const std::vector<std::string> &exclude = {});
+    ~BackendLease();
+
+    BackendLease(const BackendLease &) = delete;
+    BackendLease &operator=(const BackendLease &) = delete;
+
+    bool valid() const { return m_valid; }
+    const BackendNode &node() const { return m_node; }
+    ApiConnection connection() const { return ApiConnection(m_node); }
+
+protected:
+    BackendPool &m_pool;
+    BackendNode m_node;
+    bool m_valid {false};
+};
+
+#endif // BACKEND_POOL_H
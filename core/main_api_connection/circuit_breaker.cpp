@@ -0,0 +1,105 @@
+#include "circuit_breaker.h"
+#include "logger.h"
+#include <map>
+#include <memory>
+
+CircuitBreaker::CircuitBreaker(int failure_threshold, std::chrono::milliseconds cooldown)
+: m_failure_threshold(failure_threshold)
+, m_cooldown(cooldown)
+{ }
+
+CircuitBreaker &CircuitBreaker::forBackend(const std::string &endpoint)
+{
+    static std::mutex registry_mutex;
+    static std::map<std::string, std::unique_ptr<CircuitBreaker>> breakers;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    std::unique_ptr<CircuitBreaker> &breaker = breakers[endpoint];
+    if (!breaker)
+    {
+        breaker = std::make_unique<CircuitBreaker>();
+    }
+    return *breaker;
+}
+
+bool CircuitBreaker::allowRequest(Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_state == State::Closed)
+    {
+        return true;
+    }
+
+    if (m_state == State::Open && now - m_opened_at >= m_cooldown)
+    {
+        m_state = State::HalfOpen;
+        m_probe_in_flight = false;
+    }
+
+    // half open lets exactly one request find out whether the backend is back
+    if (m_state == State::HalfOpen && !m_probe_in_flight)
+    {
+        m_probe_in_flight = true;
+        return true;
+    }
+    return false;
+}
+
+void CircuitBreaker::recordSuccess()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_state != State::Closed)
+    {
+        LogInfo("Backend reachable again, closing circuit breaker");
+    }
+    m_state = State::Closed;
+    m_consecutive_failures = 0;
+    m_probe_in_flight = false;
+}
+
+void CircuitBreaker::recordFailure(Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_consecutive_failures++;
+    m_probe_in_flight = false;
+    if (m_state == State::HalfOpen || (m_state == State::Closed && m_consecutive_failures >= m_failure_threshold))
+    {
+        if (m_state == State::Closed)
+        {
+            LogWarning("Backend failed " + std::to_string(m_consecutive_failures) + " times in a row, failing fast for " +
+                       std::to_string(m_cooldown.count()) + " ms");
+        }
+        m_state = State::Open;
+        m_opened_at = now;
+    }
+}
+
+void CircuitBreaker::reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_state = State::Closed;
+    m_consecutive_failures = 0;
+    m_probe_in_flight = false;
+}
+
+CircuitBreaker::State CircuitBreaker::state() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_state;
+}
+
+bool CircuitBreaker::isOpen(Clock::time_point now) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_state == State::Open && now - m_opened_at < m_cooldown;
+}
+
+int CircuitBreaker::consecutiveFailures() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_consecutive_failures;
+}
@@ -0,0 +1,48 @@
+#ifndef CIRCUIT_BREAKER_H
+#define CIRCUIT_BREAKER_H
+
+#include <string>
+#include <chrono>
+#include <mutex>
+
+// Remembers that the backend is down so calls fail straight away instead of each one
+// waiting out its timeout. Opens after failure_threshold consecutive failures, then lets
+// a single probe through every cooldown until one succeeds.
+class CircuitBreaker
+{
+public:
+    enum class State
+    {
+        Closed,
+        Open,
+        HalfOpen
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    CircuitBreaker(int failure_threshold = 3, std::chrono::milliseconds cooldown = std::chrono::seconds(5));
+
+    // one per backend endpoint, shared by every ApiConnection talking to it
+    static CircuitBreaker &forBackend(const std::string &endpoint);
+
+    bool allowRequest(Clock::time_point now = Clock::now());
+    void recordSuccess();
+    void recordFailure(Clock::time_point now = Clock::now());
+    void reset();
+
+    State state() const;
+    bool isOpen(Clock::time_point now = Clock::now()) const;
+    int consecutiveFailures() const;
+
+protected:
+    const int m_failure_threshold;
+    const std::chrono::milliseconds m_cooldown;
+
+    mutable std::mutex m_mutex;
+    State m_state {State::Closed};
+    int m_consecutive_failures {0};
+    bool m_probe_in_flight {false};
+    Clock::time_point m_opened_at;
+};
+
+#endif // CIRCUIT_BREAKER_H
@@ -0,0 +1,173 @@
+#include "endpoint_request_builder.h"
+#include "hash_utils.h"
+#include <algorithm>
+#include <cstring>
+
+EndpointRequestBuilder::EndpointRequestBuilder(const EndpointRequestBuilder &other)
+: m_fields(other.m_fields.begin(), other.m_fields.begin() + other.m_count)
+, m_count(other.m_count)
+{ }
+
+EndpointRequestBuilder &EndpointRequestBuilder::operator=(const EndpointRequestBuilder &other)
+{
+    if (this == &other)
+        return *this;
+
+    clear();
+    if (m_fields.size() < other.m_count)
+        m_fields.resize(other.m_count);
+    std::copy(other.m_fields.begin(), other.m_fields.begin() + other.m_count, m_fields.begin());
+    m_count = other.m_count;
+    return *this;
+}
+
+void EndpointRequestBuilder::clear()
+{
+    m_count = 0;
+    m_sorted_valid = m_json_valid = m_hash_valid = false;
+}
+
+EndpointRequestBuilder::Field &EndpointRequestBuilder::nextField(const std::string &name, FieldType type)
+{
+    m_sorted_valid = m_json_valid = m_hash_valid = false;
+
+    // a repeated key replaces the earlier value, JSON objects can't hold both
+    for (size_t i = 0; i < m_count; i++)
+    {
+        if (m_fields[i].name == name)
+        {
+            m_fields[i].type = type;
+            return m_fields[i];
+        }
+    }
+
+    if (m_count == m_fields.size())
+        m_fields.emplace_back();
+    Field &field = m_fields[m_count++];
+    field.name = name;
+    field.type = type;
+    return field;
+}
+
+void EndpointRequestBuilder::addInt(const std::string &name, int value)
+{
+    nextField(name, FieldType::Int).int_value = value;
+}
+
+void EndpointRequestBuilder::addFloat(const std::string &name, float value)
+{
+    // -0 and 0 are the same slider position
+    nextField(name, FieldType::Float).float_value = value == 0.0f ? 0.0f : value;
+}
+
+void EndpointRequestBuilder::addBool(const std::string &name, bool value)
+{
+    nextField(name, FieldType::Bool).bool_value = value;
+}
+
+void EndpointRequestBuilder::addString(const std::string &name, const std::string &value)
+{
+    nextField(name, FieldType::String).string_value = value;
+}
+
+void EndpointRequestBuilder::addStringList(const std::string &name, const std::vector<std::string> &values)
+{
+    nextField(name, FieldType::StringList).list_value = values;
+}
+
+void EndpointRequestBuilder::sortFields()
+{
+    if (m_sorted_valid)
+        return;
+
+    m_sorted.clear();
+    for (size_t i = 0; i < m_count; i++)
+        m_sorted.push_back(&m_fields[i]);
+    std::sort(m_sorted.begin(), m_sorted.end(), [](const Field *a, const Field *b) { return a->name < b->name; });
+    m_sorted_valid = true;
+}
+
+const std::string &EndpointRequestBuilder::json()
+{
+    if (m_json_valid)
+        return m_json;
+    sortFields();
+
+    m_buffer.Clear();
+    m_writer.Reset(m_buffer);
+    // same precision the params were sent with before, and 0.1f doesn't turn into 0.10000000149011612
+    m_writer.SetMaxDecimalPlaces(6);
+
+    m_writer.StartObject();
+    for (const Field *field : m_sorted)
+    {
+        m_writer.Key(field->name.c_str(), static_cast<rapidjson::SizeType>(field->name.size()));
+        switch (field->type)
+        {
+            case FieldType::Int:
+                m_writer.Int(field->int_value);
+                break;
+            case FieldType::Float:
+                m_writer.Double(field->float_value);
+                break;
+            case FieldType::Bool:
+                m_writer.Bool(field->bool_value);
+                break;
+            case FieldType::String:
+                m_writer.String(field->string_value.c_str(), static_cast<rapidjson::SizeType>(field->string_value.size()));
+                break;
+            case FieldType::StringList:
+                m_writer.StartArray();
+                for (const auto &value : field->list_value)
+                    m_writer.String(value.c_str(), static_cast<rapidjson::SizeType>(value.size()));
+                m_writer.EndArray();
+                break;
+        }
+    }
+    m_writer.EndObject();
+
+    m_json.assign(m_buffer.GetString(), m_buffer.GetSize());
+    m_json_valid = true;
+    return m_json;
+}
+
+// only touches the values, so checking whether anything changed never has to write the JSON
+uint64_t EndpointRequestBuilder::hash()
+{
+    if (m_hash_valid)
+        return m_hash;
+    sortFields();
+
+    m_hash = kHashSeed;
+    for (const Field *field : m_sorted)
+    {
+        m_hash = hashCombine(m_hash, hash64(field->name));
+        m_hash = hashCombine(m_hash, static_cast<uint64_t>(field->type));
+        switch (field->type)
+        {
+            case FieldType::Int:
+                m_hash = hashCombine(m_hash, static_cast<uint64_t>(static_cast<int64_t>(field->int_value)));
+                break;
+            case FieldType::Float:
+            {
+                uint32_t bits;
+                std::memcpy(&bits, &field->float_value, sizeof(bits));
+                m_hash = hashCombine(m_hash, bits);
+                break;
+            }
+            case FieldType::Bool:
+                m_hash = hashCombine(m_hash, field->bool_value ? 1 : 0);
+                break;
+            case FieldType::String:
+                m_hash = hashCombine(m_hash, hash64(field->string_value));
+                break;
+            case FieldType::StringList:
+                for (const auto &value : field->list_value)
+                    m_hash = hashCombine(m_hash, hash64(value));
+                m_hash = hashCombine(m_hash, field->list_value.size());
+                break;
+        }
+    }
+    m_hash_valid = true;
+    return m_hash;
+}
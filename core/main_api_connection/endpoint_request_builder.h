@@ -0,0 +1,71 @@
+#ifndef ENDPOINT_REQUEST_BUILDER_H
+#define ENDPOINT_REQUEST_BUILDER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+// Builds the JSON body for call_endpoint. Keys come out sorted, so the same params always
+// give the same bytes. hash() covers the values themselves rather than the text, which keeps
+// it stable across sessions and platforms for cache keys, and it never writes the JSON so
+// checking for changes stays cheap. Field storage and the output buffer
+// are reused between builds, so keep one around instead of making a new one per request.
+class EndpointRequestBuilder
+{
+public:
+    EndpointRequestBuilder() = default;
+    // copies the fields only, the copy writes its own JSON
+    EndpointRequestBuilder(const EndpointRequestBuilder &other);
+    EndpointRequestBuilder &operator=(const EndpointRequestBuilder &other);
+
+    void clear();
+
+    void addInt(const std::string &name, int value);
+    void addFloat(const std::string &name, float value);
+    void addBool(const std::string &name, bool value);
+    void addString(const std::string &name, const std::string &value);
+    void addStringList(const std::string &name, const std::vector<std::string> &values);
+
+    const std::string &json();
+    uint64_t hash();
+    size_t fieldCount() const { return m_count; }
+
+protected:
+    enum class FieldType
+    {
+        Int,
+        Float,
+        Bool,
+        String,
+        StringList
+    };
+
+    struct Field
+    {
+        std::string name;
+        FieldType type {FieldType::Int};
+        int int_value {0};
+        float float_value {0.0f};
+        bool bool_value {false};
+        std::string string_value;
+        std::vector<std::string> list_value;
+    };
+
+    Field &nextField(const std::string &name, FieldType type);
+    void sortFields();
+
+    std::vector<Field> m_fields; // only the first m_count are in use, the rest keep their capacity
+    size_t m_count {0};
+    std::vector<const Field *> m_sorted;
+    rapidjson::StringBuffer m_buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> m_writer;
+    std::string m_json;
+    uint64_t m_hash {0};
+    bool m_sorted_valid {false};
+    bool m_json_valid {false};
+    bool m_hash_valid {false};
+};
+
+#endif // ENDPOINT_REQUEST_BUILDER_H
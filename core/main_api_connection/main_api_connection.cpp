@@ -3,14 +3,329 @@
 #include <rapidjson/document.h>
 #include <cpr/cpr.h>
 #include "images/image_utils.h"
+#include "response_cache.h"
+#include "lru_cache.h"
+#include "hash_utils.h"
+#include "shm_transport.h"
+#include "circuit_breaker.h"
+#include "single_flight.h"
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
 #include <filesystem>
+#include <mutex>
+#include <set>
+#include <cstring>
 #include "utils.h"
 
+// How long responses from the slow changing endpoints are served from the
+// response cache before they have to be revalidated with the backend
+static const std::chrono::seconds kPluginInfoTTL {300};
+static const std::chrono::seconds kPluginListTTL {60};
+static const std::chrono::seconds kLoginStatusTTL {10};
+static const std::chrono::seconds kSubscriptionLevelTTL {30};
+
+// content hash of the frames we already sent -> backend image id, so unchanged frames aren't uploaded again
+static const size_t kUploadCacheEntries = 256;
+
+struct UploadCache
+{
+    std::mutex mutex;
+    LruCache<uint64_t, std::string> images {kUploadCacheEntries};
+};
+
+static UploadCache &uploadCache()
+{
+    static UploadCache cache;
+    return cache;
+}
+
+struct FetchedImage
+{
+    ArkImagePtr img;
+    std::string encoded; // only kept when the caller asked for it
+};
+
+// decoded results, so redrawing an unchanged frame doesn't download and decode it again.
+// Keyed by backend url and image id, ids are only unique per backend
+static const size_t kDecodedImageCacheBytes = 512 * 1024 * 1024;
+
+struct DecodedImageCache
+{
+    std::mutex mutex;
+    LruCache<std::string, FetchedImage> images {kDecodedImageCacheBytes};
+};
+
+static DecodedImageCache &decodedImageCache()
+{
+    static DecodedImageCache cache;
+    return cache;
+}
+
+struct CachedGetResult
+{
+    long status_code {0};
+    std::string text;
+};
+
+struct FetchedPluginInfo
+{
+    bool success {false};
+    ArkPlugin plugin;
+};
+
+// effect instances and host render threads tend to ask for the same thing at the same time,
+// identical requests in flight are sent once and everyone gets the parsed result.
+// Keyed by the full URL so connections to different backends never share
+struct InFlightRequests
+{
+    SingleFlight<std::string, CachedGetResult> gets;
+    SingleFlight<std::string, FetchedPluginInfo> plugin_infos;
+    SingleFlight<std::string, JobStatusResponse> job_statuses;
+    SingleFlight<std::string, FetchedImage> images;
+};
+
+static InFlightRequests &inFlightRequests()
+{
+    static InFlightRequests requests;
+    return requests;
+}
+
+// what older backends turned down: batch jobs answered with 404, they only know call_endpoint,
+// and cancelling a job answered with 405, they can only poll it
+struct BackendSupport
+{
+    std::mutex mutex;
+    std::set<std::string> no_batches;
+    std::set<std::string> no_cancel;
+};
+
+static BackendSupport &backendSupport()
+{
+    static BackendSupport support;
+    return support;
+}
+
+// a hung backend must not freeze the host, every request gets a deadline unless the caller passes a longer one
+static const std::chrono::milliseconds kConnectTimeout {1500};
+static const std::chrono::milliseconds kRequestTimeout {10000};
+static const std::chrono::milliseconds kStatusTimeout {2000};
+static const std::chrono::milliseconds kTransferTimeout {60000};
+// starting a plugin loads its model before the backend answers
+static const std::chrono::milliseconds kPluginStartTimeout {120000};
+static const std::chrono::seconds kBackendStartupTimeout {30};
+// a batch streams for as long as its frames take, this only catches a backend that stopped sending
+static const std::chrono::milliseconds kBatchStreamTimeout {600000};
+
+// Every request goes through sendRequest so the transport options, deadlines and the
+// circuit breaker are applied in a single place
+template <typename Send, typename... Ts>
+static cpr::Response sendRequest(const BackendTransport &transport, Send send, Ts&&... options)
+{
+    if (transport.breaker && !transport.probe && !transport.dialog && !transport.breaker->allowRequest())
+    {
+        cpr::Response response;
+        response.error = cpr::Error(CURLE_COULDNT_CONNECT, "Backend unavailable, circuit breaker open");
+        return response;
+    }
+
+    cpr::Session session;
+    if (!transport.unix_socket.empty())
+        session.SetOption(cpr::UnixSocket(transport.unix_socket));
+    session.SetOption(cpr::ConnectTimeout{kConnectTimeout});
+    std::chrono::milliseconds timeout = transport.timeout.count() > 0 ? transport.timeout : kRequestTimeout;
+    // 0 lets curl wait for as long as the dialog stays open
+    session.SetOption(cpr::Timeout{transport.dialog ? std::chrono::milliseconds(0) : timeout});
+    (session.SetOption(std::forward<Ts>(options)), ...);
+    cpr::Response response = send(session);
+
+    if (transport.breaker && !transport.dialog)
+    {
+        // only "nobody answered" counts, a 4xx still means the backend is up
+        if (response.error.code == cpr::ErrorCode::OK && response.status_code < 500)
+            transport.breaker->recordSuccess();
+        else
+            transport.breaker->recordFailure();
+    }
+    return response;
+}
+
+// the ui/* routes answer once the user closes the dialog they open
+static BackendTransport dialogTransport(const BackendTransport &transport)
+{
+    BackendTransport dialog = transport;
+    dialog.dialog = true;
+    return dialog;
+}
+
+template <typename... Ts>
+static cpr::Response httpGet(const BackendTransport &transport, Ts&&... options)
+{
+    return sendRequest(transport, [](cpr::Session &session) { return session.Get(); }, std::forward<Ts>(options)...);
+}
+
+template <typename... Ts>
+static cpr::Response httpPost(const BackendTransport &transport, Ts&&... options)
+{
+    return sendRequest(transport, [](cpr::Session &session) { return session.Post(); }, std::forward<Ts>(options)...);
+}
+
+template <typename... Ts>
+static cpr::Response httpPut(const BackendTransport &transport, Ts&&... options)
+{
+    return sendRequest(transport, [](cpr::Session &session) { return session.Put(); }, std::forward<Ts>(options)...);
+}
+
+template <typename... Ts>
+static cpr::Response httpHead(const BackendTransport &transport, Ts&&... options)
+{
+    return sendRequest(transport, [](cpr::Session &session) { return session.Head(); }, std::forward<Ts>(options)...);
+}
+
+template <typename... Ts>
+static cpr::Response httpDelete(const BackendTransport &transport, Ts&&... options)
+{
+    return sendRequest(transport, [](cpr::Session &session) { return session.Delete(); }, std::forward<Ts>(options)...);
+}
+
+struct BackendEndpoint
+{
+    std::string base_url {kDefaultBackendUrl};
+    std::string unix_socket;
+    std::vector<std::string> pool;
+    bool async_render {false};
+    bool proxy_upscale {false};
+    bool progressive_render {false};
+};
+
+static void normalizeBaseUrl(std::string &base_url)
+{
+    if (base_url.empty() || base_url.back() != '/')
+        base_url += '/';
+}
+
+// Where the backend listens, read once from Config.json (Backend_URL / Backend_Socket / Backend_Pool / Async_Render /
+// Proxy_Upscale / Progressive_Render) and overridable with DEEPMAKE_BACKEND_URL / DEEPMAKE_BACKEND_SOCKET /
+// DEEPMAKE_BACKEND_POOL / DEEPMAKE_ASYNC_RENDER / DEEPMAKE_PROXY_UPSCALE / DEEPMAKE_PROGRESSIVE_RENDER
+static const BackendEndpoint &backendEndpoint()
+{
+    static BackendEndpoint endpoint = []()
+    {
+        BackendEndpoint resolved;
+        std::string json_file_path = ApiConnection::getBackendConfigPath();
+        BackendConfig config;
+        PluginJsonParser parser;
+        if (!json_file_path.empty() && std::filesystem::exists(json_file_path) && parser.parseBackendConfigFile(json_file_path, config))
+        {
+            if (!config.backend_url.empty())
+                resolved.base_url = config.backend_url;
+            resolved.unix_socket = config.backend_socket;
+            resolved.pool = config.backend_pool;
+            resolved.async_render = config.async_render;
+            resolved.proxy_upscale = config.proxy_upscale;
+            resolved.progressive_render = config.progressive_render;
+        }
+
+        if (const char *url = std::getenv("DEEPMAKE_BACKEND_URL"))
+            resolved.base_url = url;
+        if (const char *socket_path = std::getenv("DEEPMAKE_BACKEND_SOCKET"))
+            resolved.unix_socket = socket_path;
+        if (const char *async_render = std::getenv("DEEPMAKE_ASYNC_RENDER"))
+            resolved.async_render = std::string(async_render) == "1";
+        if (const char *proxy_upscale = std::getenv("DEEPMAKE_PROXY_UPSCALE"))
+            resolved.proxy_upscale = std::string(proxy_upscale) == "1";
+        if (const char *progressive_render = std::getenv("DEEPMAKE_PROGRESSIVE_RENDER"))
+            resolved.progressive_render = std::string(progressive_render) == "1";
+        if (const char *pool = std::getenv("DEEPMAKE_BACKEND_POOL"))
+        {
+            // comma separated urls
+            resolved.pool.clear();
+            std::string urls = pool;
+            size_t start = 0;
+            while (start <= urls.size())
+            {
+                size_t end = urls.find(',', start);
+                if (end == std::string::npos)
+                    end = urls.size();
+                if (end > start)
+                    resolved.pool.push_back(urls.substr(start, end - start));
+                start = end + 1;
+            }
+        }
+
+        normalizeBaseUrl(resolved.base_url);
+        for (auto &url : resolved.pool)
+            normalizeBaseUrl(url);
+
+        TransferPolicy::setConfiguredThresholds(config.transfer);
+
+        LogInfo("Backend endpoint: " + resolved.base_url + (resolved.unix_socket.empty() ? "" : " via " + resolved.unix_socket));
+        if (!resolved.pool.empty())
+            LogInfo("Backend pool of " + std::to_string(resolved.pool.size()) + " nodes");
+        return resolved;
+    }();
+    return endpoint;
+}
+
+ApiConnection::ApiConnection()
+: ApiConnection(backendEndpoint().base_url, backendEndpoint().unix_socket)
+{ }
+
+ApiConnection::ApiConnection(const BackendNode &node)
+: ApiConnection(node.base_url, node.unix_socket)
+{ }
+
+ApiConnection::ApiConnection(const std::string &base_url, const std::string &unix_socket)
+: m_base_url(base_url)
+{
+    normalizeBaseUrl(m_base_url);
+    m_transport.unix_socket = unix_socket;
+    m_transfer_policy = &TransferPolicy::forBackend(m_base_url);
+    m_transport.breaker = &CircuitBreaker::forBackend(m_base_url + unix_socket);
+}
+
+bool ApiConnection::asyncRenderEnabled()
+{
+    return backendEndpoint().async_render;
+}
+
+bool ApiConnection::proxyUpscaleEnabled()
+{
+    return backendEndpoint().proxy_upscale;
+}
+
+bool ApiConnection::progressiveRenderEnabled()
+{
+    return backendEndpoint().progressive_render;
+}
+
+std::vector<BackendNode> ApiConnection::configuredBackends()
+{
+    const BackendEndpoint &endpoint = backendEndpoint();
+    if (endpoint.pool.empty())
+        return {BackendNode{endpoint.base_url, endpoint.unix_socket}};
+
+    std::vector<BackendNode> nodes;
+    for (const auto &url : endpoint.pool)
+    {
+        // the socket belongs to the default backend, should it also be listed in the pool
+        nodes.push_back(BackendNode{url, url == endpoint.base_url ? endpoint.unix_socket : ""});
+    }
+    return nodes;
+}
+
+bool ApiConnection::isBackendAvailable() const
+{
+    return !m_transport.breaker->isOpen();
+}
+
 bool ApiConnection::isBackendRunning() const
 {
     bool success = false;
 
-    cpr::Response response = cpr::Get(cpr::Url{m_base_url + "plugin/status/"});
+    // this is how we find out the backend is back, so it goes out even while the breaker is open
+    BackendTransport probe = m_transport;
+    probe.probe = true;
+    cpr::Response response = httpGet(probe, cpr::Url{m_base_url + "plugin/status/"}, cpr::Timeout{kStatusTimeout});
     if(response.status_code == 200)
     {
         success = true;
@@ -20,17 +335,18 @@ bool ApiConnection::isBackendRunning() const
 
 bool ApiConnection::getLoginStatus() const
 {
-    cpr::Response response = cpr::Get(cpr::Url{m_base_url + "login/status"});
+    std::string response_text;
+    long status_code = cachedGet(m_base_url + "login/status", kLoginStatusTTL, response_text);
     PluginJsonParser parser;
-    if(response.status_code == 200)
+    if(status_code == 200)
     {
         LogInfo("Request was successful!\n");
-        LogInfo("Response body:" + response.text);
-        return parser.parseLoginStatus(response.text);
+        LogInfo("Response body:" + response_text);
+        return parser.parseLoginStatus(response_text);
     }
     else
     {
-        std::string error_string("Login_Status request failed with status code: " + std::to_string(response.status_code));
+        std::string error_string("Login_Status request failed with status code: " + std::to_string(status_code));
         LogError(std::string(error_string));
     }
     return false;
@@ -38,7 +354,7 @@ bool ApiConnection::getLoginStatus() const
 
 std::string ApiConnection::getUserInfo() const
 {
-    cpr::Response response = cpr::Get(cpr::Url{m_base_url + "login/username"});
+    cpr::Response response = httpGet(m_transport, cpr::Url{m_base_url + "login/username"});
     PluginJsonParser parser;
     std::string username;
     if (getLoginStatus())
@@ -64,17 +380,17 @@ std::string ApiConnection::getUserInfo() const
 int ApiConnection::getUserSubscriptionLevel() const
 {
     std::string url = m_base_url + "login/subscription_level";
-    cpr::Response response = cpr::Get(cpr::Url{url});
+    std::string response_text;
+    long status_code = cachedGet(url, kSubscriptionLevelTTL, response_text);
     int subscriptionLevel = 0;
     PluginJsonParser parser;
 
-    if(response.status_code == 200)
+    if(status_code == 200)
     {
-        if(parser.parseSubscriptionLevel(response.text, subscriptionLevel))
+        if(parser.parseSubscriptionLevel(response_text, subscriptionLevel))
         {
             LogInfo("Request was successful!\n");
             LogInfo("Response body:");
-            parser.parseSubscriptionLevel(response.text, subscriptionLevel);
             if(subscriptionLevel == 0)
             {
                 LogInfo("User is not logged in");
@@ -89,7 +405,7 @@ int ApiConnection::getUserSubscriptionLevel() const
     }
     else
     {
-        std::string error_string("Request failed with status code: " + std::to_string(response.status_code));
+        std::string error_string("Request failed with status code: " + std::to_string(status_code));
         LogError(std::string(error_string));
     }
     return subscriptionLevel;
@@ -101,19 +417,20 @@ int ApiConnection::getPluginSubscriptionLevelRequirement(const std::string &plug
     {
         std::string url = m_base_url + "plugins/get_info/" + plugin_name;
 
-        cpr::Response response = cpr::Get(cpr::Url{url});
+        std::string response_text;
+        long status_code = cachedGet(url, kPluginInfoTTL, response_text);
         PluginJsonParser parser;
         ArkPlugin plugin;
-        if (response.status_code == 200)
+        if (status_code == 200)
         {
             LogInfo("Request was successful!\n");
             LogInfo("Response body:");
-            parser.parsePluginInfo(response.text, plugin);
+            parser.parsePluginInfo(response_text, plugin);
             return plugin.license_level;
         }
         else
         {
-            std::string error_string("Request failed with status code: " + std::to_string(response.status_code));
+            std::string error_string("Request failed with status code: " + std::to_string(status_code));
             LogError(std::string(error_string));
         }
     }
@@ -125,35 +442,48 @@ std::vector<std::string> ApiConnection::getPluginList() const
     std::vector<std::string> plugin_list;
     std::string url = m_base_url + "plugins/get_list";
 
-    cpr::Response response = cpr::Get(cpr::Url{url});
+    std::string response_text;
+    long status_code = cachedGet(url, kPluginListTTL, response_text);
 
-    if (response.status_code == 200)
+    if (status_code == 200)
     {
         LogInfo("Request was successful!\n");
     
-        if (validatePluginListResponse(response.text)) 
+        PluginJsonParser parser;
+        if (parser.parsePluginList(response_text, plugin_list)) 
         {
-            plugin_list = parsePluginList(response.text);
-            LogInfo("Response body:" + response.text);
+            LogInfo("Response body:" + response_text);
         }
         else
         {
-            LogError("Invalid plugin list response.");
+            LogError("Invalid plugin list response: " + parser.lastError().toString());
         }
     }
     else
     {
-        LogError("Request failed with status code: " + std::to_string(response.status_code));
+        LogError("Request failed with status code: " + std::to_string(status_code));
     }
     return std::move(plugin_list);
 }
 
+bool ApiConnection::logout() const
+{
+    cpr::Response response = httpGet(m_transport, cpr::Url{m_base_url + "login/logout"});
+    invalidateLoginCache();
+    if (response.status_code != 200)
+    {
+        LogError("Logout request failed with status code: " + std::to_string(response.status_code));
+        return false;
+    }
+    return true;
+}
+
 bool ApiConnection::startPlugin(const std::string &plugin_name) const
 {
     bool success = false;
     std::string url = m_base_url + "plugins/start_plugin/" + plugin_name;
 
-    cpr::Response response = cpr::Get(cpr::Url{url});
+    cpr::Response response = httpGet(m_transport, cpr::Url{url}, cpr::Timeout{kPluginStartTimeout});
 
     if (response.status_code == 200)
     {
@@ -176,7 +506,7 @@ bool ApiConnection::setConfig(const std::string &plugin_name, const std::string
     std::string url = m_base_url + "plugins/set_config/" + plugin_name;
     if (validateConfigJson(body))
     {
-        cpr::Response response = cpr::Put(cpr::Url{url},
+        cpr::Response response = httpPut(m_transport, cpr::Url{url},
                     cpr::Header{{"Content-Type", "application/json"}},
                     cpr::Header{{"accept", "application/json"}},
                     cpr::Header{{"Content-Length", std::to_string(body.size())}},
@@ -203,53 +533,81 @@ bool ApiConnection::setConfig(const std::string &plugin_name, const std::string
     return success;
 }
 
-bool ApiConnection::uploadImage(const ArkImagePtr &image, std::string &out_id) const
+bool ApiConnection::uploadImage(const ArkImagePtr &image, std::string &out_id, TransferRole role) const
 {
-    bool success = false;
-
     if (image == nullptr)
         return false;
 
-    std::string img_str = imageToPNG(image);
-    if (img_str.empty())
-        return false;
+    // shared memory moves raw pixels, the transfer policy is for what goes over the wire
+    bool use_shm = useSharedMemory();
+    TransferPlan plan;
+    if (!use_shm)
+        plan = m_transfer_policy->plan(static_cast<size_t>(image->width()) * image->height() * 4, role);
 
-    // Create a temporary file to store the string data
-    //This can be avoided if we change the networking library
-    //to something like https://github.com/jgaa/restc-cpp 
-    std::string tempFileName =  tmpDirectory() + "temp_img_file.txt";
-    std::ofstream tempFile(tempFileName, std::ios::binary);
-    if (!tempFile.is_open()) {
-        LogError("Failed to create temporary file.");
-        return false;
+    // an id is only good on the backend it was uploaded to, and a lossy upload is a different image
+    uint64_t content_hash = hashCombine(hash64(m_base_url), imageContentHash(image));
+    if (!plan.lossless())
+        content_hash = hashCombine(content_hash, hash64(plan.toString()));
+    if (findUploadedImage(content_hash, out_id))
+    {
+        LogInfo("Image already uploaded, reusing id: " + out_id);
+        return true;
+    }
+
+    bool success = false;
+    if (use_shm)
+        success = uploadImageShm(image, out_id);
+    if (!success)
+        success = uploadImageEncoded(image, plan, out_id);
+
+    if (success && !out_id.empty())
+    {
+        UploadCache &cache = uploadCache();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        cache.images.put(content_hash, out_id);
     }
-    tempFile.write(img_str.c_str(), img_str.size());
-    tempFile.close();
+    return success;
+}
+
+bool ApiConnection::uploadImageEncoded(const ArkImagePtr &image, const TransferPlan &plan, std::string &out_id) const
+{
+    bool success = false;
+
+    auto encode_start = std::chrono::steady_clock::now();
+    std::string img_str = encodeImage(image, plan.codec, plan.quality, plan.downscale);
+    if (img_str.empty())
+        return false;
+    std::chrono::duration<double> encode_time = std::chrono::steady_clock::now() - encode_start;
+    size_t raw_bytes = static_cast<size_t>(image->width() / plan.downscale) * (image->height() / plan.downscale) * 4;
+    m_transfer_policy->recordEncode(plan.codec, raw_bytes, img_str.size(), encode_time.count());
 
+    // sent from memory, a shared temp file would get mixed up between concurrent uploads
     cpr::Multipart formData{
-        {"file", cpr::File(tempFileName, "temp_data_file.txt")}
+        {"file", cpr::Buffer{img_str.begin(), img_str.end(), "temp_data_file.txt"}}
     };
-    
+
     std::string url = m_base_url + "image/upload";
-    cpr::Response response = cpr::Post(
+    cpr::Response response = httpPost(m_transport,
         cpr::Url{url},
         cpr::Multipart(formData),
-        cpr::Header{{"accept", "application/json"}}
+        cpr::Header{{"accept", "application/json"}},
+        cpr::Timeout{kTransferTimeout}
     );
-    std::remove(tempFileName.c_str());
+    if (response.status_code == 200)
+    {
+        m_transfer_policy->recordTransfer(img_str.size(), response.elapsed);
+        LogInfo("Uploaded " + std::to_string(img_str.size()) + " bytes as " + plan.toString());
+    }
 
     if (response.status_code == 200)
     {
         LogInfo("Request was successful!\n");
         LogInfo("Response body:" + response.text);
-        if (validateImgUploadResponse(response.text)) 
-        {
-            PluginJsonParser parser;
-            success = parser.parseUploadImageResponse(response.text, out_id);
-        }
-        else
+        PluginJsonParser parser;
+        success = parser.parseUploadImageResponse(response.text, out_id);
+        if (!success)
         {
-            LogError("Invalid image upload response.",true);
+            LogError("Invalid image upload response: " + parser.lastError().toString(), true);
         }
     }
     else
@@ -260,6 +618,183 @@ bool ApiConnection::uploadImage(const ArkImagePtr &image, std::string &out_id) c
     return success;
 }
 
+bool ApiConnection::useSharedMemory() const
+{
+    if (!ShmTransport::isSupported())
+        return false;
+
+    // the backend has to be able to open our segments, so only for one running on this machine
+    bool is_local = !m_transport.unix_socket.empty() ||
+                    m_base_url.rfind("http://localhost", 0) == 0 ||
+                    m_base_url.rfind("http://127.0.0.1", 0) == 0;
+    if (!is_local)
+        return false;
+
+    // ask once per backend whether it knows about the shared memory endpoints
+    static std::mutex support_mutex;
+    static std::map<std::string, bool> support;
+    std::lock_guard<std::mutex> lock(support_mutex);
+    auto it = support.find(m_base_url);
+    if (it == support.end())
+    {
+        cpr::Response response = httpGet(m_transport, cpr::Url{m_base_url + "image/shm_support"}, cpr::Timeout{1000});
+        bool supported = response.status_code == 200;
+        LogInfo(std::string("Shared memory frame transport ") + (supported ? "enabled" : "not supported by backend"));
+        it = support.emplace(m_base_url, supported).first;
+    }
+    return it->second;
+}
+
+bool ApiConnection::uploadImageShm(const ArkImagePtr &image, std::string &out_id) const
+{
+    bool success = false;
+
+    // frames go over as RGBA8, converted straight into the shared segment
+    const size_t stride = static_cast<size_t>(image->width()) * 4;
+    const size_t size = stride * image->height();
+    std::unique_lock<std::mutex> slot_lock;
+    SharedMemorySlot *slot = ShmTransport::instance().acquire(size, slot_lock);
+    if (slot == nullptr)
+        return false;
+
+    std::shared_ptr<ImageBuffer> shm_image = std::make_shared<ImageBuffer>();
+    shm_image->init(slot->data(), image->width(), image->height(), ImageFormat::RGBA8, ChannelOrder::RGBA);
+    if (!copyImage(image, shm_image))
+        return false;
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    writer.StartObject();
+    writer.Key("shm_name");
+    writer.String(slot->name().c_str());
+    writer.Key("size");
+    writer.Uint64(size);
+    writer.Key("width");
+    writer.Int(image->width());
+    writer.Key("height");
+    writer.Int(image->height());
+    writer.Key("channels");
+    writer.Int(4);
+    writer.Key("stride");
+    writer.Uint64(stride);
+    writer.EndObject();
+
+    // the backend copies the pixels out before it answers, after that the slot is free again
+    cpr::Response response = httpPost(m_transport, cpr::Url{m_base_url + "image/upload_shm"},
+                                       cpr::Header{{"Content-Type", "application/json"}},
+                                       cpr::Body{buffer.GetString()},
+                                       cpr::Timeout{kTransferTimeout});
+    PluginJsonParser parser;
+    if (response.status_code == 200)
+    {
+        success = parser.parseUploadImageResponse(response.text, out_id);
+        if (!success)
+            LogError("Invalid shared memory upload response: " + parser.lastError().toString());
+    }
+    else
+    {
+        LogError("Shared memory upload failed with status code: " + std::to_string(response.status_code));
+    }
+    return success;
+}
+
+ArkImagePtr ApiConnection::getImageShm(const std::string &img_id) const
+{
+    std::unique_lock<std::mutex> slot_lock;
+    // start with room for a 4K RGBA frame, the backend tells us if it needs more
+    size_t capacity = 3840 * 2160 * 4;
+    SharedMemorySlot *slot = ShmTransport::instance().acquire(capacity, slot_lock);
+    for (int attempt = 0; slot != nullptr && attempt < 2; attempt++)
+    {
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        writer.StartObject();
+        writer.Key("image_id");
+        writer.String(img_id.c_str());
+        writer.Key("shm_name");
+        writer.String(slot->name().c_str());
+        writer.Key("capacity");
+        writer.Uint64(slot->capacity());
+        writer.EndObject();
+
+        cpr::Response response = httpPost(m_transport, cpr::Url{m_base_url + "image/get_shm"},
+                                           cpr::Header{{"Content-Type", "application/json"}},
+                                           cpr::Body{buffer.GetString()},
+                                           cpr::Timeout{kTransferTimeout});
+
+        rapidjson::Document doc;
+        doc.Parse(response.text.c_str());
+        if (doc.HasParseError() || !doc.IsObject())
+            break;
+
+        if (response.status_code == 413 && doc.HasMember("size") && doc["size"].IsUint64())
+        {
+            if (!slot->reserve(doc["size"].GetUint64()))
+                break;
+            continue;
+        }
+
+        if (response.status_code != 200 ||
+            !doc.HasMember("width") || !doc["width"].IsInt() ||
+            !doc.HasMember("height") || !doc["height"].IsInt() ||
+            !doc.HasMember("channels") || !doc["channels"].IsInt())
+        {
+            break;
+        }
+
+        int width = doc["width"].GetInt();
+        int height = doc["height"].GetInt();
+        int channels = doc["channels"].GetInt();
+        size_t size = static_cast<size_t>(width) * height * channels;
+        if ((channels != 3 && channels != 4) || size > slot->capacity())
+            break;
+
+        // the slot gets reused by the next request so the pixels are copied out
+        std::shared_ptr<ImageBuffer> img = std::make_shared<ImageBuffer>();
+        img->init(width, height, channels == 4 ? ImageFormat::RGBA8 : ImageFormat::RGB8, ChannelOrder::RGBA);
+        memcpy(img->data(), slot->data(), size);
+        return img;
+    }
+
+    LogError("Shared memory getImage failed for " + img_id);
+    return nullptr;
+}
+
+bool ApiConnection::findUploadedImage(uint64_t content_hash, std::string &out_id) const
+{
+    UploadCache &cache = uploadCache();
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        if (!cache.images.get(content_hash, out_id))
+            return false;
+    }
+
+    // the backend may have dropped the image since we uploaded it (restart, cleanup), upload it again if so
+    if (!imageExists(out_id))
+    {
+        LogInfo("Uploaded image " + out_id + " is gone from the backend");
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        cache.images.erase(content_hash);
+        out_id.clear();
+        return false;
+    }
+    return true;
+}
+
+bool ApiConnection::imageExists(const std::string &img_id) const
+{
+    // HEAD keeps the image itself from being sent back, anything but a not found is taken as still there
+    cpr::Response response = httpHead(m_transport, cpr::Url{m_base_url + "image/get/" + img_id});
+    return response.status_code != 404 && response.status_code != 410;
+}
+
+void ApiConnection::invalidateUploadCache() const
+{
+    UploadCache &cache = uploadCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.images.clear();
+}
+
 bool ApiConnection::uploadMultipleImages(const std::vector<ArkImagePtr> &images, std::vector<std::string> &out_ids) const
 {
     bool success = true;
@@ -267,7 +802,7 @@ bool ApiConnection::uploadMultipleImages(const std::vector<ArkImagePtr> &images,
     for (const auto &image : images)
     {
         std::string out_id; 
-        if ((success = uploadImage(image, out_id)))
+        if ((success = uploadImage(image, out_id, TransferRole::Neighbour)))
         {
             out_ids.push_back(out_id);
         }
@@ -280,7 +815,7 @@ bool ApiConnection::uploadMultipleImages(const std::vector<ArkImagePtr> &images,
     return success;
 }
 
-std::string ApiConnection::getBackendConfigPath() const
+std::string ApiConnection::getBackendConfigPath()
 {
     std::string json_file_path;
 
@@ -340,15 +875,17 @@ bool ApiConnection::startupBackend(const BackendConfig &config) const
         arkSleepMS(std::chrono::seconds(4));
     #endif
 
-    // Do multiple checks for the backend to start and delay if necessary
-    int i = 0;
-    while (!isBackendRunning() && i < 300)
+    // Do multiple checks for the backend to start and delay if necessary, against a deadline
+    // since a backend that accepts but never answers makes every check take its full timeout
+    auto deadline = std::chrono::steady_clock::now() + kBackendStartupTimeout;
+    bool running = isBackendRunning();
+    while (!running && std::chrono::steady_clock::now() < deadline)
     {
         arkSleepMS(std::chrono::milliseconds(100));
-        i++;
+        running = isBackendRunning();
     }
 
-    if(isBackendRunning())
+    if(running)
     {
         LogInfo("[Backend Start] SUCCESS");
         return true;
@@ -417,7 +954,7 @@ bool ApiConnection::shutdownBackend() const
     setData("shutdown", "{\"shutdown\": \"true\"}");
     LogInfo("Backend shutdown status cached, graceful shutdown initiated");
     std::string url = m_base_url + "backend/shutdown";
-    cpr::Response response = cpr::Get(cpr::Url{url});
+    cpr::Response response = httpGet(m_transport, cpr::Url{url});
     if (response.status_code == 200)
     {
         LogInfo("Request was successful!\n");
@@ -439,7 +976,7 @@ bool ApiConnection::stopPlugin(const std::string &plugin_name) const
     bool success = false;
     std::string url = m_base_url + "plugins/stop_plugin/" + plugin_name;
 
-    cpr::Response response = cpr::Get(cpr::Url{url});
+    cpr::Response response = httpGet(m_transport, cpr::Url{url});
 
     if (response.status_code == 200)
     {
@@ -461,9 +998,9 @@ bool ApiConnection::getPluginConfig(const std::string &plugin_name, struct ArkPl
     bool success = false;
     std::string url = m_base_url + "plugins/get_config/" + plugin_name;
 
-    cpr::Response response = cpr::Get(cpr::Url{url});
+    cpr::Response response = httpGet(m_transport, cpr::Url{url});
     LogInfo("Get plugin config response: " + response.text);
-    if (response.status_code == 200 && validateConfigJson(response.text))
+    if (response.status_code == 200)
     {
         LogInfo("Request was successful!\n");
         LogInfo("Response body:" + response.text);
@@ -480,59 +1017,96 @@ bool ApiConnection::getPluginConfig(const std::string &plugin_name, struct ArkPl
 
 bool ApiConnection::getPluginInfo(const std::string &plugin_name, struct ArkPlugin &plugin) const
 {
-    bool success = false;
     std::string url = m_base_url + "plugins/get_info/" + plugin_name;
 
-    cpr::Response response = cpr::Get(cpr::Url{url});
-    LogInfo("Get plugin info response: " + response.text);
-    if (response.status_code == 200 && validateInfoResponse(response.text))
+    FetchedPluginInfo fetched = inFlightRequests().plugin_infos.run(url, [&]()
     {
-        LogInfo("Request was successful!\n");
-        LogInfo("Response body:" + response.text);
-        PluginJsonParser parser;
-        success = parser.parsePluginInfo(response.text, plugin);
-        plugin.setPluginName(plugin_name);
-    }
-    else
-    {
-        std::string error_string("Request failed with status code: " + std::to_string(response.status_code));
-        LogError(std::string(error_string));
-    }
-    return success;
+        FetchedPluginInfo result;
+        std::string response_text;
+        long status_code = cachedGet(url, kPluginInfoTTL, response_text);
+        LogInfo("Get plugin info response: " + response_text);
+        if (status_code == 200)
+        {
+            LogInfo("Request was successful!\n");
+            LogInfo("Response body:" + response_text);
+            PluginJsonParser parser;
+            result.success = parser.parsePluginInfo(response_text, result.plugin);
+            if (result.success)
+                result.plugin.setPluginName(plugin_name);
+            else
+                LogError("Invalid plugin info for " + plugin_name + ": " + parser.lastError().toString(), true);
+        }
+        else
+        {
+            std::string error_string("Request failed with status code: " + std::to_string(status_code));
+            LogError(std::string(error_string));
+        }
+        return result;
+    });
+
+    if (fetched.success)
+        plugin = std::move(fetched.plugin);
+    return fetched.success;
 }
 
-std::vector<std::string> ApiConnection::parsePluginList(const std::string &plugin_json_list) const
+size_t ApiConnection::coalescedRequestCount()
 {
-    std::vector<std::string> plugin_list;
+    InFlightRequests &requests = inFlightRequests();
+    return requests.gets.sharedCount() + requests.plugin_infos.sharedCount() +
+           requests.job_statuses.sharedCount() + requests.images.sharedCount();
+}
 
-    try
+void ApiConnection::invalidateLoginCache() const
+{
+    ResponseCache::instance().invalidatePrefix(m_base_url + "login/");
+}
+
+void ApiConnection::invalidatePluginCache() const
+{
+    ResponseCache::instance().invalidatePrefix(m_base_url + "plugins/");
+}
+
+long ApiConnection::cachedGet(const std::string &url, std::chrono::seconds ttl, std::string &out_text) const
+{
+    ResponseCache &cache = ResponseCache::instance();
+    CachedResponse cached;
+    ResponseCache::Lookup lookup = cache.lookup(url, cached);
+    if (lookup == ResponseCache::Lookup::Fresh)
     {
-        rapidjson::Document document;
-        document.Parse(plugin_json_list.c_str());
+        out_text = cached.body;
+        return 200;
+    }
 
-        if (!document.HasParseError() && document.IsObject())
+    CachedGetResult result = inFlightRequests().gets.run(url, [&]()
+    {
+        cpr::Header header;
+        if (lookup == ResponseCache::Lookup::Stale)
         {
-            if (document.HasMember("plugins") && document["plugins"].IsArray())
-            {
-                const rapidjson::Value& plugins = document["plugins"];
-
-                for (rapidjson::SizeType i = 0; i < plugins.Size(); i++)
-                {
-                    if (plugins[i].IsString())
-                    {
-                        const char* pluginName = plugins[i].GetString();
-                        plugin_list.push_back(pluginName);
-                    }
-                }
-            }
+            if (!cached.etag.empty())
+                header["If-None-Match"] = cached.etag;
+            if (!cached.last_modified.empty())
+                header["If-Modified-Since"] = cached.last_modified;
         }
-    }
-    catch (const std::exception& e)
-    {
-        LogError(std::string("parsePluginList error: " + std::string(e.what())));
-    }
 
-    return std::move(plugin_list);
+        CachedGetResult fetched;
+        cpr::Response response = httpGet(m_transport, cpr::Url{url}, header);
+        if (response.status_code == 304 && cache.markRevalidated(url, ttl, fetched.text))
+        {
+            fetched.status_code = 200;
+            return fetched;
+        }
+
+        if (response.status_code == 200)
+        {
+            cache.store(url, response.text, response.header["ETag"], response.header["Last-Modified"], ttl);
+        }
+        fetched.status_code = response.status_code;
+        fetched.text = std::move(response.text);
+        return fetched;
+    });
+
+    out_text = std::move(result.text);
+    return result.status_code;
 }
 
 std::map<std::string, std::string> ApiConnection::parsePluginInfo(const std::string &plugin_config_json) const
@@ -593,9 +1167,10 @@ std::map<std::string, std::string> ApiConnection::parsePluginInfo(const std::str
 std::string ApiConnection::executeEndpoint(const std::string &plugin_name, const std::string &args) const
 {
     std::string ret_job_id;
-    std::string url = m_base_url + "plugins/execute/" + plugin_name + "/\"" + args + "\"";
+    // the args travel in the path, quotes and spaces in a prompt would break the URL otherwise
+    std::string url = m_base_url + "plugins/execute/" + plugin_name + "/" + cpr::util::urlEncode("\"" + args + "\"");
 
-    cpr::Response response = cpr::Get(cpr::Url{url});
+    cpr::Response response = httpGet(m_transport, cpr::Url{url});
 
     if (response.status_code == 200)
     {
@@ -607,7 +1182,7 @@ std::string ApiConnection::executeEndpoint(const std::string &plugin_name, const
         }
         else
         {
-            LogError("Error parsing execute response");
+            LogError("Error parsing execute response: " + parser.lastError().toString());
         }
     }
     else
@@ -623,7 +1198,7 @@ std::string ApiConnection::callEndpoint(const std::string &plugin_name, const st
     std::string ret_job_id;
     std::string url = m_base_url + "plugins/call_endpoint/" + plugin_name + "/" + endpoint;
 
-    cpr::Response response = cpr::Put(cpr::Url{url},
+    cpr::Response response = httpPut(m_transport, cpr::Url{url},
                    cpr::Header{{"Content-Type", "application/json"}},
                    cpr::Header{{"accept", "application/json"}},
                    cpr::Header{{"Content-Length", std::to_string(body.size())}},
@@ -632,7 +1207,7 @@ std::string ApiConnection::callEndpoint(const std::string &plugin_name, const st
 
     LogInfo("Call endpoint response: " + response.text);
     
-    if (response.status_code == 200 && validateEndpointResponse(response.text))
+    if (response.status_code == 200)
     {
         PluginJsonParser parser;
         ExecuteResponse execute_response;
@@ -642,7 +1217,7 @@ std::string ApiConnection::callEndpoint(const std::string &plugin_name, const st
         }
         else
         {
-            LogError("Error parsing execute response");
+            LogError("Error parsing execute response: " + parser.lastError().toString());
         }
     }
     else
@@ -655,62 +1230,255 @@ std::string ApiConnection::callEndpoint(const std::string &plugin_name, const st
 
 JobStatusResponse ApiConnection::jobStatus(const std::string &job_id) const
 {
-    JobStatusResponse job_status;
     std::string url = m_base_url + "job/" + job_id;
 
-    cpr::Response response = cpr::Get(cpr::Url{url});
-    LogInfo("Job status response: " + response.text);
-    if (response.status_code == 200 && validateJobStatusResponse(response.text))
+    return inFlightRequests().job_statuses.run(url, [&]()
+    {
+        JobStatusResponse job_status;
+        cpr::Response response = httpGet(m_transport, cpr::Url{url});
+        LogInfo("Job status response: " + response.text);
+        if (response.status_code == 200)
+        {
+            // a tiny request each way, good enough as a round trip sample
+            m_transfer_policy->recordRoundTrip(response.elapsed);
+            PluginJsonParser parser;
+            if (!parser.parseJobResponse(response.text, job_status))
+            {
+                LogInfo("Error parsing jobStatus response: " + parser.lastError().toString());
+            }
+        }
+        else
+        {
+            std::string error_string("Job request failed with status code: " + std::to_string(response.status_code));
+            LogError(std::string(error_string));
+        }
+
+        LogInfo("Job status: " + stringFromJobStatus(job_status.status));
+        return job_status;
+    });
+}
+
+std::string ApiConnection::callEndpointBatch(const std::string &plugin_name, const std::string &endpoint, const std::vector<BatchFrame> &frames) const
+{
+    std::string ret_job_id;
+    if (frames.empty() || !batchJobsSupported())
+        return ret_job_id;
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    writer.StartObject();
+    writer.Key("frames");
+    writer.StartArray();
+    for (const auto &frame : frames)
+    {
+        writer.StartObject();
+        writer.Key("frame");
+        writer.Int(frame.frame);
+        writer.Key("params");
+        writer.RawValue(frame.params.c_str(), frame.params.size(), rapidjson::kObjectType);
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+    std::string body(buffer.GetString(), buffer.GetSize());
+
+    std::string url = m_base_url + "plugins/call_batch/" + plugin_name + "/" + endpoint;
+    cpr::Response response = httpPut(m_transport, cpr::Url{url},
+                   cpr::Header{{"Content-Type", "application/json"}},
+                   cpr::Header{{"accept", "application/json"}},
+                   cpr::Header{{"Content-Length", std::to_string(body.size())}},
+                   cpr::Header{{"Host", m_base_url}},
+                   cpr::Body{body});
+
+    LogInfo("Call batch response: " + response.text);
+
+    if (response.status_code == 200)
     {
         PluginJsonParser parser;
-        if (!parser.parseJobResponse(response.text, job_status))
+        ExecuteResponse execute_response;
+        if (parser.parseExecuteResponse(response.text, execute_response))
         {
-            LogInfo("Error parsing jobStatus response");
+            ret_job_id = execute_response.job_id;
         }
+        else
+        {
+            LogError("Error parsing batch response: " + parser.lastError().toString());
+        }
+    }
+    else if (response.status_code == 404)
+    {
+        LogWarning("Backend " + m_base_url + " doesn't take batch jobs");
+        BackendSupport &support = backendSupport();
+        std::lock_guard<std::mutex> lock(support.mutex);
+        support.no_batches.insert(m_base_url);
     }
     else
     {
-        std::string error_string("Job request failed with status code: " + std::to_string(response.status_code));
-        LogError(std::string(error_string));
+        LogError("Batch request failed with status code: " + std::to_string(response.status_code));
     }
+    return ret_job_id;
+}
+
+bool ApiConnection::streamBatchResults(const std::string &job_id, size_t frame_count, const BatchFrameCallback &on_frame) const
+{
+    std::string url = m_base_url + "job/batch/" + job_id;
+    std::string pending;
+    size_t reported = 0;
+    PluginJsonParser parser;
+
+    // the callback's signature changed between cpr releases, any string like data is taken
+    auto on_data = [&](const auto &data, auto &&...) -> bool
+    {
+        pending.append(data.data(), data.size());
+        size_t line_end;
+        while ((line_end = pending.find('\n')) != std::string::npos)
+        {
+            std::string line = pending.substr(0, line_end);
+            pending.erase(0, line_end + 1);
+            if (line.find_first_not_of(" \r\t") == std::string::npos)
+                continue;
+
+            BatchFrameResult result;
+            if (!parser.parseBatchFrameResponse(line, result))
+            {
+                LogError("Error parsing batch result: " + parser.lastError().toString());
+                continue;
+            }
+            reported++;
+            on_frame(result);
+        }
+        return true;
+    };
 
-    LogInfo("Job status: " + stringFromJobStatus(job_status.status));
-    return job_status;
+    cpr::Response response = httpGet(m_transport, cpr::Url{url}, cpr::Timeout{kBatchStreamTimeout}, cpr::WriteCallback{on_data});
+    if (response.status_code != 200)
+    {
+        LogError("Batch stream failed with status code: " + std::to_string(response.status_code));
+        return false;
+    }
+    if (reported < frame_count)
+    {
+        LogWarning("Batch " + job_id + " ended after " + std::to_string(reported) + " of " + std::to_string(frame_count) + " frames");
+        return false;
+    }
+    return true;
 }
 
-ArkImagePtr ApiConnection::getImage(const std::string &img_id) const
+bool ApiConnection::batchJobsSupported() const
 {
-    ArkImagePtr img;
-    std::string url = m_base_url + "image/get/" + img_id;
+    BackendSupport &support = backendSupport();
+    std::lock_guard<std::mutex> lock(support.mutex);
+    return support.no_batches.count(m_base_url) == 0;
+}
+
+bool ApiConnection::cancelJob(const std::string &job_id) const
+{
+    if (!jobCancelSupported())
+        return false;
+
+    std::string url = m_base_url + "job/" + job_id;
+    cpr::Response response = httpDelete(m_transport, cpr::Url{url}, cpr::Timeout{kStatusTimeout});
+    // not found means it already finished, either way it's no longer running
+    if (response.status_code == 200 || response.status_code == 404)
+        return true;
 
-    cpr::Response response = cpr::Get(cpr::Url{url});
-    LogInfo("Get image response: " + response.text);
-    if (response.status_code == 200 && validateImageResponse(response.text))
+    if (response.status_code == 405)
     {
-        LogInfo("SUCCESS getting image");
-        size_t textSize = response.text.size();
-        img = ::getImage(response.text);
+        LogWarning("Backend " + m_base_url + " can't cancel jobs, superseded ones are left to finish");
+        BackendSupport &support = backendSupport();
+        std::lock_guard<std::mutex> lock(support.mutex);
+        support.no_cancel.insert(m_base_url);
     }
     else
     {
-        std::string error_string("getImage failed with status code: " + std::to_string(response.status_code));
-        LogError(std::string(error_string));
+        LogError("Cancel request failed with status code: " + std::to_string(response.status_code));
     }
-    return img;
+    return false;
+}
+
+bool ApiConnection::jobCancelSupported() const
+{
+    BackendSupport &support = backendSupport();
+    std::lock_guard<std::mutex> lock(support.mutex);
+    return support.no_cancel.count(m_base_url) == 0;
+}
+
+ArkImagePtr ApiConnection::getImage(const std::string &img_id, std::string *out_encoded) const
+{
+    DecodedImageCache &cache = decodedImageCache();
+    std::string cache_key = m_base_url + img_id;
+    {
+        // a hit without the encoded bytes is fetched again for callers that want them
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        FetchedImage cached;
+        if (cache.images.get(cache_key, cached) && (!out_encoded || !cached.encoded.empty()))
+        {
+            if (out_encoded)
+                *out_encoded = cached.encoded;
+            return cached.img;
+        }
+    }
+
+    std::string url = m_base_url + "image/get/" + img_id;
+    // callers wanting the encoded bytes can't share a shared memory fetch, which only has the pixels
+    std::string flight_key = out_encoded ? url + "#encoded" : url;
+    FetchedImage fetched = inFlightRequests().images.run(flight_key, [&]()
+    {
+        FetchedImage result;
+        if (!out_encoded && useSharedMemory())
+        {
+            result.img = getImageShm(img_id);
+        }
+
+        if (!result.img)
+        {
+            cpr::Response response = httpGet(m_transport, cpr::Url{url}, cpr::Timeout{kTransferTimeout});
+            LogInfo("Get image response: " + response.text);
+            if (response.status_code == 200 && validateImageResponse(response.text))
+            {
+                m_transfer_policy->recordTransfer(response.text.size(), response.elapsed);
+                LogInfo("SUCCESS getting image");
+                result.img = ::getImage(response.text);
+                if (out_encoded)
+                    result.encoded = std::move(response.text);
+            }
+            else
+            {
+                std::string error_string("getImage failed with status code: " + std::to_string(response.status_code));
+                LogError(std::string(error_string));
+            }
+        }
+
+        if (result.img)
+        {
+            std::lock_guard<std::mutex> lock(cache.mutex);
+            cache.images.put(cache_key, result, static_cast<size_t>(result.img->strideBytes()) * result.img->height() + result.encoded.size());
+        }
+        return result;
+    });
+
+    if (out_encoded)
+        *out_encoded = std::move(fetched.encoded);
+    return fetched.img;
 }
 void ApiConnection::openConfigMenu(std::string pluginName)
 {
-    cpr::Response response = cpr::Get(cpr::Url{m_base_url += "ui/configure/" + pluginName});
+    cpr::Response response = httpGet(dialogTransport(m_transport), cpr::Url{m_base_url + "ui/configure/" + pluginName});
     LogInfo("openConfigMenu: " + pluginName + ": " + response.text);
+    // the config section of get_info changes behind our back once the user edits it, dropped
+    // only now the dialog is closed so renders that ran while it was open can't cache the old one
+    invalidatePluginCache();
 }
 void ApiConnection::openPluginManagerMenu()
 {
-cpr::Response response = cpr::Get(cpr::Url{m_base_url += "ui/plugin_manager"});
-LogInfo("openPluginManagerMenu: " + response.text);
+    cpr::Response response = httpGet(dialogTransport(m_transport), cpr::Url{m_base_url + "ui/plugin_manager"});
+    LogInfo("openPluginManagerMenu: " + response.text);
+    // installs and removals change the plugin list, same as editing a config
+    invalidatePluginCache();
 }
 void ApiConnection::openReportIssueMenu()
 {
-    cpr::Response response = cpr::Get(cpr::Url{m_base_url + "ui/report_issue"});
+    cpr::Response response = httpGet(dialogTransport(m_transport), cpr::Url{m_base_url + "ui/report_issue"});
     LogInfo("openReportIssueMenu: " + response.text);
 }
 void ApiConnection::openSupportURL(std::string pluginName)
@@ -727,7 +1495,7 @@ void ApiConnection::openDownloadURL()
 void ApiConnection::openLoginMenu()
 {
      std::string url = m_base_url + "ui/login";
-    cpr::Response response = cpr::Get(cpr::Url{url});
+    cpr::Response response = httpGet(dialogTransport(m_transport), cpr::Url{url});
 }
 // Validation functions
 #pragma region Validation functions
@@ -760,185 +1528,6 @@ bool ApiConnection::validateConfigJson(const std::string &json) const
     }
 }
 
-bool ApiConnection::validatePluginListResponse(const std::string &response) const
-{
-    rapidjson::Document document;
-    document.Parse(response.c_str());
-
-    if (!document.HasParseError() && document.IsObject()) 
-    {
-        if (document.HasMember("plugins") && document["plugins"].IsArray()) 
-        {
-            LogInfo("validatePluginListResponse: JSON is valid");
-            return true;
-        } 
-        else 
-        {
-            LogError("validatePluginListResponse: JSON is invalid");
-            return false;
-        }
-    } 
-    else 
-    {
-         LogError("Parsing of plugin list response Json failed", true);
-        return false;
-    }
-}
-
-bool ApiConnection::validateInfoResponse(const std::string &response) const
-{
-    try
-    {
-        rapidjson::Document document;
-        document.Parse(response.c_str());
-
-        LogInfo("InfoResponse: " + response);
-        if (!document.HasParseError() && document.IsObject()) 
-        {
-            if (document.HasMember("plugin") && document["plugin"].IsObject() &&
-                document["plugin"].HasMember("Name") && document["plugin"]["Name"].IsString() &&
-                document["plugin"].HasMember("Version") && document["plugin"]["Version"].IsString() &&
-                document["plugin"].HasMember("Author") && document["plugin"]["Author"].IsString() &&
-                document["plugin"].HasMember("Description") && document["plugin"]["Description"].IsString() &&
-                document["plugin"].HasMember("env") && document["plugin"]["env"].IsString() &&
-                document.HasMember("config") && document["config"].IsObject() &&
-                document.HasMember("endpoints") && document["endpoints"].IsObject()) 
-            {
-                const rapidjson::Value& endpoints = document["endpoints"];
-
-                for (rapidjson::Value::ConstMemberIterator it = endpoints.MemberBegin(); it != endpoints.MemberEnd(); ++it) 
-                {
-                    const std::string& endpoint_name = it->name.GetString();
-                    const rapidjson::Value& endpoint_value = it->value;
-
-                    if (!endpoint_value.IsObject() ||
-                        !endpoint_value.HasMember("call") || !endpoint_value["call"].IsString() ||
-                        !endpoint_value.HasMember("inputs") || !endpoint_value["inputs"].IsObject() ||
-                        !endpoint_value.HasMember("outputs") || !endpoint_value["outputs"].IsObject()) 
-                    {
-                        LogError("validateInfoResponse: Invalid endpoint object for endpoint: " + endpoint_name, true);
-                        return false;
-                    }
-
-                    const rapidjson::Value& inputs = endpoint_value["inputs"];
-                    for (rapidjson::Value::ConstMemberIterator input_it = inputs.MemberBegin(); input_it != inputs.MemberEnd(); ++input_it) 
-                    {
-                        if (!input_it->value.IsString()) 
-                        {
-                            LogError("validateInfoResponse: Invalid input type for endpoint: " + endpoint_name, true);
-                            return false;
-                        }
-                    }
-
-                    const rapidjson::Value& outputs = endpoint_value["outputs"];
-                    for (rapidjson::Value::ConstMemberIterator output_it = outputs.MemberBegin(); output_it != outputs.MemberEnd(); ++output_it) 
-                    {
-                        if (!output_it->value.IsString()) 
-                        {
-                            LogError("validateInfoResponse: Invalid output type for endpoint: " + endpoint_name, true);
-                            return false;
-                        }
-                    }
-                }
-
-                LogInfo("validateInfoResponse: JSON is valid");
-                return true;
-            } 
-            else 
-            {
-                LogError("validateInfoResponse: JSON is invalid, fields are missing or have incorrect types", true);
-                return false;
-            }
-        } 
-        else 
-        {
-             LogError("Parsing of info response JSON failed", true);
-            return false;
-        }
-    }
-    catch (const std::exception& e)
-    {
-        LogError("validateInfoResponse: Exception occurred while parsing response JSON: " + std::string(e.what()), true);
-        return false;
-    }
-}
-
-
-bool ApiConnection::validatePluginResponse(const std::string &response) const
-{
-    try
-    {
-
-        rapidjson::Document document;
-        document.Parse(response.c_str());
-        LogInfo("PluginResponse: " + response);
-        if (!document.HasParseError() && document.IsObject()) 
-        {
-            if (document.HasMember("plugin") && document["plugin"].IsObject() &&
-                document["plugin"].HasMember("Name") && document["plugin"]["Name"].IsString() &&
-                document["plugin"].HasMember("Version") && document["plugin"]["Version"].IsString() &&
-                document["plugin"].HasMember("Author") && document["plugin"]["Author"].IsString() &&
-                document["plugin"].HasMember("Description") && document["plugin"]["Description"].IsString() &&
-                document["plugin"].HasMember("env") && document["plugin"]["env"].IsString() &&
-                document.HasMember("config") && document["config"].IsObject() &&
-                document.HasMember("endpoints") && document["endpoints"].IsObject()) 
-            {
-                
-                LogInfo("validatePluginResponse: JSON is valid");
-                return true;
-            } 
-            else 
-            {
-                LogError("validatePluginResponse: JSON is invalid, fields are missing or have incorrect types: \n" + response, true);
-                return false;
-            }
-        } 
-        else 
-        {
-             LogError("Parsing of plugin response Json failed", true);
-            return false;
-        }
-    }
-    catch (const std::exception& e)
-    {
-        LogError(std::string("validateJobStatusResponse error: " + std::string(e.what())), true);
-        return false;
-    }
-}
-
-bool ApiConnection::validateJobStatusResponse(const std::string &response) const
-{
-    try
-    {
-        rapidjson::Document document;
-        document.Parse(response.c_str());
-        LogInfo("JobStatusResponse: " + response);
-        if (!document.HasParseError() && document.IsObject()) 
-        {
-            if (document.HasMember("status") && document["status"].IsString()) 
-            {
-                LogInfo("validateJobStatusResponse: JSON is valid");
-                return true;
-            } 
-            else 
-            {
-                LogError("validateJobStatusResponse: JSON is invalid",true);
-                return false;
-            }
-        } 
-        else
-        {
-            LogError("Parsing of job status response Json failed", true);
-            return false;
-        }
-    }
-    catch (const std::exception& e)
-    {
-        LogError(std::string("validateJobStatusResponse error: " + std::string(e.what())), true);
-        return false;
-    }
-}
-
 bool ApiConnection::validateImageResponse(const std::string &response) const
 {
    
@@ -954,132 +1543,6 @@ bool ApiConnection::validateImageResponse(const std::string &response) const
 
 }
 
-bool ApiConnection::validateEndpointResponse(const std::string &response) const
-{
-    try
-    {
-        rapidjson::Document document;
-        document.Parse(response.c_str());
-        LogInfo("EndpointResponse: " + response);
-        if (!document.HasParseError() && document.IsObject()) 
-        {
-            if (document.HasMember("job_id") && document["job_id"].IsString()) 
-            {
-                LogInfo("validateEndpointResponse: JSON is valid");
-                return true;
-            }
-            else 
-            {
-                LogError("validateEndpointResponse: JSON is invalid",true);
-                return false;
-            }
-        } 
-        else 
-        {
-            LogError("Parsing of endpoint response Json failed", true);
-            return false;
-        }
-    }
-    catch (const std::exception& e)
-    {
-        LogError(std::string("validateEndpointResponse error: " + std::string(e.what())), true);
-        return false;
-    }
-}
-
-bool ApiConnection::validateImgUploadResponse(const std::string &response) const
-{
-    try
-    {
-        rapidjson::Document document;
-        document.Parse(response.c_str());
-
-        LogInfo("ImgUploadResponse: " + response);
-
-        if (!document.HasParseError() && document.IsObject()) 
-        {
-            if (document.HasMember("status") && document["status"].IsString()) 
-            {
-                if (document.HasMember("image_id") && document["image_id"].IsString()) 
-                {
-                    LogInfo("validateImgUploadResponse: JSON is valid");
-                    return true;
-                } 
-                else 
-                {
-                    LogError("validateImgUploadResponse: 'image_id' field is missing or not a string", true);
-                    return false;
-                }
-            } 
-            else 
-            {
-                LogError("validateImgUploadResponse: 'status' field is missing or not a string", true);
-                return false;
-            }
-        } 
-        else 
-        {
-            LogError("validateImgUploadResponse: Parsing of response JSON failed", true);
-            return false;
-        }
-    }
-    catch (const std::exception& e)
-    {
-        LogError("validateImgUploadResponse: Exception occurred while parsing response JSON: " + std::string(e.what()), true);
-        return false;
-    }
-}
-
-bool ApiConnection::validateMultipleImgUploadResponse(const std::string &response) const
-{
-    try
-    {
-        rapidjson::Document document;
-        document.Parse(response.c_str());
-        LogInfo("MultipleImgUploadResponse: " + response);
-        if (!document.HasParseError() && document.IsObject()) 
-        {
-            if (document.HasMember("status") && document["status"].IsString()) 
-            {
-                if (document.HasMember("images") && document["images"].IsArray()) 
-                {
-                    const rapidjson::Value& images = document["images"];
-                    for (rapidjson::SizeType i = 0; i < images.Size(); i++) 
-                    {
-                        if (!images[i].IsString()) 
-                        {
-                            LogError("validateMultipleImgUploadResponse: Image ID in the 'images' array is not a string", true);
-                            return false;
-                        }
-                    }
-                    LogInfo("validateMultipleImgUploadResponse: JSON is valid");
-                    return true;
-                } 
-                else 
-                {
-                    LogError("validateMultipleImgUploadResponse: 'images' field is missing or not an array", true);
-                    return false;
-                }
-            } 
-            else 
-            {
-                LogError("validateMultipleImgUploadResponse: 'status' field is missing or not a string", true);
-                return false;
-            }
-        } 
-        else 
-        {
-            LogError("validateMultipleImgUploadResponse: Parsing of response JSON failed", true);
-            return false;
-        }
-    }
-    catch (const std::exception& e)
-    {
-        LogError("validateMultipleImgUploadResponse: Exception occurred while parsing response JSON: " + std::string(e.what()), true);
-        return false;
-    }
-}
-
 #pragma endregion
 
 
@@ -1091,7 +1554,7 @@ bool ApiConnection::setData(const std::string &id, const std::string &data) cons
         LogInfo("Setting Data in the backend: [" + id + "]" + ":" + data);
         std::string url = m_base_url + "data/store/" + id;
 
-        cpr::Response response = cpr::Put(
+        cpr::Response response = httpPut(m_transport, 
             cpr::Url{url},
             cpr::Body{data},
             cpr::Header{{"Content-Type", "application/json"}} // Set content type header
@@ -1121,7 +1584,7 @@ bool ApiConnection::deleteData(const std::string &id) const
     {
         std::string url = m_base_url + "data/delete/" + id;
 
-        cpr::Response response = cpr::Delete(
+        cpr::Response response = httpDelete(m_transport, 
             cpr::Url{url}
         );
 
@@ -1147,7 +1610,7 @@ std::string ApiConnection::getData(const std::string &id) const
     std::string retVal;
     std::string url = m_base_url + "data/retrieve/" + id;
 
-    cpr::Response response = cpr::Get(cpr::Url{url});
+    cpr::Response response = httpGet(m_transport, cpr::Url{url});
 
     if (response.status_code == 200)
     {
@@ -1,22 +1,85 @@
+#ifndef MAIN_API_CONNECTION_H
+#define MAIN_API_CONNECTION_H
+
 #include <vector>
 #include <string>
 #include <map>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include "plugin_json_parser.h"
 #include "image_buffer.h"
+#include "transfer_policy.h"
 #ifdef _WIN32
 #include <Windows.h>
 #endif
 
+static const char *const kDefaultBackendUrl = "http://localhost:8000/";
+
+class CircuitBreaker;
+
+// one backend work can be sent to
+struct BackendNode
+{
+    std::string base_url;
+    std::string unix_socket;
+};
+
+// how the requests of one ApiConnection reach the backend
+struct BackendTransport
+{
+    std::string unix_socket;
+    CircuitBreaker *breaker {nullptr};
+    bool probe {false}; // sent even while the breaker is open, to find out whether the backend is back
+    bool dialog {false}; // blocks until the user closes a backend dialog, no deadline and never counted by the breaker
+    std::chrono::milliseconds timeout {0}; // replaces the default request deadline when set
+};
+
+// one frame of a batch job, params is the endpoint's JSON body for that frame
+struct BatchFrame
+{
+    int frame {0};
+    std::string params;
+};
+
+using BatchFrameCallback = std::function<void(const BatchFrameResult &result)>;
+
 class ApiConnection
 {
 public:
+    // talks to the backend configured in Config.json, or the default localhost one
+    ApiConnection();
+    // unix_socket, when set, carries the HTTP requests instead of TCP, base_url still names the host
+    explicit ApiConnection(const std::string &base_url, const std::string &unix_socket = "");
+    explicit ApiConnection(const BackendNode &node);
+
+    static std::string getBackendConfigPath();
+    // every backend jobs can be spread over, the default one alone unless Backend_Pool is configured
+    static std::vector<BackendNode> configuredBackends();
+    // whether interactive renders should be queued rather than block the host (Async_Render)
+    static bool asyncRenderEnabled();
+    // whether an interactive render at full resolution can show a draft one upscaled (Proxy_Upscale)
+    static bool proxyUpscaleEnabled();
+    // whether queued interactive renders show a draft before the full render (Progressive_Render)
+    static bool progressiveRenderEnabled();
+    // requests answered by an identical one already in flight, since startup
+    static size_t coalescedRequestCount();
+
+    // for background work that has to give up quickly, calls that pass their own deadline keep it
+    void setRequestTimeout(std::chrono::milliseconds timeout) { m_transport.timeout = timeout; }
+
     bool isBackendRunning() const;
+    // false while recent calls failed to reach the backend, callers should skip it and degrade
+    bool isBackendAvailable() const;
 
     //license & subscription status
     bool getLoginStatus() const;
     std::string getUserInfo() const;
     int getUserSubscriptionLevel() const;
     int getPluginSubscriptionLevelRequirement(const std::string &plugin_name) const;
+    void invalidateLoginCache() const;
+    void invalidatePluginCache() const;
+    bool logout() const;
 
     std::vector<std::string>  getPluginList() const;
     bool getPluginConfig(const std::string &plugin_name, struct ArkPlugin &plugin) const;
@@ -30,8 +93,9 @@ public:
     bool deleteData(const std::string &id) const;
     std::string getData(const std::string &id) const;
     bool hasShutdownGracefully() const;
-    bool uploadImage(const ArkImagePtr &image, std::string &out_id) const;
+    bool uploadImage(const ArkImagePtr &image, std::string &out_id, TransferRole role = TransferRole::Frame) const;
     bool uploadMultipleImages(const std::vector<ArkImagePtr> &images, std::vector<std::string> &out_ids) const;
+    void invalidateUploadCache() const;
     
     bool startBackend() const;
     bool shutdownBackend() const;
@@ -41,7 +105,26 @@ public:
     std::string callEndpoint(const std::string &plugin_name, const std::string &endpoint, const std::string &body) const;
 
     JobStatusResponse jobStatus(const std::string &job_id) const;
-    ArkImagePtr getImage(const std::string &img_id) const;
+    // DELETE job/<job_id>, true once the job isn't running anymore. A backend answering 405
+    // can't cancel jobs, it's not asked again until restart
+    bool cancelJob(const std::string &job_id) const;
+    bool jobCancelSupported() const;
+
+    // Runs an endpoint over several frames as a single job, empty if the backend couldn't take it.
+    // The batch contract:
+    //   PUT plugins/call_batch/<plugin>/<endpoint>  {"frames": [{"frame": 12, "params": {...}}, ...]}
+    //     -> {"job_id": "..."}
+    //   GET job/batch/<job_id>  -> NDJSON, one {"frame": 12, "status": "Success", "output_img": "..."}
+    //     line per frame as it finishes, the stream ends once every frame has been reported
+    std::string callEndpointBatch(const std::string &plugin_name, const std::string &endpoint, const std::vector<BatchFrame> &frames) const;
+    // follows the job's result stream, on_frame is called on this thread as each line arrives.
+    // true once frame_count frames were reported
+    bool streamBatchResults(const std::string &job_id, size_t frame_count, const BatchFrameCallback &on_frame) const;
+    // false once this backend turned a batch down as unknown, it's not asked again until restart
+    bool batchJobsSupported() const;
+    // the returned image may be shared with the decoded image cache, treat it as read only.
+    // out_encoded gets the bytes as sent by the backend when they had to be downloaded
+    ArkImagePtr getImage(const std::string &img_id, std::string *out_encoded = nullptr) const;
     
 
     void openConfigMenu(std::string pluginName);
@@ -51,24 +134,25 @@ public:
     void openDownloadURL();
     void openLoginMenu();
 protected:
-    std::string getBackendConfigPath() const;
     bool startupBackend(const BackendConfig &config) const;
+    long cachedGet(const std::string &url, std::chrono::seconds ttl, std::string &out_text) const;
+    bool findUploadedImage(uint64_t content_hash, std::string &out_id) const;
+    bool uploadImageEncoded(const ArkImagePtr &image, const TransferPlan &plan, std::string &out_id) const;
+    bool useSharedMemory() const;
+    bool uploadImageShm(const ArkImagePtr &image, std::string &out_id) const;
+    ArkImagePtr getImageShm(const std::string &img_id) const;
+    bool imageExists(const std::string &img_id) const;
 
-    std::vector<std::string> parsePluginList(const std::string &plugin_json_list) const;
     std::map<std::string, std::string> parsePluginInfo(const std::string &plugin_config_json) const;
     std::map<std::string, std::string> parsePluginConfig(const std::string &plugin_config_json) const;
-    // should this be in the config file so users can set the server IP and port if different from the default?
-    std::string m_base_url = "http://localhost:8000/";
+    std::string m_base_url;
+    BackendTransport m_transport;
+    TransferPolicy *m_transfer_policy {nullptr};
 
 private:
 
     bool validateConfigJson(const std::string& json) const;// failing in the backend 
-    bool validatePluginListResponse(const std::string& response) const;
-    bool validateInfoResponse(const std::string& response) const;
-    bool validateJobStatusResponse(const std::string& response) const;
     bool validateImageResponse(const std::string& response) const;
-    bool validateEndpointResponse(const std::string& response) const;
-    bool validatePluginResponse(const std::string& response) const;
-    bool validateImgUploadResponse(const std::string& response) const;
-    bool validateMultipleImgUploadResponse(const std::string& response) const;
 };
+
+#endif // MAIN_API_CONNECTION_H
@@ -0,0 +1,409 @@
+#include "plugin_catalogue.h"
+#include "utils.h"
+#include "logger.h"
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char kCatalogueMagic[4] = {'A', 'R', 'K', 'C'};
+// bump whenever the layout written by serialize() changes
+static const uint32_t kCatalogueVersion = 2;
+
+namespace
+{
+
+class CatalogueWriter
+{
+public:
+    explicit CatalogueWriter(std::string &out_data)
+    : m_data(out_data)
+    { }
+
+    void writeU32(uint32_t value)
+    {
+        m_data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    void writeI32(int32_t value)
+    {
+        m_data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    void writeU64(uint64_t value)
+    {
+        m_data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    void writeBool(bool value)
+    {
+        m_data.push_back(value ? 1 : 0);
+    }
+
+    void writeString(const std::string &value)
+    {
+        writeU32(static_cast<uint32_t>(value.size()));
+        m_data.append(value);
+    }
+
+protected:
+    std::string &m_data;
+};
+
+class CatalogueReader
+{
+public:
+    CatalogueReader(const char *data, size_t size)
+    : m_data(data), m_size(size)
+    { }
+
+    bool readU32(uint32_t &out_value)
+    {
+        return readRaw(&out_value, sizeof(out_value));
+    }
+
+    bool readI32(int32_t &out_value)
+    {
+        return readRaw(&out_value, sizeof(out_value));
+    }
+
+    bool readU64(uint64_t &out_value)
+    {
+        return readRaw(&out_value, sizeof(out_value));
+    }
+
+    bool readBool(bool &out_value)
+    {
+        char value = 0;
+        if (!readRaw(&value, 1))
+            return false;
+        out_value = value != 0;
+        return true;
+    }
+
+    bool readString(std::string &out_value)
+    {
+        uint32_t size = 0;
+        if (!readU32(size) || size > m_size - m_pos)
+            return false;
+        out_value.assign(m_data + m_pos, size);
+        m_pos += size;
+        return true;
+    }
+
+    bool readRaw(void *out_value, size_t size)
+    {
+        if (size > m_size - m_pos)
+            return false;
+        std::memcpy(out_value, m_data + m_pos, size);
+        m_pos += size;
+        return true;
+    }
+
+    bool atEnd() const { return m_pos == m_size; }
+
+protected:
+    const char *m_data;
+    size_t m_size;
+    size_t m_pos {0};
+};
+
+// read only mapping of a whole file, unmapped when it goes out of scope
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string &path)
+    {
+#ifdef _WIN32
+        m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (m_file == INVALID_HANDLE_VALUE)
+            return;
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(m_file, &file_size) || file_size.QuadPart == 0)
+            return;
+        m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (m_mapping == NULL)
+            return;
+        m_data = static_cast<const char *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (m_data)
+            m_size = static_cast<size_t>(file_size.QuadPart);
+#else
+        m_fd = open(path.c_str(), O_RDONLY);
+        if (m_fd < 0)
+            return;
+        struct stat file_stat;
+        if (fstat(m_fd, &file_stat) != 0 || file_stat.st_size == 0)
+            return;
+        void *data = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, m_fd, 0);
+        if (data == MAP_FAILED)
+            return;
+        m_data = static_cast<const char *>(data);
+        m_size = static_cast<size_t>(file_stat.st_size);
+#endif
+    }
+
+    ~MappedFile()
+    {
+#ifdef _WIN32
+        if (m_data)
+            UnmapViewOfFile(m_data);
+        if (m_mapping != NULL)
+            CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE)
+            CloseHandle(m_file);
+#else
+        if (m_data)
+            munmap(const_cast<char *>(m_data), m_size);
+        if (m_fd >= 0)
+            close(m_fd);
+#endif
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+protected:
+    const char *m_data {nullptr};
+    size_t m_size {0};
+#ifdef _WIN32
+    HANDLE m_file {INVALID_HANDLE_VALUE};
+    HANDLE m_mapping {NULL};
+#else
+    int m_fd {-1};
+#endif
+};
+
+void writeDataList(CatalogueWriter &writer, const std::vector<Data> &data_list)
+{
+    writer.writeU32(static_cast<uint32_t>(data_list.size()));
+    for (const auto &data : data_list)
+    {
+        writer.writeString(data.name);
+        writer.writeString(data.parameter_data);
+    }
+}
+
+bool readDataList(CatalogueReader &reader, std::vector<Data> &out_data_list)
+{
+    uint32_t count = 0;
+    if (!reader.readU32(count))
+        return false;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        Data data;
+        if (!reader.readString(data.name) || !reader.readString(data.parameter_data))
+            return false;
+        out_data_list.push_back(data);
+    }
+    return true;
+}
+
+} // namespace
+
+const std::string &PluginCatalogue::snapshotPath()
+{
+    static std::string snapshot_path;
+    if (snapshot_path.empty())
+    {
+        snapshot_path = (std::filesystem::path(tmpDirectory()) / "deepmake_plugin_catalogue.bin").string();
+    }
+    return snapshot_path;
+}
+
+void PluginCatalogue::serialize(const std::vector<ArkPlugin> &plugins, std::string &out_data)
+{
+    out_data.clear();
+    CatalogueWriter writer(out_data);
+
+    out_data.append(kCatalogueMagic, sizeof(kCatalogueMagic));
+    writer.writeU32(kCatalogueVersion);
+    writer.writeU32(static_cast<uint32_t>(plugins.size()));
+    for (const auto &plugin : plugins)
+    {
+        writer.writeString(plugin.name);
+        writer.writeString(plugin.plugin_name);
+        writer.writeString(plugin.version);
+        writer.writeString(plugin.author);
+        writer.writeString(plugin.description);
+        writer.writeString(plugin.env);
+        writer.writeI32(plugin.license_level);
+        writer.writeString(plugin.config.model_name);
+        writer.writeString(plugin.config.model_dtype);
+        writer.writeBool(plugin.config.save_output);
+        writer.writeU64(plugin.config.hash);
+
+        writer.writeU32(static_cast<uint32_t>(plugin.endpoints.size()));
+        for (const auto &endpoint : plugin.endpoints)
+        {
+            writer.writeString(endpoint.name);
+            writer.writeString(endpoint.call);
+            writer.writeString(endpoint.tag);
+            writer.writeBool(endpoint.has_prompt);
+            writeDataList(writer, endpoint.inputs);
+            writeDataList(writer, endpoint.outputs);
+        }
+    }
+}
+
+bool PluginCatalogue::deserialize(const char *data, size_t size, std::vector<ArkPlugin> &out_plugins)
+{
+    if (size < sizeof(kCatalogueMagic) || std::memcmp(data, kCatalogueMagic, sizeof(kCatalogueMagic)) != 0)
+    {
+        return false;
+    }
+
+    CatalogueReader reader(data + sizeof(kCatalogueMagic), size - sizeof(kCatalogueMagic));
+    uint32_t version = 0;
+    uint32_t plugin_count = 0;
+    if (!reader.readU32(version) || version != kCatalogueVersion || !reader.readU32(plugin_count))
+    {
+        return false;
+    }
+
+    std::vector<ArkPlugin> plugins;
+    for (uint32_t i = 0; i < plugin_count; i++)
+    {
+        ArkPlugin plugin;
+        int32_t license_level = 0;
+        uint32_t endpoint_count = 0;
+        if (!reader.readString(plugin.name) ||
+            !reader.readString(plugin.plugin_name) ||
+            !reader.readString(plugin.version) ||
+            !reader.readString(plugin.author) ||
+            !reader.readString(plugin.description) ||
+            !reader.readString(plugin.env) ||
+            !reader.readI32(license_level) ||
+            !reader.readString(plugin.config.model_name) ||
+            !reader.readString(plugin.config.model_dtype) ||
+            !reader.readBool(plugin.config.save_output) ||
+            !reader.readU64(plugin.config.hash) ||
+            !reader.readU32(endpoint_count))
+        {
+            return false;
+        }
+        plugin.license_level = license_level;
+
+        for (uint32_t j = 0; j < endpoint_count; j++)
+        {
+            Endpoint endpoint;
+            if (!reader.readString(endpoint.name) ||
+                !reader.readString(endpoint.call) ||
+                !reader.readString(endpoint.tag) ||
+                !reader.readBool(endpoint.has_prompt) ||
+                !readDataList(reader, endpoint.inputs) ||
+                !readDataList(reader, endpoint.outputs))
+            {
+                return false;
+            }
+            plugin.endpoints.push_back(endpoint);
+        }
+        plugin.setPluginName(plugin.plugin_name);
+        plugins.push_back(plugin);
+    }
+
+    if (!reader.atEnd())
+    {
+        return false;
+    }
+    out_plugins = std::move(plugins);
+    return true;
+}
+
+bool PluginCatalogue::load(const std::string &path, std::vector<ArkPlugin> &out_plugins)
+{
+    bool success = false;
+    try
+    {
+        MappedFile file(path);
+        if (file.data())
+        {
+            success = deserialize(file.data(), file.size(), out_plugins);
+            if (!success)
+                LogWarning("Ignoring invalid plugin catalogue snapshot: " + path);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LogError(std::string("Exception loading plugin catalogue: ") + e.what());
+    }
+    return success;
+}
+
+bool PluginCatalogue::save(const std::string &path, const std::vector<ArkPlugin> &plugins)
+{
+    bool success = false;
+    try
+    {
+        std::string data;
+        serialize(plugins, data);
+
+        // write next to the snapshot and swap it in so a reader never sees half a file
+        std::string tmp_path = path + ".tmp";
+        {
+            std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (!file)
+            {
+                LogError("Failed writing plugin catalogue snapshot: " + tmp_path);
+                return false;
+            }
+        }
+        std::filesystem::rename(tmp_path, path);
+        success = true;
+    }
+    catch (const std::exception &e)
+    {
+        LogError(std::string("Exception saving plugin catalogue: ") + e.what());
+    }
+    return success;
+}
+
+int PluginCatalogue::merge(const std::vector<ArkPlugin> &snapshot_plugins,
+                           const std::vector<ArkPlugin> &fetched_plugins,
+                           std::vector<ArkPlugin> &out_plugins)
+{
+    int changed = 0;
+    int matched = 0;
+    out_plugins.clear();
+    for (const auto &fetched : fetched_plugins)
+    {
+        const ArkPlugin *cached = nullptr;
+        for (const auto &snapshot_plugin : snapshot_plugins)
+        {
+            if (snapshot_plugin.plugin_name == fetched.plugin_name)
+            {
+                cached = &snapshot_plugin;
+                break;
+            }
+        }
+
+        if (cached)
+            matched++;
+
+        // an edited config keeps the version, the output changes all the same
+        if (cached && cached->version == fetched.version && cached->config.hash == fetched.config.hash)
+        {
+            out_plugins.push_back(*cached);
+        }
+        else
+        {
+            out_plugins.push_back(fetched);
+            changed++;
+        }
+    }
+
+    // whatever is left in the snapshot was uninstalled from the backend
+    changed += static_cast<int>(snapshot_plugins.size()) - matched;
+    return changed;
+}
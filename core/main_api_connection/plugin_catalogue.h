@@ -0,0 +1,31 @@
+#ifndef PLUGIN_CATALOGUE_H
+#define PLUGIN_CATALOGUE_H
+
+#include <string>
+#include <vector>
+#include "ark_plugin.h"
+
+// Binary snapshot of the plugin catalogue (the parsed get_info of every backend plugin)
+// so the next launch can register its parameters without waiting on the network.
+// Only what comes from the backend is stored, ids and endpoint params are rebuilt at runtime.
+// The snapshot is a cache: anything unexpected in it makes the load fail and we fall
+// back to asking the backend.
+class PluginCatalogue
+{
+public:
+    static const std::string &snapshotPath();
+
+    static bool load(const std::string &path, std::vector<ArkPlugin> &out_plugins);
+    static bool save(const std::string &path, const std::vector<ArkPlugin> &plugins);
+
+    static void serialize(const std::vector<ArkPlugin> &plugins, std::string &out_data);
+    static bool deserialize(const char *data, size_t size, std::vector<ArkPlugin> &out_plugins);
+
+    // takes the snapshot entry for plugins whose version and config didn't change and the fetched one otherwise,
+    // returns the number of plugins that were added, removed or updated
+    static int merge(const std::vector<ArkPlugin> &snapshot_plugins,
+                     const std::vector<ArkPlugin> &fetched_plugins,
+                     std::vector<ArkPlugin> &out_plugins);
+};
+
+#endif // PLUGIN_CATALOGUE_H
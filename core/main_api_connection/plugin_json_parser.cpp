@@ -1,9 +1,12 @@
 
 #include "plugin_json_parser.h"
 #include "rapidjson/filereadstream.h"
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
 #include <iostream>
 #include <fstream>
 #include "logger.h"
+#include "hash_utils.h"
 
 std::string PluginJsonParser::getTextFromFile(const std::string &file_path) const
 {
@@ -43,6 +46,49 @@ bool PluginJsonParser::parseBackendConfigFile(const std::string &file_path, stru
             return false;
         }
 
+        // optional, where an already running backend listens
+        if (doc.HasMember("Backend_URL") && doc["Backend_URL"].IsString())
+            config.backend_url = doc["Backend_URL"].GetString();
+        if (doc.HasMember("Backend_Socket") && doc["Backend_Socket"].IsString())
+            config.backend_socket = doc["Backend_Socket"].GetString();
+        if (doc.HasMember("Backend_Pool") && doc["Backend_Pool"].IsArray())
+        {
+            for (const auto &url : doc["Backend_Pool"].GetArray())
+            {
+                if (url.IsString())
+                    config.backend_pool.push_back(url.GetString());
+            }
+        }
+
+        // optional, interactive renders return straight away and the host is asked to redraw once the result is in
+        if (doc.HasMember("Async_Render") && doc["Async_Render"].IsBool())
+            config.async_render = doc["Async_Render"].GetBool();
+
+        // optional, full resolution interactive renders make do with an upscaled draft render of the frame
+        if (doc.HasMember("Proxy_Upscale") && doc["Proxy_Upscale"].IsBool())
+            config.proxy_upscale = doc["Proxy_Upscale"].GetBool();
+
+        // optional, queued interactive renders show a quarter resolution draft before the full render
+        if (doc.HasMember("Progressive_Render") && doc["Progressive_Render"].IsBool())
+            config.progressive_render = doc["Progressive_Render"].GetBool();
+
+        if (doc.HasMember("Transfer_Policy") && doc["Transfer_Policy"].IsObject())
+        {
+            const rapidjson::Value &policy = doc["Transfer_Policy"];
+            if (policy.HasMember("Adaptive") && policy["Adaptive"].IsBool())
+                config.transfer.adaptive = policy["Adaptive"].GetBool();
+            if (policy.HasMember("Allow_Lossy") && policy["Allow_Lossy"].IsBool())
+                config.transfer.allow_lossy = policy["Allow_Lossy"].GetBool();
+            if (policy.HasMember("Jpeg_Quality") && policy["Jpeg_Quality"].IsInt())
+                config.transfer.jpeg_quality = policy["Jpeg_Quality"].GetInt();
+            if (policy.HasMember("Allow_Downscale") && policy["Allow_Downscale"].IsBool())
+                config.transfer.allow_downscale = policy["Allow_Downscale"].GetBool();
+            if (policy.HasMember("Max_Downscale") && policy["Max_Downscale"].IsInt())
+                config.transfer.max_downscale = policy["Max_Downscale"].GetInt();
+            if (policy.HasMember("Max_Transfer_Seconds") && policy["Max_Transfer_Seconds"].IsNumber())
+                config.transfer.max_transfer_seconds = policy["Max_Transfer_Seconds"].GetDouble();
+        }
+
         if (doc.HasMember("Py_Environment") && doc["Py_Environment"].IsString())
             config.py_dir = doc["Py_Environment"].GetString();
         else
@@ -70,23 +116,89 @@ bool PluginJsonParser::parseBackendConfigFile(const std::string &file_path, stru
     return success;
 }
 
+std::string JsonParseError::toString() const
+{
+    switch (code)
+    {
+        case JsonError::None:
+            return "no error";
+        case JsonError::Syntax:
+            return "malformed JSON at offset " + std::to_string(offset);
+        case JsonError::NotObject:
+            return "JSON is not an object";
+        case JsonError::MissingField:
+            return "missing field '" + field + "'";
+        case JsonError::WrongType:
+            return "field '" + field + "' has the wrong type";
+        case JsonError::Rejected:
+            return "backend rejected the request ('" + field + "')";
+    }
+    return "unknown error";
+}
+
+bool PluginJsonParser::fail(JsonError code, const std::string &field) const
+{
+    m_error.code = code;
+    m_error.field = field;
+    return false;
+}
+
+// Responses are parsed in place from a private copy, rapidjson then points into the
+// buffer instead of allocating every string. The buffer has to outlive the document.
+bool PluginJsonParser::parseDocument(const std::string &json, std::string &buffer, rapidjson::Document &doc) const
+{
+    m_error = JsonParseError();
+    buffer = json;
+    doc.ParseInsitu(buffer.data());
+
+    if (doc.HasParseError())
+    {
+        m_error.code = JsonError::Syntax;
+        m_error.offset = doc.GetErrorOffset();
+        return false;
+    }
+    if (!doc.IsObject())
+        return fail(JsonError::NotObject, "");
+    return true;
+}
+
+bool PluginJsonParser::readString(const rapidjson::Value &obj, const char *name, const std::string &path, std::string &out, bool required) const
+{
+    auto it = obj.FindMember(name);
+    if (it == obj.MemberEnd())
+        return required ? fail(JsonError::MissingField, path + name) : true;
+    if (!it->value.IsString())
+        return fail(JsonError::WrongType, path + name);
+    out.assign(it->value.GetString(), it->value.GetStringLength());
+    return true;
+}
+
+bool PluginJsonParser::readObject(const rapidjson::Value &obj, const char *name, const std::string &path, const rapidjson::Value *&out) const
+{
+    auto it = obj.FindMember(name);
+    if (it == obj.MemberEnd())
+        return fail(JsonError::MissingField, path + name);
+    if (!it->value.IsObject())
+        return fail(JsonError::WrongType, path + name);
+    out = &it->value;
+    return true;
+}
+
 bool PluginJsonParser::parseConfigJson(const std::string &plugin_config_json, struct ArkPlugin &plugin) const
 {
     bool success = false;
 
     try 
     {
+        std::string buffer;
         rapidjson::Document doc;
-        doc.Parse(plugin_config_json.c_str());
-
-        if (doc.HasParseError() || !doc.IsObject()) 
+        if (!parseDocument(plugin_config_json, buffer, doc))
         {
-            LogError("ConfigParser::parsePluginConfig Error parsing JSON or JSON is not an object.");
+            LogError("ConfigParser::parsePluginConfig " + m_error.toString());
             return false;
         }
 
-        const rapidjson::Value& plugin_config = *dynamic_cast<const rapidjson::Value*>(&doc);
-        success = parseConfigValue(plugin_config, plugin);
+        success = parseConfigValue(doc, plugin);
     }
     catch (const std::exception &e)
     {
@@ -102,16 +214,17 @@ bool PluginJsonParser::parseLoginStatus(const std::string &response_json) const
     bool success = false;
     try
     {
+        std::string buffer;
         rapidjson::Document doc;
-        doc.Parse(response_json.c_str());
-        if(doc.HasParseError() || !doc.IsObject())
+        if (!parseDocument(response_json, buffer, doc))
         {
-            LogError("ConfigParser::parseLoginStatus Error parsing JSON or JSON is not an object.");
+            LogError("ConfigParser::parseLoginStatus " + m_error.toString());
             return success;
         }
-        if(doc.HasMember("logged_in") && doc["logged_in"].IsBool())
+        auto it = doc.FindMember("logged_in");
+        if (it != doc.MemberEnd() && it->value.IsBool())
         {
-             success = doc["logged_in"].GetBool();
+             success = it->value.GetBool();
         }
     }
     catch(const std::exception& e)
@@ -127,17 +240,16 @@ bool PluginJsonParser::parseUserInfo(const std::string &response_json, std::stri
     bool success = false;
     try
     {
+        std::string buffer;
         rapidjson::Document doc;
-        doc.Parse(response_json.c_str());
-        if(doc.HasParseError() || !doc.IsObject())
+        if (!parseDocument(response_json, buffer, doc))
         {
-            LogError("ConfigParser::parseUserInfo Error parsing JSON or JSON is not an object.");
+            LogError("ConfigParser::parseUserInfo " + m_error.toString());
             success = false;
         }
-        else if(doc.HasMember("username") && doc["username"].IsString())
+        else
         {
-            user_info = doc["username"].GetString();
-            success = true;
+            success = readString(doc, "username", "", user_info);
         }
     }
     catch(const std::exception& e)
@@ -153,8 +265,9 @@ bool PluginJsonParser::parseConfigDoc(const rapidjson::Document &doc, struct Ark
 
     try
     {
-        const rapidjson::Value& configInfo = doc["config"];
-        success = parseConfigValue(configInfo, plugin);
+        const rapidjson::Value *config_info = nullptr;
+        if (readObject(doc, "config", "", config_info))
+            success = parseConfigValue(*config_info, plugin);
     }
     catch (const std::exception &e)
     {
@@ -165,18 +278,29 @@ bool PluginJsonParser::parseConfigDoc(const rapidjson::Document &doc, struct Ark
     return success;
 }
 
+// every config field is optional, but the ones we know about must have the right type
 bool PluginJsonParser::parseConfigValue(const rapidjson::Value& plugin_config, struct ArkPlugin &plugin) const
 {
     bool success = false;
 
     try
     {
-        if (plugin_config.HasMember("model_name"))
-            plugin.config.model_name = plugin_config["model_name"].GetString();
-        if (plugin_config.HasMember("model_dtype"))
-            plugin.config.model_dtype = plugin_config["model_dtype"].GetString();
-        if (plugin_config.HasMember("save_output"))
-            plugin.config.save_output = plugin_config["save_output"].GetBool();
+        if (!readString(plugin_config, "model_name", "config.", plugin.config.model_name, false) ||
+            !readString(plugin_config, "model_dtype", "config.", plugin.config.model_dtype, false))
+            return false;
+
+        auto save_output = plugin_config.FindMember("save_output");
+        if (save_output != plugin_config.MemberEnd())
+        {
+            if (!save_output->value.IsBool())
+                return fail(JsonError::WrongType, "config.save_output");
+            plugin.config.save_output = save_output->value.GetBool();
+        }
+
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        plugin_config.Accept(writer);
+        plugin.config.hash = hash64(buffer.GetString(), buffer.GetSize());
         success = true;
     }
     catch (const std::exception &e)
@@ -195,30 +319,29 @@ bool PluginJsonParser::parsePluginInfo(const std::string &plugin_config_json, st
 
     try
     {
+        std::string buffer;
         rapidjson::Document doc;
-        doc.Parse(plugin_config_json.c_str());
-
-        if (doc.HasParseError() || !doc.IsObject())
+        if (!parseDocument(plugin_config_json, buffer, doc))
         {
-            LogError("ConfigParser::parsePluginInfo Error parsing JSON or JSON is not an object.");
+            LogError("ConfigParser::parsePluginInfo " + m_error.toString());
             return false;
         }
 
         if (!parsePlugin(doc, plugin))
         {
-            LogError("ConfigParser::parsePluginInfo Error parsing plugin.");
+            LogError("ConfigParser::parsePluginInfo Error parsing plugin: " + m_error.toString());
             return false;
         }
 
         if (!parseConfigDoc(doc, plugin))
         {
-            LogError("ConfigParser::parsePluginInfo Error parsing config.");
+            LogError("ConfigParser::parsePluginInfo Error parsing config: " + m_error.toString());
             return false;
         }
 
         if (!parseEndpoints(doc, plugin))
         {
-            LogError("ConfigParser::parsePluginInfo Error parsing endpoints.");
+            LogError("ConfigParser::parsePluginInfo Error parsing endpoints: " + m_error.toString());
             return false;
         }
         success = true;
@@ -232,6 +355,22 @@ bool PluginJsonParser::parsePluginInfo(const std::string &plugin_config_json, st
     return success;
 }
 
+bool PluginJsonParser::parseDataList(const rapidjson::Value &obj, const std::string &path, std::vector<Data> &out) const
+{
+    out.reserve(obj.MemberCount());
+    for (rapidjson::Value::ConstMemberIterator it = obj.MemberBegin(); it != obj.MemberEnd(); ++it)
+    {
+        if (!it->value.IsString())
+            return fail(JsonError::WrongType, path + it->name.GetString());
+
+        Data param_data;
+        param_data.name.assign(it->name.GetString(), it->name.GetStringLength());
+        param_data.parameter_data.assign(it->value.GetString(), it->value.GetStringLength());
+        out.push_back(std::move(param_data));
+    }
+    return true;
+}
+
 bool PluginJsonParser::parseEndpoints(const rapidjson::Document &doc, struct ArkPlugin &plugin) const
 {
     bool success = false;
@@ -240,33 +379,36 @@ bool PluginJsonParser::parseEndpoints(const rapidjson::Document &doc, struct Ark
     {
         plugin.endpoints.clear();
 
-        const rapidjson::Value& endpoints = doc["endpoints"];
-        for (rapidjson::Value::ConstMemberIterator it = endpoints.MemberBegin(); it != endpoints.MemberEnd(); ++it) {
+        const rapidjson::Value *endpoints = nullptr;
+        if (!readObject(doc, "endpoints", "", endpoints))
+            return false;
+
+        plugin.endpoints.reserve(endpoints->MemberCount());
+        for (rapidjson::Value::ConstMemberIterator it = endpoints->MemberBegin(); it != endpoints->MemberEnd(); ++it) {
             Endpoint endpoint;
-            endpoint.name = it->name.GetString();
+            endpoint.name.assign(it->name.GetString(), it->name.GetStringLength());
+            std::string path = "endpoints." + endpoint.name;
             const rapidjson::Value& endpointInfo = it->value;
-            endpoint.call = endpointInfo["call"].GetString();
-            if (endpointInfo.HasMember("tag"))
-                endpoint.tag = endpointInfo["tag"].GetString();
-            const rapidjson::Value& inputs = endpointInfo["inputs"];
-            for (rapidjson::Value::ConstMemberIterator inputIt = inputs.MemberBegin(); inputIt != inputs.MemberEnd(); ++inputIt) {
-                Data param_data;
-                param_data.name = inputIt->name.GetString();
-                param_data.parameter_data = inputIt->value.GetString();
-                endpoint.inputs.push_back(param_data);
-            }
-
-            const rapidjson::Value& outputs = endpointInfo["outputs"];
-            for (rapidjson::Value::ConstMemberIterator outputIt = outputs.MemberBegin(); outputIt != outputs.MemberEnd(); ++outputIt) {
-                Data param_data;
-                param_data.name = outputIt->name.GetString();
-                param_data.parameter_data = outputIt->value.GetString();
-                endpoint.outputs.push_back(param_data);
-            }
+            if (!endpointInfo.IsObject())
+                return fail(JsonError::WrongType, path);
+            path += ".";
+
+            const rapidjson::Value *inputs = nullptr;
+            const rapidjson::Value *outputs = nullptr;
+            if (!readString(endpointInfo, "call", path, endpoint.call) ||
+                !readString(endpointInfo, "tag", path, endpoint.tag, false) ||
+                !readObject(endpointInfo, "inputs", path, inputs) ||
+                !readObject(endpointInfo, "outputs", path, outputs) ||
+                !parseDataList(*inputs, path + "inputs.", endpoint.inputs) ||
+                !parseDataList(*outputs, path + "outputs.", endpoint.outputs))
+                return false;
 
-            plugin.endpoints.push_back(endpoint);
+            plugin.endpoints.push_back(std::move(endpoint));
             success = true;
         }
+
+        if (!success)
+            fail(JsonError::MissingField, "endpoints");
     }
     catch (const std::exception &e)
     {
@@ -283,13 +425,23 @@ bool PluginJsonParser::parsePlugin(const rapidjson::Document &doc, struct ArkPlu
 
     try 
     {
-        const rapidjson::Value& pluginInfo = doc["plugin"];
-        plugin.name = pluginInfo["Name"].GetString();
-        plugin.version = pluginInfo["Version"].GetString();
-        plugin.author = pluginInfo["Author"].GetString();
-        plugin.description = pluginInfo["Description"].GetString();
-        plugin.env = pluginInfo["env"].GetString();
-        plugin.license_level = pluginInfo["license"].GetInt();
+        const rapidjson::Value *pluginInfo = nullptr;
+        if (!readObject(doc, "plugin", "", pluginInfo) ||
+            !readString(*pluginInfo, "Name", "plugin.", plugin.name) ||
+            !readString(*pluginInfo, "Version", "plugin.", plugin.version) ||
+            !readString(*pluginInfo, "Author", "plugin.", plugin.author) ||
+            !readString(*pluginInfo, "Description", "plugin.", plugin.description) ||
+            !readString(*pluginInfo, "env", "plugin.", plugin.env))
+            return false;
+
+        // older backends don't send a license level
+        auto license = pluginInfo->FindMember("license");
+        if (license != pluginInfo->MemberEnd())
+        {
+            if (!license->value.IsInt())
+                return fail(JsonError::WrongType, "plugin.license");
+            plugin.license_level = license->value.GetInt();
+        }
         success = true;
     }
     catch (const std::exception &e)
@@ -301,30 +453,64 @@ bool PluginJsonParser::parsePlugin(const rapidjson::Document &doc, struct ArkPlu
     return success;
 }
 
+bool PluginJsonParser::parsePluginList(const std::string &response_json, std::vector<std::string> &plugins) const
+{
+    bool success = false;
+
+    try
+    {
+        std::string buffer;
+        rapidjson::Document doc;
+        if (!parseDocument(response_json, buffer, doc))
+        {
+            LogError("ConfigParser::parsePluginList " + m_error.toString());
+            return false;
+        }
+
+        auto list = doc.FindMember("plugins");
+        if (list == doc.MemberEnd())
+            return fail(JsonError::MissingField, "plugins");
+        if (!list->value.IsArray())
+            return fail(JsonError::WrongType, "plugins");
+
+        plugins.reserve(list->value.Size());
+        for (const auto &name : list->value.GetArray())
+        {
+            if (name.IsString())
+                plugins.emplace_back(name.GetString(), name.GetStringLength());
+        }
+        success = true;
+    }
+    catch (const std::exception &e)
+    {
+        std::string msg  = std::string("Exception parsePluginList(): ") + e.what();
+        LogError(msg);
+    }
+
+    return success;
+}
+
 bool PluginJsonParser::parseExecuteResponse(const std::string &response_json, struct ExecuteResponse &response) const
 {
     bool success = false;
 
     try 
     {
+        std::string buffer;
         rapidjson::Document doc;
-        doc.Parse(response_json.c_str());
-
-        if (doc.HasParseError() || !doc.IsObject()) 
+        if (!parseDocument(response_json, buffer, doc))
         {
-            LogError("ConfigParser::parseExecuteResponse Error parsing JSON or JSON is not an object.");
+            LogError("ConfigParser::parseExecuteResponse " + m_error.toString());
             return false;
         }
 
-        const rapidjson::Value& job_id = doc["job_id"];
-        if (job_id.IsString())
+        if (readString(doc, "job_id", "", response.job_id))
         {
-            response.job_id = job_id.GetString();
             success = true;
         }
         else
         {
-            LogError("ConfigParser::parseExecuteResponse Error parsing job_id.");
+            LogError("ConfigParser::parseExecuteResponse Error parsing job_id: " + m_error.toString());
             return false;
         }
     }
@@ -343,20 +529,21 @@ bool PluginJsonParser::parseUploadImageResponse(const std::string &response_json
 
     try 
     {
+        std::string buffer;
         rapidjson::Document doc;
-        doc.Parse(response_json.c_str());
-
-        if (doc.HasMember("status"))
+        std::string status;
+        if (!parseDocument(response_json, buffer, doc) || !readString(doc, "status", "", status))
         {
-            if (doc["status"] == "Success")
-            {
-                if (doc.HasMember("image_id"))
-                {
-                    img_id = doc["image_id"].GetString();
-                    success = true;
-                }
-            }
+            LogError("ConfigParser::parseUploadImageResponse " + m_error.toString());
+            return false;
         }
+
+        if (status != "Success")
+            return fail(JsonError::Rejected, status);
+
+        success = readString(doc, "image_id", "", img_id);
+        if (!success)
+            LogError("ConfigParser::parseUploadImageResponse " + m_error.toString());
     }
     catch (const std::exception &e)
     {
@@ -371,26 +558,30 @@ bool PluginJsonParser::parseSubscriptionLevel(const std::string &response_json,
 {
     try
     {
+        std::string buffer;
         rapidjson::Document doc;
-        doc.Parse(response_json.c_str());
+        if (!parseDocument(response_json, buffer, doc))
+            return false;
 
-        if (doc.HasMember("subscription_level"))
+        auto it = doc.FindMember("subscription_level");
+        if (it != doc.MemberEnd())
         {
-            if (doc["subscription_level"].IsInt())
+            if (it->value.IsInt())
             {
-                level = doc["subscription_level"].GetInt();
+                level = it->value.GetInt();
                 LogInfo("Subscription level: " + std::to_string(level));
                 return true;
             }
-            else if (doc["subscription_level"].IsBool())
+            else if (it->value.IsBool())
             {
                 level = 0;
                 LogInfo("Subscription level: " + std::to_string(level));
                 return true;
             }
+            return fail(JsonError::WrongType, "subscription_level");
         }
         else
-            return false;
+            return fail(JsonError::MissingField, "subscription_level");
         
     }
     catch (const std::exception &e)
@@ -401,75 +592,105 @@ bool PluginJsonParser::parseSubscriptionLevel(const std::string &response_json,
     return false;
 }
 
+bool PluginJsonParser::readJobStatus(const rapidjson::Value &obj, struct JobStatusResponse &response) const
+{
+    bool success = false;
+
+    std::string status_string;
+    if (!readString(obj, "status", "", status_string, false))
+        return false;
+    if (!status_string.empty())
+    {
+        response.status = jobStatusFromString(status_string);
+        if (response.status == JOB_STATUS_SUCCESS)
+        {
+            // masks come back under their own key
+            if (obj.HasMember("output_img"))
+                success = readString(obj, "output_img", "", response.img_id);
+            else if (obj.HasMember("output_mask"))
+                success = readString(obj, "output_mask", "", response.img_id);
+            else
+                fail(JsonError::MissingField, "output_img");
+        }
+        else
+            success = true;
+    }
+
+    std::string detail;
+    if (!readString(obj, "detail", "", detail, false))
+        return false;
+    if (!detail.empty())
+    {
+        response.status = jobStatusFromString(detail);
+        success = true;
+    }
+
+    if (!success && m_error.code == JsonError::None)
+        fail(JsonError::MissingField, "status");
+    return success;
+}
+
 bool PluginJsonParser::parseJobResponse(const std::string &response_json, struct JobStatusResponse &response) const
 {
     bool success = false;
 
     try 
     {
+        std::string buffer;
         rapidjson::Document doc;
-        doc.Parse(response_json.c_str());
-
-        if (doc.HasParseError() || !doc.IsObject()) 
+        if (!parseDocument(response_json, buffer, doc))
         {
-            LogError("ConfigParser::parseJobResponse Error parsing JSON or JSON is not an object.");
+            LogError("ConfigParser::parseJobResponse " + m_error.toString());
             return false;
         }
-        if (doc.HasMember("status"))
+
+        success = readJobStatus(doc, response);
+        if (!success)
+            LogError("ConfigParser::parseJobResponse " + m_error.toString());
+    }
+    catch (const std::exception &e)
+    {
+        std::string msg  = std::string("Exception parseJobResponse(): ") + e.what();
+        LogError(msg);
+    }
+
+    return success;
+}
+
+bool PluginJsonParser::parseBatchFrameResponse(const std::string &response_json, struct BatchFrameResult &response) const
+{
+    bool success = false;
+
+    try 
+    {
+        std::string buffer;
+        rapidjson::Document doc;
+        if (!parseDocument(response_json, buffer, doc))
         {
-            const rapidjson::Value& status_string = doc["status"];
-            if (status_string.IsString())
-            {
-                response.status = jobStatusFromString(status_string.GetString());
-                if (response.status == JOB_STATUS_SUCCESS)
-                {
-                    if (doc.HasMember("output_img"))
-                    {
-                        const rapidjson::Value& status_string = doc["output_img"];
-                        if (status_string.IsString())
-                        {
-                            response.img_id = status_string.GetString();
-                            success = true;
-                        }
-                    }
-                    else if (doc.HasMember("output_mask"))
-                    {
-                        const rapidjson::Value& status_string = doc["output_mask"];
-                        if (status_string.IsString())
-                        {
-                            response.img_id = status_string.GetString();
-                            success = true;
-                        }
-                    }
-
-                }
-                else
-                    success = true;
-            }
-            else
-            {
-                LogError("ConfigParser::parseJobResponse Error parsing job_id.");
-                return false;
-            }
+            LogError("ConfigParser::parseBatchFrameResponse " + m_error.toString());
+            return false;
         }
-        if (doc.HasMember("detail"))
+
+        auto frame = doc.FindMember("frame");
+        if (frame == doc.MemberEnd())
+            fail(JsonError::MissingField, "frame");
+        else if (!frame->value.IsInt())
+            fail(JsonError::WrongType, "frame");
+        else
         {
-            const rapidjson::Value& status_string = doc["detail"];
-            if (status_string.IsString())
-            {
-                response.status = jobStatusFromString(status_string.GetString());
-                success = true;
-            }
-            else
-            {
-                LogError("ConfigParser::parseJobResponse Error parsing job_id.");
-                return false;
-            }
+            response.frame = frame->value.GetInt();
+            JobStatusResponse job_status;
+            success = readJobStatus(doc, job_status);
+            response.status = job_status.status;
+            response.img_id = job_status.img_id;
         }
+
+        if (!success)
+            LogError("ConfigParser::parseBatchFrameResponse " + m_error.toString());
     }
     catch (const std::exception &e)
     {
-        std::string msg  = std::string("Exception parseJobResponse(): ") + e.what();
+        std::string msg  = std::string("Exception parseBatchFrameResponse(): ") + e.what();
         LogError(msg);
     }
 
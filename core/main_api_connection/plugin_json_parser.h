@@ -5,6 +5,7 @@
 #include <vector>
 #include <map>
 #include "ark_plugin.h"
+#include "transfer_policy.h"
 
 struct ExecuteResponse
 {
@@ -16,6 +17,13 @@ struct BackendConfig
     std::string py_dir;
     std::string startup_dir;
     std::string startup_cmd;
+    std::string backend_url;
+    std::string backend_socket;
+    std::vector<std::string> backend_pool;
+    TransferThresholds transfer;
+    bool async_render {false};
+    bool proxy_upscale {false};
+    bool progressive_render {false};
 };
 
 typedef enum {
@@ -32,9 +40,36 @@ struct JobStatusResponse
     std::string img_id;
 };
 
+// one line of a batch job's result stream, sent as each frame of the batch finishes
+struct BatchFrameResult
+{
+    int frame {0};
+    JobStatus status {JOB_STATUS_UNKNOWN};
+    std::string img_id;
+};
+
 JobStatus jobStatusFromString(const std::string &status_string);
 std::string stringFromJobStatus(JobStatus job_status);
 
+enum class JsonError
+{
+    None,
+    Syntax,         // not well formed JSON
+    NotObject,      // the top level value is not an object
+    MissingField,
+    WrongType,
+    Rejected        // well formed, but the backend reported a failure
+};
+
+struct JsonParseError
+{
+    JsonError code {JsonError::None};
+    std::string field;  // path of the offending member, e.g. "endpoints.segment_face.inputs"
+    size_t offset {0};  // where a syntax error was found
+
+    std::string toString() const;
+};
+
 
 class PluginJsonParser
 {
@@ -50,14 +85,27 @@ public:
     bool parseUserInfo(const std::string &response_json, std::string &user_info) const;
     bool parseExecuteResponse(const std::string &response_json, struct ExecuteResponse &response) const;
     bool parseJobResponse(const std::string &response_json, struct JobStatusResponse &response) const;
+    bool parseBatchFrameResponse(const std::string &response_json, struct BatchFrameResult &response) const;
     bool parseUploadImageResponse(const std::string &response_json, std::string &img_id) const;
     bool parseSubscriptionLevel(const std::string &response_json, int& levels) const;
+    bool parsePluginList(const std::string &response_json, std::vector<std::string> &plugins) const;
+
+    // why the last parse* call failed, parsing and validating happen in the same pass
+    const JsonParseError &lastError() const { return m_error; }
 protected:
+    bool parseDocument(const std::string &json, std::string &buffer, rapidjson::Document &doc) const;
+    bool fail(JsonError code, const std::string &field) const;
+    bool readString(const rapidjson::Value &obj, const char *name, const std::string &path, std::string &out, bool required = true) const;
+    bool readObject(const rapidjson::Value &obj, const char *name, const std::string &path, const rapidjson::Value *&out) const;
+    // status and output image of a job, shared by single and batch job responses
+    bool readJobStatus(const rapidjson::Value &obj, struct JobStatusResponse &response) const;
     bool parseEndpoints(const rapidjson::Document &doc, struct ArkPlugin &plugin) const;
+    bool parseDataList(const rapidjson::Value &obj, const std::string &path, std::vector<Data> &out) const;
     bool parsePlugin(const rapidjson::Document &doc, struct ArkPlugin &plugin) const;
     bool parseConfigValue(const rapidjson::Value& plugin_config, struct ArkPlugin &plugin) const;
     bool parseConfigDoc(const rapidjson::Document &doc, struct ArkPlugin &plugin) const;
 
+    mutable JsonParseError m_error;
 
 };
 #endif // CONFIG_PARSER_H
@@ -0,0 +1,104 @@
+#include "response_cache.h"
+#include "logger.h"
+
+ResponseCache &ResponseCache::instance()
+{
+    static ResponseCache instance;
+    return instance;
+}
+
+ResponseCache::Lookup ResponseCache::lookup(const std::string &url, CachedResponse &out_entry)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_entries.find(url);
+    if (it == m_entries.end())
+    {
+        return Lookup::Miss;
+    }
+
+    out_entry = it->second;
+    if (std::chrono::steady_clock::now() < it->second.expires)
+    {
+        m_stats.hits++;
+        m_stats.bytes_saved += it->second.body.size();
+        return Lookup::Fresh;
+    }
+    return Lookup::Stale;
+}
+
+void ResponseCache::store(const std::string &url,
+                          const std::string &body,
+                          const std::string &etag,
+                          const std::string &last_modified,
+                          std::chrono::seconds ttl)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    CachedResponse &entry = m_entries[url];
+    entry.body = body;
+    entry.etag = etag;
+    entry.last_modified = last_modified;
+    entry.expires = std::chrono::steady_clock::now() + ttl;
+
+    // every store comes from a full download, so that is what we count as a miss
+    m_stats.misses++;
+}
+
+bool ResponseCache::markRevalidated(const std::string &url, std::chrono::seconds ttl, std::string &out_body)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_entries.find(url);
+    if (it == m_entries.end())
+    {
+        return false;
+    }
+
+    it->second.expires = std::chrono::steady_clock::now() + ttl;
+    out_body = it->second.body;
+
+    m_stats.hits++;
+    m_stats.revalidations++;
+    m_stats.bytes_saved += it->second.body.size();
+    return true;
+}
+
+void ResponseCache::invalidate(const std::string &url)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.erase(url);
+}
+
+void ResponseCache::invalidatePrefix(const std::string &url_prefix)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+    {
+        if (it->first.compare(0, url_prefix.size(), url_prefix) == 0)
+            it = m_entries.erase(it);
+        else
+            ++it;
+    }
+}
+
+void ResponseCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+}
+
+ResponseCacheStats ResponseCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+std::string ResponseCache::statsString() const
+{
+    ResponseCacheStats cur_stats = stats();
+    return "Response cache: hits=" + std::to_string(cur_stats.hits) +
+           " misses=" + std::to_string(cur_stats.misses) +
+           " revalidated=" + std::to_string(cur_stats.revalidations) +
+           " bytes saved=" + std::to_string(cur_stats.bytes_saved);
+}
@@ -0,0 +1,62 @@
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include <string>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+
+struct CachedResponse
+{
+    std::string body;
+    std::string etag;
+    std::string last_modified;
+    std::chrono::steady_clock::time_point expires;
+};
+
+struct ResponseCacheStats
+{
+    size_t hits {0};
+    size_t misses {0};
+    size_t revalidations {0}; //304 responses, counted as hits as well
+    size_t bytes_saved {0};
+};
+
+// Caches the bodies of GET responses keyed by URL. Entries are served without
+// touching the backend until their TTL runs out, after which they are revalidated
+// with If-None-Match/If-Modified-Since when the backend gave us an ETag/Last-Modified.
+// Shared by every ApiConnection since they are created on the fly all over the place.
+class ResponseCache
+{
+public:
+    enum class Lookup
+    {
+        Miss,
+        Fresh,
+        Stale
+    };
+
+    static ResponseCache &instance();
+
+    Lookup lookup(const std::string &url, CachedResponse &out_entry);
+    void store(const std::string &url,
+               const std::string &body,
+               const std::string &etag,
+               const std::string &last_modified,
+               std::chrono::seconds ttl);
+    bool markRevalidated(const std::string &url, std::chrono::seconds ttl, std::string &out_body);
+
+    void invalidate(const std::string &url);
+    void invalidatePrefix(const std::string &url_prefix);
+    void clear();
+
+    ResponseCacheStats stats() const;
+    std::string statsString() const;
+
+protected:
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, CachedResponse> m_entries;
+    ResponseCacheStats m_stats;
+};
+
+#endif // RESPONSE_CACHE_H
@@ -0,0 +1,126 @@
+#include "shm_transport.h"
+#include "logger.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// enough for a few requests in flight (source frame plus temporal neighbours)
+static const size_t kShmSlotCount = 4;
+
+SharedMemorySlot::SharedMemorySlot(const std::string &name)
+: m_name(name)
+{ }
+
+SharedMemorySlot::~SharedMemorySlot()
+{
+    release();
+#ifndef _WIN32
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+        shm_unlink(m_name.c_str());
+    }
+#endif
+}
+
+void SharedMemorySlot::release()
+{
+#ifndef _WIN32
+    if (m_data)
+        munmap(m_data, m_capacity);
+#endif
+    m_data = nullptr;
+    m_capacity = 0;
+}
+
+bool SharedMemorySlot::reserve(size_t size)
+{
+#ifdef _WIN32
+    (void)size;
+    return false;
+#else
+    if (size <= m_capacity)
+        return true;
+
+    if (m_fd < 0)
+    {
+        m_fd = shm_open(m_name.c_str(), O_CREAT | O_RDWR, 0600);
+        if (m_fd < 0)
+        {
+            LogError("shm_open failed for " + m_name);
+            return false;
+        }
+    }
+
+    release();
+    if (ftruncate(m_fd, static_cast<off_t>(size)) != 0)
+    {
+        LogError("Failed to grow shared memory " + m_name + " to " + std::to_string(size) + " bytes");
+        return false;
+    }
+
+    void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (data == MAP_FAILED)
+    {
+        LogError("mmap failed for " + m_name);
+        return false;
+    }
+    m_data = static_cast<uint8_t *>(data);
+    m_capacity = size;
+    return true;
+#endif
+}
+
+ShmTransport::ShmTransport()
+{
+#ifndef _WIN32
+    std::string prefix = "/deepmake_" + std::to_string(getpid()) + "_";
+#else
+    std::string prefix = "/deepmake_";
+#endif
+    for (size_t i = 0; i < kShmSlotCount; i++)
+    {
+        m_slots.push_back(std::make_unique<SharedMemorySlot>(prefix + std::to_string(i)));
+    }
+}
+
+ShmTransport &ShmTransport::instance()
+{
+    static ShmTransport transport;
+    return transport;
+}
+
+bool ShmTransport::isSupported()
+{
+#ifdef _WIN32
+    return false;
+#else
+    return true;
+#endif
+}
+
+SharedMemorySlot *ShmTransport::acquire(size_t size, std::unique_lock<std::mutex> &out_lock)
+{
+    // take the first free slot, otherwise wait on the next one in turn
+    for (auto &slot : m_slots)
+    {
+        std::unique_lock<std::mutex> lock(slot->mutex(), std::try_to_lock);
+        if (lock.owns_lock())
+        {
+            if (!slot->reserve(size))
+                return nullptr;
+            out_lock = std::move(lock);
+            return slot.get();
+        }
+    }
+
+    SharedMemorySlot *slot = m_slots[m_next_slot++ % m_slots.size()].get();
+    std::unique_lock<std::mutex> lock(slot->mutex());
+    if (!slot->reserve(size))
+        return nullptr;
+    out_lock = std::move(lock);
+    return slot;
+}
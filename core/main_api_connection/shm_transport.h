@@ -0,0 +1,59 @@
+#ifndef SHM_TRANSPORT_H
+#define SHM_TRANSPORT_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+// A named POSIX shared memory segment the local backend can open by name.
+// Grows on demand, the mapping is recreated so pointers from data() don't survive reserve().
+class SharedMemorySlot
+{
+public:
+    explicit SharedMemorySlot(const std::string &name);
+    ~SharedMemorySlot();
+
+    SharedMemorySlot(const SharedMemorySlot &) = delete;
+    SharedMemorySlot &operator=(const SharedMemorySlot &) = delete;
+
+    bool reserve(size_t size);
+    uint8_t *data() { return m_data; }
+    size_t capacity() const { return m_capacity; }
+    const std::string &name() const { return m_name; }
+    std::mutex &mutex() { return m_mutex; }
+
+protected:
+    void release();
+
+    std::string m_name;
+    std::mutex m_mutex;
+    int m_fd {-1};
+    uint8_t *m_data {nullptr};
+    size_t m_capacity {0};
+};
+
+// Ring of shared memory slots used to hand frames to a backend on the same machine
+// without encoding them or pushing them through a socket. HTTP only carries a small
+// JSON handle naming the slot, a slot stays locked until the request using it returns.
+class ShmTransport
+{
+public:
+    static ShmTransport &instance();
+
+    // shared memory is only wired up on POSIX systems
+    static bool isSupported();
+
+    // returns a slot with at least size bytes, the lock keeps other requests off it
+    SharedMemorySlot *acquire(size_t size, std::unique_lock<std::mutex> &out_lock);
+
+protected:
+    ShmTransport();
+
+    std::vector<std::unique_ptr<SharedMemorySlot>> m_slots;
+    std::atomic<size_t> m_next_slot {0};
+};
+
+#endif // SHM_TRANSPORT_H
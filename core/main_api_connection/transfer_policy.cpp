@@ -0,0 +1,187 @@
+#include "transfer_policy.h"
+#include "logger.h"
+#include <algorithm>
+#include <map>
+#include <memory>
+
+static std::mutex s_configured_mutex;
+static TransferThresholds s_configured_thresholds;
+
+static const char *codecName(ImageCodec codec)
+{
+    switch (codec)
+    {
+        case ImageCodec::PNG: return "PNG";
+        case ImageCodec::BMP: return "BMP";
+        case ImageCodec::JPEG: return "JPEG";
+    }
+    return "?";
+}
+
+static double smooth(double average, double sample, double weight)
+{
+    return average + (sample - average) * weight;
+}
+
+std::string TransferPlan::toString() const
+{
+    std::string text = codecName(codec);
+    if (codec == ImageCodec::JPEG)
+        text += " q" + std::to_string(quality);
+    if (downscale > 1)
+        text += " 1/" + std::to_string(downscale);
+    return text;
+}
+
+TransferPolicy::TransferPolicy(const TransferThresholds &thresholds)
+: m_thresholds(thresholds)
+{ }
+
+TransferPolicy &TransferPolicy::forBackend(const std::string &base_url)
+{
+    static std::mutex registry_mutex;
+    static std::map<std::string, std::unique_ptr<TransferPolicy>> policies;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    std::unique_ptr<TransferPolicy> &policy = policies[base_url];
+    if (!policy)
+    {
+        std::lock_guard<std::mutex> configured_lock(s_configured_mutex);
+        policy = std::make_unique<TransferPolicy>(s_configured_thresholds);
+    }
+    return *policy;
+}
+
+void TransferPolicy::setConfiguredThresholds(const TransferThresholds &thresholds)
+{
+    std::lock_guard<std::mutex> lock(s_configured_mutex);
+    s_configured_thresholds = thresholds;
+}
+
+void TransferPolicy::setThresholds(const TransferThresholds &thresholds)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_thresholds = thresholds;
+}
+
+TransferThresholds TransferPolicy::thresholds() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_thresholds;
+}
+
+TransferPolicy::CodecModel &TransferPolicy::model(ImageCodec codec)
+{
+    switch (codec)
+    {
+        case ImageCodec::BMP: return m_bmp;
+        case ImageCodec::JPEG: return m_jpeg;
+        default: return m_png;
+    }
+}
+
+const TransferPolicy::CodecModel &TransferPolicy::model(ImageCodec codec) const
+{
+    return const_cast<TransferPolicy *>(this)->model(codec);
+}
+
+double TransferPolicy::estimate(const CodecModel &codec, size_t raw_bytes, int downscale) const
+{
+    double bytes = static_cast<double>(raw_bytes) / (downscale * downscale);
+    return bytes / codec.bytes_per_second + bytes * codec.size_ratio / m_throughput + m_round_trip;
+}
+
+TransferPlan TransferPolicy::plan(size_t raw_bytes, TransferRole role) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    TransferPlan best;
+    if (!m_thresholds.adaptive || !m_has_throughput)
+        return best;
+
+    auto consider = [&](ImageCodec codec, int downscale, bool first)
+    {
+        double seconds = estimate(model(codec), raw_bytes, downscale);
+        if (first || seconds < best.estimated_seconds)
+        {
+            best.codec = codec;
+            best.quality = codec == ImageCodec::JPEG ? m_thresholds.jpeg_quality : 0;
+            best.downscale = downscale;
+            best.estimated_seconds = seconds;
+        }
+    };
+
+    consider(ImageCodec::PNG, 1, true);
+    consider(ImageCodec::BMP, 1, false);
+
+    // the lossy options only come in when the lossless ones blow the budget
+    if (best.estimated_seconds > m_thresholds.max_transfer_seconds && m_thresholds.allow_lossy)
+    {
+        consider(ImageCodec::JPEG, 1, false);
+    }
+
+    if (best.estimated_seconds > m_thresholds.max_transfer_seconds &&
+        m_thresholds.allow_downscale && role == TransferRole::Neighbour)
+    {
+        ImageCodec codec = best.codec;
+        for (int downscale = 2; downscale <= m_thresholds.max_downscale && best.estimated_seconds > m_thresholds.max_transfer_seconds; downscale *= 2)
+        {
+            best.estimated_seconds = 0.0;
+            consider(codec, downscale, true);
+        }
+    }
+    return best;
+}
+
+void TransferPolicy::recordTransfer(size_t bytes, double seconds)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // what's left once the round trip is taken out is time spent moving the bytes
+    double transfer_seconds = std::max(seconds - m_round_trip, 1e-6);
+    double sample = static_cast<double>(bytes) / transfer_seconds;
+    m_throughput = m_has_throughput ? smooth(m_throughput, sample, m_thresholds.smoothing) : sample;
+    m_has_throughput = true;
+}
+
+void TransferPolicy::recordRoundTrip(double seconds)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_round_trip = m_round_trip > 0.0 ? smooth(m_round_trip, seconds, m_thresholds.smoothing) : seconds;
+}
+
+void TransferPolicy::recordEncode(ImageCodec codec, size_t raw_bytes, size_t encoded_bytes, double seconds)
+{
+    if (raw_bytes == 0 || seconds <= 0.0)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    CodecModel &codec_model = model(codec);
+    codec_model.bytes_per_second = smooth(codec_model.bytes_per_second, raw_bytes / seconds, m_thresholds.smoothing);
+    codec_model.size_ratio = smooth(codec_model.size_ratio, static_cast<double>(encoded_bytes) / raw_bytes, m_thresholds.smoothing);
+}
+
+bool TransferPolicy::hasMeasurements() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_has_throughput;
+}
+
+double TransferPolicy::throughput() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_throughput;
+}
+
+double TransferPolicy::roundTrip() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_round_trip;
+}
+
+std::string TransferPolicy::statsString() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return "Transfer policy: " + std::to_string(m_throughput / 1e6) + " MB/s, rtt " +
+           std::to_string(m_round_trip * 1000.0) + " ms";
+}
@@ -0,0 +1,85 @@
+#ifndef TRANSFER_POLICY_H
+#define TRANSFER_POLICY_H
+
+#include <string>
+#include <mutex>
+#include "images/image_utils.h"
+
+// Config.json "Transfer_Policy", anything lossy is opt in
+struct TransferThresholds
+{
+    bool adaptive {true};           // false always sends PNG, like before
+    bool allow_lossy {false};
+    int jpeg_quality {90};
+    bool allow_downscale {false};   // neighbour frames only, the frame being rendered keeps its size
+    int max_downscale {4};
+    double max_transfer_seconds {0.25}; // per input, beyond this the lossy options are considered
+    double smoothing {0.2};         // weight of a new sample in the moving averages
+};
+
+enum class TransferRole
+{
+    Frame,     // the frame being rendered
+    Neighbour  // frames sent as temporal context
+};
+
+struct TransferPlan
+{
+    ImageCodec codec {ImageCodec::PNG};
+    int quality {0};
+    int downscale {1};
+    double estimated_seconds {0.0};
+
+    bool lossless() const { return codec != ImageCodec::JPEG && downscale == 1; }
+    std::string toString() const;
+};
+
+// Picks how each input image is encoded for the backend it is sent to. Keeps moving averages of
+// the link throughput and round trip time, and of how fast and how small each codec encodes,
+// then takes the option with the lowest encode + send time. Until a transfer has been measured
+// it sticks to PNG.
+class TransferPolicy
+{
+public:
+    explicit TransferPolicy(const TransferThresholds &thresholds = TransferThresholds());
+
+    // one per backend, created with the configured thresholds
+    static TransferPolicy &forBackend(const std::string &base_url);
+    static void setConfiguredThresholds(const TransferThresholds &thresholds);
+
+    void setThresholds(const TransferThresholds &thresholds);
+    TransferThresholds thresholds() const;
+
+    TransferPlan plan(size_t raw_bytes, TransferRole role) const;
+
+    void recordTransfer(size_t bytes, double seconds);
+    void recordRoundTrip(double seconds);
+    void recordEncode(ImageCodec codec, size_t raw_bytes, size_t encoded_bytes, double seconds);
+
+    bool hasMeasurements() const;
+    double throughput() const; // bytes per second
+    double roundTrip() const;  // seconds
+    std::string statsString() const;
+
+protected:
+    struct CodecModel
+    {
+        double bytes_per_second; // raw bytes encoded per second
+        double size_ratio;       // encoded size over raw size
+    };
+
+    CodecModel &model(ImageCodec codec);
+    const CodecModel &model(ImageCodec codec) const;
+    double estimate(const CodecModel &codec, size_t raw_bytes, int downscale) const;
+
+    mutable std::mutex m_mutex;
+    TransferThresholds m_thresholds;
+    double m_throughput {0.0};
+    double m_round_trip {0.0};
+    bool m_has_throughput {false};
+    CodecModel m_png {60e6, 0.45};
+    CodecModel m_bmp {2e9, 1.0};
+    CodecModel m_jpeg {150e6, 0.08};
+};
+
+#endif // TRANSFER_POLICY_H
@@ -0,0 +1,56 @@
+#include "param_snapshot.h"
+#include <algorithm>
+
+void ParamSnapshot::clear()
+{
+    m_values.clear();
+    m_filled.clear();
+    m_ids.clear();
+}
+
+void ParamSnapshot::set(int param_id, int slot, const ParamValue &value)
+{
+    if (slot < 0)
+        return;
+
+    if (static_cast<size_t>(slot) >= m_values.size())
+    {
+        m_values.resize(slot + 1);
+        m_filled.resize(slot + 1, false);
+    }
+    m_values[slot] = value;
+    m_filled[slot] = true;
+
+    // hosts hand the params over in id order, so this is normally a push_back
+    auto it = std::lower_bound(m_ids.begin(), m_ids.end(), param_id,
+                               [](const std::pair<int, int> &entry, int id) { return entry.first < id; });
+    if (it != m_ids.end() && it->first == param_id)
+        it->second = slot;
+    else
+        m_ids.insert(it, {param_id, slot});
+}
+
+int ParamSnapshot::slotFor(int param_id) const
+{
+    auto it = std::lower_bound(m_ids.begin(), m_ids.end(), param_id,
+                               [](const std::pair<int, int> &entry, int id) { return entry.first < id; });
+    if (it == m_ids.end() || it->first != param_id || !m_filled[it->second])
+        return -1;
+    return it->second;
+}
+
+bool ParamSnapshot::get(int param_id, ParamValue &out_value) const
+{
+    int slot = slotFor(param_id);
+    if (slot < 0)
+        return false;
+    out_value = m_values[slot];
+    return true;
+}
+
+ParamValue ParamSnapshot::value(int param_id) const
+{
+    ParamValue result;
+    get(param_id, result);
+    return result;
+}
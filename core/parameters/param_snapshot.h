@@ -0,0 +1,34 @@
+#ifndef PARAM_SNAPSHOT_H
+#define PARAM_SNAPSHOT_H
+
+#include <cstddef>
+#include <vector>
+#include "parameter.h"
+
+// Every parameter value the host had when a render or param update started, read from the
+// host in one go. Values sit in a flat array by the host's dense parameter slot, lookups by
+// param id go through a small sorted table instead of back out to the host.
+class ParamSnapshot
+{
+public:
+    ParamSnapshot() = default;
+
+    void clear();
+    void set(int param_id, int slot, const ParamValue &value);
+
+    bool contains(int param_id) const { return slotFor(param_id) >= 0; }
+    bool get(int param_id, ParamValue &out_value) const;
+    // default constructed value when the host didn't have the param
+    ParamValue value(int param_id) const;
+
+    size_t size() const { return m_ids.size(); }
+
+protected:
+    int slotFor(int param_id) const;
+
+    std::vector<ParamValue> m_values;   // by slot
+    std::vector<bool> m_filled;         // by slot
+    std::vector<std::pair<int, int>> m_ids; // param id -> slot, sorted by id
+};
+
+#endif // PARAM_SNAPSHOT_H
@@ -0,0 +1,73 @@
+#ifndef SINGLE_FLIGHT_H
+#define SINGLE_FLIGHT_H
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+// Coalesces concurrent calls for the same key: the first caller runs the work and
+// everyone arriving while it is in flight waits for and shares its result. Nothing is
+// kept once the call returns, caching the result is up to the caller. Thread safe.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class SingleFlight
+{
+public:
+    template <typename Fn>
+    Value run(const Key &key, Fn &&fn)
+    {
+        std::shared_future<Value> result;
+        std::shared_ptr<std::promise<Value>> promise;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_in_flight.find(key);
+            if (it != m_in_flight.end())
+            {
+                result = it->second;
+                m_shared++;
+            }
+            else
+            {
+                promise = std::make_shared<std::promise<Value>>();
+                result = promise->get_future().share();
+                m_in_flight.emplace(key, result);
+            }
+        }
+
+        if (promise)
+        {
+            try
+            {
+                promise->set_value(fn());
+            }
+            catch (...)
+            {
+                promise->set_exception(std::current_exception());
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_in_flight.erase(key);
+        }
+        return result.get();
+    }
+
+    // how many calls were answered by somebody else's request
+    size_t sharedCount() const { return m_shared; }
+
+    size_t inFlight() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_in_flight.size();
+    }
+
+protected:
+    mutable std::mutex m_mutex;
+    std::unordered_map<Key, std::shared_future<Value>, Hash> m_in_flight;
+    std::atomic<size_t> m_shared {0};
+};
+
+#endif // SINGLE_FLIGHT_H
@@ -15,6 +15,8 @@
 #include "ae_host_delegate.h"
 #include "utils.h"
 #include <string>
+#include <mutex>
+#include <unordered_set>
 #include <logger.h>
 #include "ae_main.h"
 #include "ae_video_image_checkout.h"
@@ -125,6 +127,12 @@ int AEVideoHostDelegate::currentFrame() const
     return in_data->current_time / in_data->time_step;
 }
 
+bool AEVideoHostDelegate::isHostParamIndex(int hostParamIndex) const
+{
+    // params[0] is the source layer, the registered params follow it so the array is one longer than m_params
+    return hostParamIndex >= 1 && hostParamIndex <= (int)m_params.size();
+}
+
 int AEVideoHostDelegate::hostIndexFromParamId(int paramId) const
 {
     int hostParamIndex = -1;
@@ -135,7 +143,7 @@ int AEVideoHostDelegate::hostIndexFromParamId(int paramId) const
         return -1;
     }
     hostParamIndex = m_paramIndexMap.at(paramId);
-    if (hostParamIndex < 0 || hostParamIndex > (int)m_params.size())
+    if (!isHostParamIndex(hostParamIndex))
     {
         LOG_ASSERT(false,"param not found: " + std::to_string(paramId)); //param not found
         return -1;
@@ -174,45 +182,67 @@ ParamValue AEVideoHostDelegate::getParamValue(int paramId) const
         return value;
     }
 
+    if (!paramDefValue(param, value) && param->param_type != PF_Param_BUTTON)
+    {
+        LOG_ASSERT(false,"Param type not supported"); //param type not supported
+    }
+    return value;
+}
+
+void AEVideoHostDelegate::fillParamSnapshot(ParamSnapshot &snapshot) const
+{
+    if (params == nullptr)
+        return;
+
+    for (const auto &mapItem : m_paramIndexMap)
+    {
+        int hostParamIndex = mapItem.second;
+        if (!isHostParamIndex(hostParamIndex) || params[hostParamIndex] == nullptr)
+            continue;
+
+        // buttons, groups and the like have no value to keep
+        ParamValue value;
+        if (paramDefValue(params[hostParamIndex], value))
+            snapshot.set(mapItem.first, hostParamIndex, value);
+    }
+}
+
+bool AEVideoHostDelegate::paramDefValue(const PF_ParamDef *param, ParamValue &out_value) const
+{
     switch (param->param_type)
     {
-        case PF_Param_BUTTON:
-            break;
         case PF_Param_CHECKBOX:
         {
-            value = static_cast<bool>(param->u.bd.value);
-            break;
+            out_value = static_cast<bool>(param->u.bd.value);
+            return true;
         }
         case PF_Param_COLOR:
         {
-            value = Color(param->u.cd.value.red / 255.0f,
+            out_value = Color(param->u.cd.value.red / 255.0f,
                             param->u.cd.value.green / 255.0f,
                             param->u.cd.value.blue / 255.0f);
-            break;
+            return true;
         }
         case PF_Param_FLOAT_SLIDER:
         {
-            value = (float)param->u.fs_d.value;
-            break;
+            out_value = (float)param->u.fs_d.value;
+            return true;
         }
         case PF_Param_POPUP:
         {
-            value = param->u.pd.value - 1; //menu indexes are 1 based
-            break;
+            out_value = param->u.pd.value - 1; //menu indexes are 1 based
+            return true;
         }
         case PF_Param_POINT:
         {
-            value = Point2D(ConvertPF_FixedToFloat(param->u.td.x_value), 
+            out_value = Point2D(ConvertPF_FixedToFloat(param->u.td.x_value), 
                             ConvertPF_FixedToFloat(param->u.td.y_value));
-            break;
+            return true;
         }
         default:
-        {
-            LOG_ASSERT(false,"Param type not supported"); //param type not supported
             break;
-        }
     }
-    return value;
+    return false;
 }
 
 ARK_SeqData *AEVideoHostDelegate::checkoutSequenceData()
@@ -319,24 +349,109 @@ void AEVideoHostDelegate::setRenderedImageID(const std::string &img_id)
     }
 }
 
-std::string AEVideoHostDelegate::getCachedParams()
+uint64_t AEVideoHostDelegate::getCachedParamsHash()
 {
-    std::string params;
+    uint64_t params_hash = 0;
     ARK_SeqData* seq_data = checkoutSequenceData();
     if (seq_data)
     {
-        params = seq_data->cached_params;
+        params_hash = seq_data->cached_params_hash;
+    }
+    return params_hash;
+}
+
+void AEVideoHostDelegate::setCachedParamsHash(uint64_t params_hash)
+{
+    ARK_SeqData* seq_data = checkoutSequenceData();
+    if (seq_data)
+    {
+        seq_data->cached_params_hash = params_hash;
+    }
+}
+
+uint64_t AEVideoHostDelegate::instanceId()
+{
+    uint64_t instance_id = 0;
+    ARK_SeqData* seq_data = checkoutSequenceData();
+    if (seq_data && seq_data->version == kSequenceDataVersion)
+    {
+        instance_id = seq_data->instance_id;
+    }
+    return instance_id;
+}
+
+bool AEVideoHostDelegate::isInteractiveRender()
+{
+    // a render asks several times, the delegate only lives for the one host call
+    if (m_interactive_render != -1)
+        return m_interactive_render == 1;
+
+    // render queue frames end up in a file, they have to wait for the real result
+    bool interactive = false;
+    try
+    {
+        AEGP_SuiteHandler suites(in_data->pica_basicP);
+        AEGP_RenderQueueState state = AEGP_RenderQueueState_STOPPED;
+        if (suites.RenderQueueSuite1()->AEGP_GetRenderQueueState(&state) == A_Err_NONE)
+            interactive = state != AEGP_RenderQueueState_RENDERING;
+    }
+    catch (...)
+    {
+        interactive = false;
+    }
+    m_interactive_render = interactive ? 1 : 0;
+    return interactive;
+}
+
+static std::mutex &rerenderMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+static std::unordered_set<uint64_t> &rerenderRequests()
+{
+    static std::unordered_set<uint64_t> requests;
+    return requests;
+}
+
+void AEVideoHostDelegate::requestRerender(uint64_t instance_id)
+{
+    std::lock_guard<std::mutex> lock(rerenderMutex());
+    rerenderRequests().insert(instance_id);
+}
+
+bool AEVideoHostDelegate::takeRerenderRequest(uint64_t instance_id)
+{
+    std::lock_guard<std::mutex> lock(rerenderMutex());
+    return rerenderRequests().erase(instance_id) > 0;
+}
+
+RenderCompletion AEVideoHostDelegate::renderCompletion()
+{
+    uint64_t instance_id = instanceId();
+    return [instance_id]() { requestRerender(instance_id); };
+}
+
+std::string AEVideoHostDelegate::getRenderIndex()
+{
+    std::string index;
+    ARK_SeqData* seq_data = checkoutSequenceData();
+    if (seq_data && seq_data->render_index_size <= kRenderIndexSize)
+    {
+        index.assign(seq_data->render_index, seq_data->render_index_size);
     }
-    return params;
+    return index;
 }
 
-void AEVideoHostDelegate::setCachedParams(const std::string &params)
+void AEVideoHostDelegate::setRenderIndex(const std::string &index)
 {
     ARK_SeqData* seq_data = checkoutSequenceData();
-    LOG_ASSERT(params.size() < kCachedParamSize,"Cached param size too large");
-    if (seq_data && params.size() < kCachedParamSize)
+    LOG_ASSERT(index.size() <= kRenderIndexSize,"Render index size too large");
+    if (seq_data && index.size() <= kRenderIndexSize)
     {
-        strcpy(seq_data->cached_params, params.c_str());
+        memcpy(seq_data->render_index, index.data(), index.size());
+        seq_data->render_index_size = static_cast<unsigned short>(index.size());
     }
 }
 
@@ -35,6 +35,7 @@ public:
     virtual int paramIdFromHostIndex(int hostIndex) const override;
 
     ParamValue getParamValue(int paramId) const override;
+    void fillParamSnapshot(ParamSnapshot &snapshot) const override;
     
     virtual std::string getTextPrompt() override;
     virtual void setTextPrompt(const std::string &prompt) override;
@@ -42,8 +43,19 @@ public:
     virtual std::string getRenderedImageID() override;
     virtual void setRenderedImageID(const std::string &img_id) override;
 
-    virtual std::string getCachedParams() override;
-    virtual void setCachedParams(const std::string &params) override;
+    virtual uint64_t getCachedParamsHash() override;
+    virtual void setCachedParamsHash(uint64_t params_hash) override;
+
+    virtual std::string getRenderIndex() override;
+    virtual void setRenderIndex(const std::string &index) override;
+
+    virtual uint64_t instanceId() override;
+    virtual bool isInteractiveRender() override;
+    virtual RenderCompletion renderCompletion() override;
+
+    //queued renders can finish on any thread, AE is asked for the new frame on its next idle event
+    static void requestRerender(uint64_t instance_id);
+    static bool takeRerenderRequest(uint64_t instance_id);
 
     virtual bool getCachedLicenseStatus() override;
     virtual void setCachedLicenseStatus(bool status) override;
@@ -102,6 +114,8 @@ public:
 
 protected:
     float ConvertPF_FixedToFloat(PF_Fixed fixedValue) const;
+    bool paramDefValue(const PF_ParamDef *param, ParamValue &out_value) const;
+    bool isHostParamIndex(int hostParamIndex) const;
 
     PF_Cmd cmd;
     PF_InData *in_data {nullptr};
@@ -121,6 +135,8 @@ protected:
     void checkinSequenceData();
     ARK_SeqData *in_seq_data {nullptr};
     AEDrawHelper m_drawHelper;
+    // the render queue state, asked once per host call, -1 until then
+    int m_interactive_render {-1};
 
     ArkImagePtr checkOutImg(int frame);
 };
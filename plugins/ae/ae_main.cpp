@@ -10,6 +10,11 @@
 #include "AEFX_SuiteHelper.h"
 #include "AEGP_SuiteHandler.h"
 #include <iostream>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <random>
+#include <string>
 
 
 static PF_Err 
@@ -164,6 +169,15 @@ PF_ParamIndex changedParamHostIndex(void *extraP,
     return -1;
 }
 
+static uint64_t newInstanceId()
+{
+    static std::mt19937_64 generator(std::random_device{}());
+    uint64_t instance_id = 0;
+    while (instance_id == 0) // 0 means no instance id
+        instance_id = generator();
+    return instance_id;
+}
+
 static PF_Err
 SequenceSetup(
               PF_InData        *in_data,
@@ -187,7 +201,9 @@ SequenceSetup(
         seqP = (ARK_SeqData*)PF_LOCK_HANDLE(seqH);
         seqP->prompt[0] = '\0';
         seqP->rendered_image_id[0] = '\0';
-        seqP->cached_params[0] = '\0';
+        seqP->cached_params_hash = 0;
+        seqP->render_index_size = 0;
+        seqP->instance_id = newInstanceId();
         seqP->version = kSequenceDataVersion;
         seqP->license_status = false;
 
@@ -213,13 +229,91 @@ SequenceSetup(
     return err;
 }
 
+// Layout saved up to version 3, prompt and rendered_image_id sit at the same offsets in
+// every version, version moved when cached_params became a hash in version 4
+typedef struct ARK_SeqDataV3
+{
+    char prompt[kPromptSize];
+    char rendered_image_id[kImageIDSize];
+    char cached_params[1024];
+    int version;
+    bool license_status;
+} ARK_SeqDataV3;
+
+// rebuilds sequence data saved by an older version in the current layout, the prompt and
+// the last rendered image carry over, anything that can't is recomputed by the next render
+static PF_Err
+MigrateSequenceData(
+              PF_InData        *in_data,
+              PF_OutData        *out_data)
+{
+    size_t size = PF_GET_HANDLE_SIZE(in_data->sequence_data);
+    const char *old_data = reinterpret_cast<const char*>(PF_LOCK_HANDLE(in_data->sequence_data));
+    const ARK_SeqData *old_v4 = reinterpret_cast<const ARK_SeqData*>(old_data);
+    const ARK_SeqDataV3 *old_v3 = reinterpret_cast<const ARK_SeqDataV3*>(old_data);
+
+    // version 4 is checked first, its version field falls inside the cached params text of the older layout
+    int old_version = -1;
+    if (old_data && size >= offsetof(ARK_SeqData, instance_id) && old_v4->version == 4)
+        old_version = 4;
+    else if (old_data && size >= sizeof(ARK_SeqDataV3) && (old_v3->version == 2 || old_v3->version == 3))
+        old_version = old_v3->version;
+
+    std::string prompt;
+    std::string rendered_image_id;
+    bool license_status = false;
+    uint64_t cached_params_hash = 0;
+    std::string render_index;
+    if (old_version != -1)
+    {
+        prompt.assign(old_data, strnlen(old_data, kPromptSize));
+        rendered_image_id.assign(old_data + kPromptSize, strnlen(old_data + kPromptSize, kImageIDSize));
+        license_status = old_version == 4 ? old_v4->license_status : old_v3->license_status;
+    }
+    if (old_version == 4)
+    {
+        cached_params_hash = old_v4->cached_params_hash;
+        render_index.assign(old_v4->render_index, std::min<size_t>(old_v4->render_index_size, kRenderIndexSize));
+    }
+    PF_UNLOCK_HANDLE(in_data->sequence_data);
+
+    PF_Err err = SequenceSetup(in_data, out_data);
+    if (err || old_version == -1)
+        return err;
+
+    ARK_SeqData *seqP = reinterpret_cast<ARK_SeqData*>(PF_LOCK_HANDLE(in_data->sequence_data));
+    memcpy(seqP->prompt, prompt.data(), prompt.size());
+    memcpy(seqP->rendered_image_id, rendered_image_id.data(), rendered_image_id.size());
+    seqP->license_status = license_status;
+    seqP->cached_params_hash = cached_params_hash;
+    memcpy(seqP->render_index, render_index.data(), render_index.size());
+    seqP->render_index_size = static_cast<unsigned short>(render_index.size());
+    PF_UNLOCK_HANDLE(in_data->sequence_data);
+    return err;
+}
+
 static PF_Err
 SequenceResetup(
                 PF_InData        *in_data,
                 PF_OutData        *out_data,
                 PF_ParamDef        *params[])
 {
-    return SequenceSetup(in_data, out_data);
+    if (!in_data->sequence_data)
+        return SequenceSetup(in_data, out_data);
+
+    // sent after a project is loaded and to the copy when an effect or its layer is
+    // duplicated, the copy arrives with the original's sequence data so it gets its own
+    // instance id, otherwise both would share queued renders and in flight jobs
+    ARK_SeqData *seqP = reinterpret_cast<ARK_SeqData*>(PF_LOCK_HANDLE(in_data->sequence_data));
+    bool current = seqP && seqP->version == kSequenceDataVersion;
+    if (current)
+        seqP->instance_id = newInstanceId();
+    PF_UNLOCK_HANDLE(in_data->sequence_data);
+    if (!current)
+        return MigrateSequenceData(in_data, out_data);
+
+    out_data->sequence_data = in_data->sequence_data;
+    return PF_Err_NONE;
 }
 
 static PF_Err
@@ -273,6 +367,19 @@ MouseEventType AEEventTypeToArk(PF_EventType ae_type)
     return eMouseOver;
 }
 
+static bool takeQueuedRenderResult(PF_InData *in_data)
+{
+    if (!in_data->sequence_data)
+        return false;
+
+    bool finished = false;
+    ARK_SeqData *seqP = reinterpret_cast<ARK_SeqData*>(PF_LOCK_HANDLE(in_data->sequence_data));
+    if (seqP && seqP->version == kSequenceDataVersion)
+        finished = AEVideoHostDelegate::takeRerenderRequest(seqP->instance_id);
+    PF_UNLOCK_HANDLE(in_data->sequence_data);
+    return finished;
+}
+
 PF_Err 
 HandleEvent(	
 				PF_InData		*in_data,
@@ -283,6 +390,14 @@ HandleEvent(
 {
 	PF_Err		err		= PF_Err_NONE;
 
+    //results of queued renders are picked up by rendering the instance again
+    if (extra->e_type == PF_Event_IDLE)
+    {
+        if (takeQueuedRenderResult(in_data))
+            out_data->out_flags |= PF_OutFlag_FORCE_RERENDER;
+        return err;
+    }
+
     //Currently we only support Comp window events
     if( (*extra->contextH)->w_type == PF_Window_COMP || (*extra->contextH)->w_type ==  PF_Window_LAYER)
     {
@@ -335,7 +450,7 @@ EffectMain (
                 err = SequenceSetdown(in_data, out_data, params, output);
                 break;
             case PF_Cmd_SEQUENCE_RESETUP:
-                //err = SequenceResetup(in_dataP, out_data, params);
+                err = SequenceResetup(in_data, out_data, params);
                 break;
             case PF_Cmd_SEQUENCE_FLATTEN:
                 err = SequenceFlatten(in_data, out_data, params, output);
@@ -15,21 +15,25 @@
 #include <AE_Macros.h>
 
 #include <Param_Utils.h>
+#include <cstdint>
 
 #define DESCRIPTION	"DeepMake AI Renderer"
 
 #define kPromptSize 1024
 #define kImageIDSize 64
-#define kCachedParamSize 1024
-#define kSequenceDataVersion 2
+#define kRenderIndexSize 4096 //matches kRenderIndexMaxBytes in core
+#define kSequenceDataVersion 5
 
 typedef struct ARK_SeqData
 {
     char prompt[kPromptSize];
     char rendered_image_id[kImageIDSize]; //The most recent rendered image id
-    char cached_params[kCachedParamSize]; //the params that were used to render the most recent image
+    uint64_t cached_params_hash; //hash of the params that were used to render the most recent image
 	int version = -1;
 	bool license_status = false;
+    unsigned short render_index_size;
+    char render_index[kRenderIndexSize]; //serialized RenderResultIndex, frame + params -> rendered image id
+    uint64_t instance_id; //made up in SequenceSetup, ties queued renders to this effect instance
 	
 } ARK_SeqData;
 
@@ -49,6 +49,8 @@ ParamValue OFXVideoHostDelegate::getParamValue(int paramFilterIndex) const
 {
     return ParamValue();
 }
+void OFXVideoHostDelegate::fillParamSnapshot(ParamSnapshot &snapshot) const
+{ }
 int OFXVideoHostDelegate::hostIndexFromParamId(int paramId) const
 {
     return -1;
@@ -70,12 +72,30 @@ std::string OFXVideoHostDelegate::getRenderedImageID()
 }
 void OFXVideoHostDelegate::setRenderedImageID(const std::string &img_id)
 {}
-std::string OFXVideoHostDelegate::getCachedParams()
+uint64_t OFXVideoHostDelegate::getCachedParamsHash()
+{
+    return 0;
+}
+void OFXVideoHostDelegate::setCachedParamsHash(uint64_t params_hash)
+{ }
+std::string OFXVideoHostDelegate::getRenderIndex()
 {
     return "";
 }
-void OFXVideoHostDelegate::setCachedParams(const std::string &params)
+void OFXVideoHostDelegate::setRenderIndex(const std::string &index)
 { }
+uint64_t OFXVideoHostDelegate::instanceId()
+{
+    return 0;
+}
+bool OFXVideoHostDelegate::isInteractiveRender()
+{
+    return false;
+}
+RenderCompletion OFXVideoHostDelegate::renderCompletion()
+{
+    return nullptr;
+}
 ArkImagePtr OFXVideoHostDelegate::sourceImg()
 { 
     return nullptr;
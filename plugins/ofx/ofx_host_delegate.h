@@ -23,6 +23,7 @@ public:
 
     virtual bool registerParam(const ParameterPtr param) override;
     virtual ParamValue getParamValue(int paramFilterIndex) const override;
+    virtual void fillParamSnapshot(ParamSnapshot &snapshot) const override;
     virtual int hostIndexFromParamId(int paramId) const override;
     virtual int paramIdFromHostIndex(int hostIndex) const override;
 
@@ -32,8 +33,15 @@ public:
     virtual std::string getRenderedImageID() override;
     virtual void setRenderedImageID(const std::string &img_id) override;
 
-    virtual std::string getCachedParams() override;
-    virtual void setCachedParams(const std::string &params) override;
+    virtual uint64_t getCachedParamsHash() override;
+    virtual void setCachedParamsHash(uint64_t params_hash) override;
+
+    virtual std::string getRenderIndex() override;
+    virtual void setRenderIndex(const std::string &index) override;
+
+    virtual uint64_t instanceId() override;
+    virtual bool isInteractiveRender() override;
+    virtual RenderCompletion renderCompletion() override;
     
     virtual ArkImagePtr sourceImg() override;
     virtual ArkImagePtr destImg() override;
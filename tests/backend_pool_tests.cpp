@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include "backend_pool.h"
+#include "circuit_breaker.h"
+#include "mock_backend.h"
+#include "images/image_utils.h"
+#include "images/image_buffer.h"
+
+using namespace ::testing;
+
+class BackendPoolTest : public Test
+{
+};
+
+static std::vector<BackendNode> fakeNodes(const std::string &prefix, int count)
+{
+    std::vector<BackendNode> nodes;
+    for (int i = 0; i < count; i++)
+        nodes.push_back(BackendNode{"http://" + prefix + std::to_string(i) + ":8000/", ""});
+    return nodes;
+}
+
+TEST(BackendPoolTest, SpreadsJobsOverLeastBusyNodes)
+{
+    std::vector<BackendNode> nodes = fakeNodes("spread", 3);
+    BackendPool pool(nodes);
+
+    std::vector<std::unique_ptr<BackendLease>> leases;
+    for (int i = 0; i < 6; i++)
+        leases.push_back(std::make_unique<BackendLease>(pool));
+    for (const auto &node : nodes)
+        EXPECT_EQ(pool.outstanding(node.base_url), 2);
+
+    // finishing a job on a node makes it the one with room
+    std::string freed = leases[1]->node().base_url;
+    leases[1].reset();
+    BackendLease next(pool);
+    EXPECT_EQ(next.node().base_url, freed);
+}
+
+TEST(BackendPoolTest, SkipsExcludedAndFailingNodes)
+{
+    std::vector<BackendNode> nodes = fakeNodes("failing", 2);
+    BackendPool pool(nodes);
+
+    for (int i = 0; i < 3; i++)
+        CircuitBreaker::forBackend(nodes[0].base_url).recordFailure();
+    for (int i = 0; i < 4; i++)
+    {
+        BackendLease lease(pool);
+        EXPECT_EQ(lease.node().base_url, nodes[1].base_url);
+    }
+
+    // with nothing healthy left the failing node still beats none at all
+    BackendLease fallback(pool, {nodes[1].base_url});
+    ASSERT_TRUE(fallback.valid());
+    EXPECT_EQ(fallback.node().base_url, nodes[0].base_url);
+
+    BackendLease none(pool, {nodes[0].base_url, nodes[1].base_url});
+    EXPECT_FALSE(none.valid());
+}
+
+TEST(BackendPoolTest, ResultsAreFetchedFromTheNodeThatRenderedThem)
+{
+    std::vector<BackendNode> nodes = fakeNodes("results", 3);
+    nodes[2].unix_socket = "/tmp/results.sock";
+    BackendPool pool(nodes);
+    EXPECT_EQ(pool.nodeForUrl(nodes[2].base_url).base_url, nodes[2].base_url);
+    EXPECT_EQ(pool.nodeForUrl(nodes[2].base_url).unix_socket, nodes[2].unix_socket);
+    // no longer configured, or rendered before the node was kept with the result
+    EXPECT_EQ(pool.nodeForUrl("http://gone:8000/").base_url, nodes[0].base_url);
+    EXPECT_EQ(pool.nodeForUrl("").base_url, nodes[0].base_url);
+}
+
+#ifndef _WIN32
+TEST(BackendPoolTest, JobsStayOnTheirNode)
+{
+    const int kWorkers = 3;
+    const int kJobs = 9;
+    std::vector<std::unique_ptr<MockBackend>> backends;
+    std::vector<BackendNode> nodes;
+    for (int i = 0; i < kWorkers; i++)
+    {
+        auto backend = std::make_unique<MockBackend>();
+        ASSERT_TRUE(backend->start());
+        backend->setLatency(std::chrono::milliseconds(50));
+        std::string prefix = "node" + std::to_string(i) + "-";
+        auto job_counter = std::make_shared<std::atomic<int>>(0);
+        backend->on("PUT", "plugins/call_endpoint", [prefix, job_counter](const MockRequest &)
+        {
+            return MockResponse{200, "{\"job_id\":\"" + prefix + std::to_string((*job_counter)++) + "\"}"};
+        });
+        // a node only knows its own jobs
+        backend->on("GET", "job/", [prefix](const MockRequest &request)
+        {
+            if (request.path.find("job/" + prefix) != 0)
+                return MockResponse{404, "{}"};
+            return MockResponse{200, "{\"status\":\"Success\",\"output_img\":\"out\"}"};
+        });
+        nodes.push_back(BackendNode{backend->baseUrl(), ""});
+        backends.push_back(std::move(backend));
+    }
+
+    BackendPool pool(nodes);
+    std::atomic<int> succeeded {0};
+    std::vector<std::thread> renders;
+    for (int i = 0; i < kJobs; i++)
+    {
+        renders.emplace_back([&pool, &succeeded]()
+        {
+            BackendLease lease(pool);
+            ApiConnection api_connection = lease.connection();
+            std::string job_id = api_connection.callEndpoint("Dummy", "run", "{}");
+            if (!job_id.empty() && api_connection.jobStatus(job_id).status == JOB_STATUS_SUCCESS)
+                succeeded++;
+        });
+    }
+    for (auto &render : renders)
+        render.join();
+
+    EXPECT_EQ(succeeded, kJobs);
+    for (const auto &backend : backends)
+        EXPECT_EQ(backend->requestCount("plugins/call_endpoint"), static_cast<size_t>(kJobs / kWorkers));
+}
+
+TEST(BackendPoolTest, SameImageIdOnTwoNodesIsNotMixedUp)
+{
+    std::vector<std::unique_ptr<MockBackend>> backends;
+    for (uint8_t value : {10, 200})
+    {
+        std::shared_ptr<ImageBuffer> image = std::make_shared<ImageBuffer>();
+        image->init(2, 2, ImageFormat::RGBA8, ChannelOrder::RGBA);
+        memset(image->data(), value, static_cast<size_t>(image->strideBytes()) * image->height());
+        std::string encoded = encodeImage(image, ImageCodec::PNG);
+
+        auto backend = std::make_unique<MockBackend>();
+        backend->on("GET", "image/get/", [encoded](const MockRequest &)
+        {
+            return MockResponse{200, encoded, "image/png"};
+        });
+        ASSERT_TRUE(backend->start());
+        backends.push_back(std::move(backend));
+    }
+
+    // each backend numbers its results on its own, a decoded image is only reused for the node it came from
+    for (int pass = 0; pass < 2; pass++)
+    {
+        ArkImagePtr first = ApiConnection(backends[0]->baseUrl()).getImage("same-id");
+        ArkImagePtr second = ApiConnection(backends[1]->baseUrl()).getImage("same-id");
+        ASSERT_NE(first, nullptr);
+        ASSERT_NE(second, nullptr);
+        EXPECT_EQ(static_cast<uint8_t *>(first->data())[0], 10);
+        EXPECT_EQ(static_cast<uint8_t *>(second->data())[0], 200);
+    }
+    for (const auto &backend : backends)
+        EXPECT_EQ(backend->requestCount("image/get/"), 1u);
+}
+#endif
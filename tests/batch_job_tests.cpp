@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include <rapidjson/document.h>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "main_api_connection.h"
+#include "mock_backend.h"
+
+using namespace ::testing;
+
+class BatchJobTest : public Test
+{
+};
+
+#ifndef _WIN32
+
+// Stands in for a backend implementing the batch contract. Every frame of a submitted batch
+// "renders" for frame_time and is reported as rendered_<frame>, frames listed in failing
+// report an error, and the stream stops after reported_frames lines when that's set
+struct MockBatchBackend
+{
+    MockBackend backend;
+    std::chrono::milliseconds frame_time {0};
+    std::vector<int> failing;
+    size_t reported_frames {0};
+
+    std::mutex mutex;
+    std::vector<int> frames;
+    std::vector<std::string> prompts;
+
+    bool start()
+    {
+        backend.on("PUT", "plugins/call_batch/", [this](const MockRequest &request)
+        {
+            rapidjson::Document doc;
+            doc.Parse(request.body.c_str());
+            if (doc.HasParseError() || !doc.HasMember("frames") || !doc["frames"].IsArray())
+                return MockResponse{400, "{\"detail\":\"bad batch\"}"};
+
+            std::lock_guard<std::mutex> lock(mutex);
+            frames.clear();
+            prompts.clear();
+            for (const auto &frame : doc["frames"].GetArray())
+            {
+                frames.push_back(frame["frame"].GetInt());
+                prompts.push_back(frame["params"]["prompt"].GetString());
+            }
+            return MockResponse{200, "{\"job_id\":\"batch_1\"}"};
+        });
+
+        backend.on("GET", "job/batch/", [this](const MockRequest &)
+        {
+            std::vector<int> batch_frames;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                batch_frames = frames;
+            }
+            size_t line_count = reported_frames > 0 ? std::min(reported_frames, batch_frames.size()) : batch_frames.size();
+
+            MockResponse response;
+            response.content_type = "application/x-ndjson";
+            auto next = std::make_shared<size_t>(0);
+            response.stream = [this, batch_frames, line_count, next](std::string &chunk)
+            {
+                if (*next >= line_count)
+                    return false;
+                std::this_thread::sleep_for(frame_time);
+                int frame = batch_frames[(*next)++];
+                if (std::find(failing.begin(), failing.end(), frame) != failing.end())
+                    chunk = "{\"frame\":" + std::to_string(frame) + ",\"status\":\"Job error\"}\n";
+                else
+                    chunk = "{\"frame\":" + std::to_string(frame) + ",\"status\":\"Success\",\"output_img\":\"rendered_" + std::to_string(frame) + "\"}\n";
+                return *next < line_count;
+            };
+            return response;
+        });
+        return backend.start();
+    }
+};
+
+static std::vector<BatchFrame> batchFrames(int first, int count)
+{
+    std::vector<BatchFrame> frames;
+    for (int frame = first; frame < first + count; frame++)
+        frames.push_back(BatchFrame{frame, "{\"prompt\":\"frame " + std::to_string(frame) + "\"}"});
+    return frames;
+}
+
+TEST(BatchJobTest, FramesGoOutAsOneJob)
+{
+    MockBatchBackend batch_backend;
+    ASSERT_TRUE(batch_backend.start());
+    ApiConnection api_connection(batch_backend.backend.baseUrl());
+
+    std::string job_id = api_connection.callEndpointBatch("Diffusers", "img2img", batchFrames(10, 3));
+    EXPECT_EQ(job_id, "batch_1");
+    EXPECT_EQ(batch_backend.backend.requestCount("plugins/call_batch/Diffusers/img2img"), 1u);
+    EXPECT_EQ(batch_backend.frames, (std::vector<int>{10, 11, 12}));
+    EXPECT_EQ(batch_backend.prompts, (std::vector<std::string>{"frame 10", "frame 11", "frame 12"}));
+
+    std::vector<BatchFrameResult> results;
+    EXPECT_TRUE(api_connection.streamBatchResults(job_id, 3, [&](const BatchFrameResult &result) { results.push_back(result); }));
+    ASSERT_EQ(results.size(), 3u);
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(results[i].frame, 10 + i);
+        EXPECT_EQ(results[i].status, JOB_STATUS_SUCCESS);
+        EXPECT_EQ(results[i].img_id, "rendered_" + std::to_string(10 + i));
+    }
+    EXPECT_EQ(batch_backend.backend.requestCount("job/"), 1u);
+}
+
+TEST(BatchJobTest, FramesArriveWhileTheBatchRuns)
+{
+    MockBatchBackend batch_backend;
+    batch_backend.frame_time = std::chrono::milliseconds(100);
+    ASSERT_TRUE(batch_backend.start());
+    ApiConnection api_connection(batch_backend.backend.baseUrl());
+
+    std::string job_id = api_connection.callEndpointBatch("Diffusers", "img2img", batchFrames(1, 4));
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::chrono::steady_clock::duration> arrivals;
+    EXPECT_TRUE(api_connection.streamBatchResults(job_id, 4, [&](const BatchFrameResult &)
+    {
+        arrivals.push_back(std::chrono::steady_clock::now() - start);
+    }));
+    auto total = std::chrono::steady_clock::now() - start;
+
+    // the first frame is handed over long before the last one has rendered
+    ASSERT_EQ(arrivals.size(), 4u);
+    EXPECT_LT(arrivals.front() + std::chrono::milliseconds(200), total);
+}
+
+TEST(BatchJobTest, FailedFramesAreReported)
+{
+    MockBatchBackend batch_backend;
+    batch_backend.failing = {6};
+    ASSERT_TRUE(batch_backend.start());
+    ApiConnection api_connection(batch_backend.backend.baseUrl());
+
+    std::string job_id = api_connection.callEndpointBatch("Diffusers", "img2img", batchFrames(5, 3));
+    std::map<int, BatchFrameResult> results;
+    EXPECT_TRUE(api_connection.streamBatchResults(job_id, 3, [&](const BatchFrameResult &result) { results[result.frame] = result; }));
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_EQ(results[5].status, JOB_STATUS_SUCCESS);
+    EXPECT_EQ(results[6].status, JOB_STATUS_ERROR);
+    EXPECT_TRUE(results[6].img_id.empty());
+    EXPECT_EQ(results[7].status, JOB_STATUS_SUCCESS);
+}
+
+TEST(BatchJobTest, StreamEndingEarlyFails)
+{
+    MockBatchBackend batch_backend;
+    batch_backend.reported_frames = 2;
+    ASSERT_TRUE(batch_backend.start());
+    ApiConnection api_connection(batch_backend.backend.baseUrl());
+
+    std::string job_id = api_connection.callEndpointBatch("Diffusers", "img2img", batchFrames(1, 3));
+    size_t reported = 0;
+    EXPECT_FALSE(api_connection.streamBatchResults(job_id, 3, [&](const BatchFrameResult &) { reported++; }));
+    EXPECT_EQ(reported, 2u);
+}
+
+TEST(BatchJobTest, BackendWithoutBatchesIsRemembered)
+{
+    MockBackend backend;
+    ASSERT_TRUE(backend.start());
+    ApiConnection api_connection(backend.baseUrl());
+
+    EXPECT_TRUE(api_connection.batchJobsSupported());
+    EXPECT_TRUE(api_connection.callEndpointBatch("Diffusers", "img2img", batchFrames(1, 2)).empty());
+    EXPECT_FALSE(api_connection.batchJobsSupported());
+
+    // not asked again
+    EXPECT_TRUE(api_connection.callEndpointBatch("Diffusers", "img2img", batchFrames(1, 2)).empty());
+    EXPECT_EQ(backend.requestCount("plugins/call_batch/"), 1u);
+}
+#endif
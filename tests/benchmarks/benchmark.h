@@ -0,0 +1,31 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <string>
+#include <vector>
+
+// Minimal registry for the hand run benchmarks in unit.benchmarks. Each one prints its own
+// numbers and returns non zero when it couldn't run.
+using BenchmarkFunction = int (*)(int count);
+
+struct Benchmark
+{
+    std::string name;
+    BenchmarkFunction run;
+    int default_count;
+};
+
+std::vector<Benchmark> &benchmarks();
+
+struct BenchmarkRegistration
+{
+    BenchmarkRegistration(const char *name, BenchmarkFunction run, int default_count)
+    {
+        benchmarks().push_back(Benchmark{name, run, default_count});
+    }
+};
+
+#define REGISTER_BENCHMARK(name, function, default_count) \
+    static BenchmarkRegistration s_benchmark_##function(name, function, default_count)
+
+#endif // BENCHMARK_H
@@ -0,0 +1,28 @@
+// unit.benchmarks [name] [count], runs every benchmark when no name is given
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "benchmark.h"
+
+std::vector<Benchmark> &benchmarks()
+{
+    static std::vector<Benchmark> registered;
+    return registered;
+}
+
+int main(int argc, char **argv)
+{
+    std::string filter = argc > 1 ? argv[1] : "";
+    int count = argc > 2 ? std::atoi(argv[2]) : 0;
+
+    int failures = 0;
+    for (const auto &benchmark : benchmarks())
+    {
+        if (!filter.empty() && benchmark.name != filter)
+            continue;
+        std::printf("== %s\n", benchmark.name.c_str());
+        if (benchmark.run(count > 0 ? count : benchmark.default_count) != 0)
+            failures++;
+    }
+    return failures == 0 ? 0 : 1;
+}
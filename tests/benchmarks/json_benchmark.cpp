@@ -0,0 +1,102 @@
+// get_info parsing: the old validate then parse double pass against the single in situ pass.
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <rapidjson/document.h>
+#include "benchmark.h"
+#include "main_api_connection/plugin_json_parser.h"
+
+// a plugin with lots of endpoints and inputs, the size the bigger plugins send back
+static std::string syntheticInfo(int endpoint_count, int input_count)
+{
+    std::string json = "{\"plugin\": {\"Name\": \"Benchmark\", \"Version\": \"0.1.0\", \"Author\": \"DeepMake\","
+                       " \"Description\": \"Synthetic plugin\", \"env\": \"bench\", \"license\": 1},"
+                       " \"config\": {\"model_name\": \"bench/model\", \"model_dtype\": \"fp16\", \"save_output\": false},"
+                       " \"endpoints\": {";
+    for (int e = 0; e < endpoint_count; e++)
+    {
+        json += (e ? ", " : "") + std::string("\"endpoint_") + std::to_string(e) + "\": {\"call\": \"execute\", \"inputs\": {\"img\": \"Image\"";
+        for (int i = 0; i < input_count; i++)
+            json += ", \"input_" + std::to_string(i) + "\": \"Float(default=0.5, min=0.0, max=1.0, optional=true, help='input " + std::to_string(i) + "')\"";
+        json += "}, \"outputs\": {\"output_img\": \"Image\"}}";
+    }
+    json += "}}";
+    return json;
+}
+
+// what ApiConnection::validateInfoResponse followed by PluginJsonParser::parsePluginInfo used to cost
+static bool doublePass(const std::string &json, ArkPlugin &plugin)
+{
+    {
+        rapidjson::Document doc;
+        doc.Parse(json.c_str());
+        if (doc.HasParseError() || !doc.IsObject() || !doc.HasMember("endpoints") || !doc["endpoints"].IsObject())
+            return false;
+        for (auto it = doc["endpoints"].MemberBegin(); it != doc["endpoints"].MemberEnd(); ++it)
+        {
+            const rapidjson::Value &endpoint = it->value;
+            if (!endpoint.IsObject() || !endpoint.HasMember("call") || !endpoint["call"].IsString() ||
+                !endpoint.HasMember("inputs") || !endpoint["inputs"].IsObject() ||
+                !endpoint.HasMember("outputs") || !endpoint["outputs"].IsObject())
+                return false;
+            for (auto input = endpoint["inputs"].MemberBegin(); input != endpoint["inputs"].MemberEnd(); ++input)
+            {
+                if (!input->value.IsString())
+                    return false;
+            }
+        }
+    }
+
+    rapidjson::Document doc;
+    doc.Parse(json.c_str());
+    plugin.endpoints.clear();
+    for (auto it = doc["endpoints"].MemberBegin(); it != doc["endpoints"].MemberEnd(); ++it)
+    {
+        Endpoint endpoint;
+        endpoint.name = it->name.GetString();
+        endpoint.call = it->value["call"].GetString();
+        for (auto input = it->value["inputs"].MemberBegin(); input != it->value["inputs"].MemberEnd(); ++input)
+            endpoint.inputs.push_back(Data{input->name.GetString(), input->value.GetString()});
+        for (auto output = it->value["outputs"].MemberBegin(); output != it->value["outputs"].MemberEnd(); ++output)
+            endpoint.outputs.push_back(Data{output->name.GetString(), output->value.GetString()});
+        plugin.endpoints.push_back(endpoint);
+    }
+    return true;
+}
+
+template <typename Fn>
+static double secondsPerParse(int count, Fn &&fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++)
+    {
+        if (!fn())
+            return -1.0;
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / count;
+}
+
+static int jsonParsing(int count)
+{
+    const int kSizes[][2] = {{4, 8}, {32, 24}, {128, 48}};
+    for (const auto &size : kSizes)
+    {
+        std::string json = syntheticInfo(size[0], size[1]);
+        PluginJsonParser parser;
+        ArkPlugin plugin;
+
+        double double_pass = secondsPerParse(count, [&]() { return doublePass(json, plugin); });
+        double single_pass = secondsPerParse(count, [&]() { return parser.parsePluginInfo(json, plugin); });
+        if (double_pass < 0.0 || single_pass < 0.0)
+        {
+            std::printf("failed to parse the synthetic get_info payload: %s\n", parser.lastError().toString().c_str());
+            return 1;
+        }
+
+        std::printf("%8zu bytes  validate+parse %8.1f us   single pass %8.1f us   %.2fx\n",
+                    json.size(), double_pass * 1e6, single_pass * 1e6, double_pass / single_pass);
+    }
+    return 0;
+}
+
+REGISTER_BENCHMARK("json", jsonParsing, 200);
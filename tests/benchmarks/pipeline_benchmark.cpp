@@ -0,0 +1,182 @@
+// A sequence rendered back to back against the same sequence through the three stage
+// RenderPipeline, on a mock backend with its own latency for uploads, inference and downloads.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "benchmark.h"
+#include "mock_backend.h"
+#include "main_api_connection.h"
+#include "render_pipeline.h"
+#include "images/image_buffer.h"
+#include "images/image_utils.h"
+
+static const int kFrameSize = 64;
+
+struct StageLatencies
+{
+    int upload_ms;
+    int infer_ms;
+    int download_ms;
+};
+
+struct SequenceFrame
+{
+    int frame {0};
+    ArkImagePtr source;
+    std::string source_id;
+    std::string result_id;
+    ArkImagePtr result;
+};
+
+// every frame different, so the upload cache can't skip any of them
+static ArkImagePtr sequenceFrame(int frame)
+{
+    std::shared_ptr<ImageBuffer> image = std::make_shared<ImageBuffer>();
+    image->init(kFrameSize, kFrameSize, ImageFormat::RGBA8, ChannelOrder::RGBA);
+    uint8_t *pixels = static_cast<uint8_t *>(image->data());
+    for (int i = 0; i < kFrameSize * kFrameSize; i++)
+    {
+        pixels[i * 4 + 0] = static_cast<uint8_t>(frame);
+        pixels[i * 4 + 1] = static_cast<uint8_t>(frame >> 8);
+        pixels[i * 4 + 2] = static_cast<uint8_t>(i);
+        pixels[i * 4 + 3] = 255;
+    }
+    return image;
+}
+
+static void addStageHandlers(MockBackend &backend, const StageLatencies &latencies, const std::string &encoded_result)
+{
+    std::shared_ptr<std::atomic<int>> next_id = std::make_shared<std::atomic<int>>(0);
+    backend.on("POST", "image/upload", [latencies, next_id](const MockRequest &)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(latencies.upload_ms));
+        return MockResponse{200, "{\"status\":\"Success\",\"image_id\":\"source_" + std::to_string((*next_id)++) + "\"}"};
+    });
+    // the job's whole inference happens while the call is answered, its first poll finds it done
+    backend.on("PUT", "plugins/call_endpoint/", [latencies, next_id](const MockRequest &)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(latencies.infer_ms));
+        return MockResponse{200, "{\"job_id\":\"" + std::to_string((*next_id)++) + "\"}"};
+    });
+    backend.on("GET", "job/", [](const MockRequest &request)
+    {
+        std::string job_id = request.path.substr(request.path.rfind('/') + 1);
+        return MockResponse{200, "{\"status\":\"Success\",\"output_img\":\"result_" + job_id + "\"}"};
+    });
+    backend.on("GET", "image/get/", [latencies, encoded_result](const MockRequest &)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(latencies.download_ms));
+        MockResponse response{200, encoded_result};
+        response.content_type = "image/png";
+        return response;
+    });
+}
+
+static bool uploadFrame(const ApiConnection &api_connection, SequenceFrame &frame)
+{
+    return api_connection.uploadImage(frame.source, frame.source_id);
+}
+
+static bool inferFrame(const ApiConnection &api_connection, SequenceFrame &frame)
+{
+    std::string job_id = api_connection.callEndpoint("Mock", "render", "{\"img\":\"" + frame.source_id + "\"}");
+    if (job_id.empty())
+        return false;
+    JobStatusResponse status = api_connection.jobStatus(job_id);
+    frame.result_id = status.img_id;
+    return status.status == JOB_STATUS_SUCCESS;
+}
+
+static bool downloadFrame(const ApiConnection &api_connection, SequenceFrame &frame)
+{
+    frame.result = api_connection.getImage(frame.result_id);
+    return frame.result != nullptr;
+}
+
+static std::vector<SequenceFrame> sequence(int count)
+{
+    std::vector<SequenceFrame> frames;
+    for (int i = 0; i < count; i++)
+        frames.push_back(SequenceFrame{i, sequenceFrame(i), "", "", nullptr});
+    return frames;
+}
+
+// seconds per frame, negative when a frame failed
+static double serialSeconds(const ApiConnection &api_connection, int count)
+{
+    std::vector<SequenceFrame> frames = sequence(count);
+    auto start = std::chrono::steady_clock::now();
+    for (auto &frame : frames)
+    {
+        if (!uploadFrame(api_connection, frame) || !inferFrame(api_connection, frame) || !downloadFrame(api_connection, frame))
+            return -1.0;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / count;
+}
+
+static double pipelinedSeconds(const ApiConnection &api_connection, int count)
+{
+    std::vector<SequenceFrame> frames = sequence(count);
+    RenderPipeline<SequenceFrame *> pipeline(
+        [&](SequenceFrame *&frame) { return uploadFrame(api_connection, *frame); },
+        [&](SequenceFrame *&frame) { return inferFrame(api_connection, *frame); },
+        [&](SequenceFrame *&frame) { return downloadFrame(api_connection, *frame); }, 2);
+    std::atomic<int> failed {0};
+    pipeline.start([&](SequenceFrame *&, bool success)
+    {
+        if (!success)
+            failed++;
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto &frame : frames)
+        pipeline.submit(&frame);
+    pipeline.finish();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return failed == 0 ? elapsed.count() / count : -1.0;
+}
+
+static int renderPipeline(int count)
+{
+#ifdef _WIN32
+    std::printf("the mock backend is not available on Windows\n");
+    return 0;
+#else
+    std::string encoded_result = encodeImage(sequenceFrame(0), ImageCodec::PNG);
+    const StageLatencies kLatencies[] = {{30, 30, 30}, {20, 80, 20}, {60, 30, 20}, {10, 10, 60}};
+    for (const auto &latencies : kLatencies)
+    {
+        MockBackend backend;
+        addStageHandlers(backend, latencies, encoded_result);
+        if (!backend.start())
+        {
+            std::printf("mock backend failed to start\n");
+            return 1;
+        }
+        ApiConnection api_connection(backend.baseUrl());
+
+        double serial = serialSeconds(api_connection, count);
+        double pipelined = pipelinedSeconds(api_connection, count);
+        if (serial < 0.0 || pipelined < 0.0)
+        {
+            std::printf("a frame failed to render\n");
+            return 1;
+        }
+
+        int slowest = std::max({latencies.upload_ms, latencies.infer_ms, latencies.download_ms});
+        int sum = latencies.upload_ms + latencies.infer_ms + latencies.download_ms;
+        std::printf("upload %3d / infer %3d / download %3d ms   serial %6.1f ms/frame (sum %3d)   pipelined %6.1f ms/frame (slowest %3d)\n",
+                    latencies.upload_ms, latencies.infer_ms, latencies.download_ms,
+                    serial * 1000.0, sum, pipelined * 1000.0, slowest);
+    }
+    return 0;
+#endif
+}
+
+REGISTER_BENCHMARK("render_pipeline", renderPipeline, 24);
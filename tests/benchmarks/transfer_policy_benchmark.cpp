@@ -0,0 +1,108 @@
+// Neighbour frame uploads over a throttled loopback link, always PNG against the transfer policy.
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "benchmark.h"
+#include "mock_backend.h"
+#include "main_api_connection.h"
+#include "transfer_policy.h"
+#include "images/image_buffer.h"
+
+static const int kFrameWidth = 3840;
+static const int kFrameHeight = 2160;
+
+// smooth gradient with some grain, compresses roughly like footage does
+static ArkImagePtr syntheticFrame()
+{
+    std::shared_ptr<ImageBuffer> frame = std::make_shared<ImageBuffer>();
+    frame->init(kFrameWidth, kFrameHeight, ImageFormat::RGBA8, ChannelOrder::RGBA);
+    uint8_t *pixels = static_cast<uint8_t *>(frame->data());
+    uint32_t noise = 12345;
+    for (int y = 0; y < kFrameHeight; y++)
+    {
+        for (int x = 0; x < kFrameWidth; x++)
+        {
+            noise = noise * 1664525u + 1013904223u;
+            uint8_t *pixel = pixels + (static_cast<size_t>(y) * kFrameWidth + x) * 4;
+            pixel[0] = static_cast<uint8_t>(x * 255 / kFrameWidth + (noise >> 29));
+            pixel[1] = static_cast<uint8_t>(y * 255 / kFrameHeight + ((noise >> 26) & 7));
+            pixel[2] = static_cast<uint8_t>(128 + ((noise >> 23) & 7));
+            pixel[3] = 255;
+        }
+    }
+    return frame;
+}
+
+static double uploadSeconds(size_t bandwidth, bool adaptive, const ArkImagePtr &frame, int count, std::string &out_plan)
+{
+    MockBackend backend;
+    backend.setBandwidth(bandwidth);
+    backend.setLatency(std::chrono::milliseconds(2));
+    backend.on("POST", "image/upload", [](const MockRequest &)
+    {
+        return MockResponse{200, "{\"status\":\"Success\",\"image_id\":\"uploaded\"}"};
+    });
+    backend.on("GET", "job/", [](const MockRequest &)
+    {
+        return MockResponse{200, "{\"status\":\"Job in progress\"}"};
+    });
+    if (!backend.start())
+        return -1.0;
+
+    TransferThresholds thresholds;
+    thresholds.adaptive = adaptive;
+    thresholds.allow_lossy = true;
+    thresholds.allow_downscale = true;
+    TransferPolicy &policy = TransferPolicy::forBackend(backend.baseUrl());
+    policy.setThresholds(thresholds);
+
+    ApiConnection api_connection(backend.baseUrl());
+    api_connection.jobStatus("rtt");
+    std::vector<std::string> ids;
+    // the first upload is what the policy measures the link with
+    api_connection.uploadMultipleImages({frame}, ids);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++)
+    {
+        api_connection.invalidateUploadCache();
+        ids.clear();
+        api_connection.uploadMultipleImages({frame}, ids);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    out_plan = policy.plan(static_cast<size_t>(kFrameWidth) * kFrameHeight * 4, TransferRole::Neighbour).toString();
+    return elapsed.count() / count;
+}
+
+static int transferPolicy(int count)
+{
+#ifdef _WIN32
+    std::printf("the mock backend is not available on Windows\n");
+    return 0;
+#else
+    ArkImagePtr frame = syntheticFrame();
+    const size_t kBandwidths[] = {0, 200000000, 50000000, 10000000};
+    for (size_t bandwidth : kBandwidths)
+    {
+        std::string png_plan;
+        std::string adaptive_plan;
+        double png_seconds = uploadSeconds(bandwidth, false, frame, count, png_plan);
+        double adaptive_seconds = uploadSeconds(bandwidth, true, frame, count, adaptive_plan);
+        if (png_seconds < 0.0 || adaptive_seconds < 0.0)
+        {
+            std::printf("mock backend failed to start\n");
+            return 1;
+        }
+
+        std::string link = bandwidth == 0 ? "unthrottled" : std::to_string(bandwidth / 1000000) + " MB/s";
+        std::printf("%-12s PNG %7.1f ms/frame   policy %7.1f ms/frame (%s)\n",
+                    link.c_str(), png_seconds * 1000.0, adaptive_seconds * 1000.0, adaptive_plan.c_str());
+    }
+    return 0;
+#endif
+}
+
+REGISTER_BENCHMARK("transfer_policy", transferPolicy, 5);
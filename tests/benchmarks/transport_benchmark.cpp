@@ -0,0 +1,79 @@
+// Round trip latency of a small request to a local backend, over TCP and over a unix domain socket.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+#include "benchmark.h"
+#include "mock_backend.h"
+#include "main_api_connection.h"
+
+static void reportLatency(const char *transport, std::vector<double> &samples_us)
+{
+    std::sort(samples_us.begin(), samples_us.end());
+    double median = samples_us[samples_us.size() / 2];
+    double p99 = samples_us[std::min(samples_us.size() - 1, samples_us.size() * 99 / 100)];
+    std::printf("%-4s %zu requests  median %8.1f us  p99 %8.1f us\n", transport, samples_us.size(), median, p99);
+}
+
+static bool measure(const ApiConnection &api_connection, int count, std::vector<double> &out_samples_us)
+{
+    // first request pays for name resolution and the curl setup, keep it out of the numbers
+    if (!api_connection.isBackendRunning())
+        return false;
+
+    out_samples_us.clear();
+    for (int i = 0; i < count; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        if (!api_connection.isBackendRunning())
+            return false;
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        out_samples_us.push_back(std::chrono::duration<double, std::micro>(elapsed).count());
+    }
+    return true;
+}
+
+static void addStatusHandler(MockBackend &backend)
+{
+    backend.on("GET", "plugin/status", [](const MockRequest &)
+    {
+        return MockResponse{200, "{\"status\":\"running\"}"};
+    });
+}
+
+static int transportLatency(int count)
+{
+#ifdef _WIN32
+    std::printf("unix domain socket benchmark is not available on Windows\n");
+    return 0;
+#else
+    std::vector<double> samples_us;
+
+    MockBackend tcp_backend;
+    addStatusHandler(tcp_backend);
+    if (!tcp_backend.start() || !measure(ApiConnection(tcp_backend.baseUrl()), count, samples_us))
+    {
+        std::printf("TCP backend unreachable\n");
+        return 1;
+    }
+    reportLatency("TCP", samples_us);
+
+    std::string socket_path = (std::filesystem::temp_directory_path() / ("deepmake_bench_" + std::to_string(getpid()) + ".sock")).string();
+    MockBackend uds_backend;
+    addStatusHandler(uds_backend);
+    if (!uds_backend.startUnix(socket_path) || !measure(ApiConnection(uds_backend.baseUrl(), socket_path), count, samples_us))
+    {
+        std::printf("unix socket backend unreachable\n");
+        return 1;
+    }
+    reportLatency("UDS", samples_us);
+    return 0;
+#endif
+}
+
+REGISTER_BENCHMARK("transport", transportLatency, 1000);
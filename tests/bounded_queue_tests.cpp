@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include "bounded_queue.h"
+
+using namespace ::testing;
+
+class BoundedQueueTest : public Test
+{
+};
+
+TEST(BoundedQueueTest, ItemsComeOutInOrder)
+{
+    BoundedQueue<int> queue(4);
+    for (int i = 0; i < 4; i++)
+        EXPECT_TRUE(queue.push(i));
+    EXPECT_EQ(queue.size(), 4u);
+
+    int item = -1;
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_TRUE(queue.pop(item));
+        EXPECT_EQ(item, i);
+    }
+    EXPECT_EQ(queue.stallCount(), 0u);
+}
+
+TEST(BoundedQueueTest, FullQueueHoldsTheProducerBack)
+{
+    BoundedQueue<int> queue(2);
+    std::atomic<int> pushed {0};
+    std::thread producer([&]()
+    {
+        for (int i = 0; i < 5; i++)
+        {
+            queue.push(i);
+            pushed++;
+        }
+    });
+
+    while (queue.stallCount() == 0)
+        std::this_thread::yield();
+    // capacity reached, the third push waits for room
+    EXPECT_EQ(pushed, 2);
+    EXPECT_EQ(queue.size(), 2u);
+
+    int item = -1;
+    for (int i = 0; i < 5; i++)
+    {
+        EXPECT_TRUE(queue.pop(item));
+        EXPECT_EQ(item, i);
+    }
+    producer.join();
+    EXPECT_EQ(pushed, 5);
+}
+
+TEST(BoundedQueueTest, CloseDrainsThenFails)
+{
+    BoundedQueue<int> queue(4);
+    queue.push(1);
+    queue.push(2);
+    queue.close();
+    EXPECT_FALSE(queue.push(3));
+
+    int item = 0;
+    EXPECT_TRUE(queue.pop(item));
+    EXPECT_EQ(item, 1);
+    EXPECT_TRUE(queue.pop(item));
+    EXPECT_EQ(item, 2);
+    EXPECT_FALSE(queue.pop(item));
+}
+
+TEST(BoundedQueueTest, CloseWakesAWaitingConsumer)
+{
+    BoundedQueue<int> queue(1);
+    std::atomic<bool> returned {false};
+    std::thread consumer([&]()
+    {
+        int item = 0;
+        EXPECT_FALSE(queue.pop(item));
+        returned = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_FALSE(returned);
+    queue.close();
+    consumer.join();
+    EXPECT_TRUE(returned);
+}
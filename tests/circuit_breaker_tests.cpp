@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include "circuit_breaker.h"
+#include "main_api_connection.h"
+#include "mock_backend.h"
+
+using namespace ::testing;
+
+class CircuitBreakerTest : public Test
+{
+};
+
+TEST(CircuitBreakerTest, OpensAfterConsecutiveFailures)
+{
+    CircuitBreaker breaker(3, std::chrono::seconds(5));
+    auto now = CircuitBreaker::Clock::now();
+
+    breaker.recordFailure(now);
+    breaker.recordFailure(now);
+    breaker.recordSuccess();
+    breaker.recordFailure(now);
+    breaker.recordFailure(now);
+    EXPECT_EQ(breaker.state(), CircuitBreaker::State::Closed);
+    EXPECT_TRUE(breaker.allowRequest(now));
+
+    breaker.recordFailure(now);
+    EXPECT_EQ(breaker.state(), CircuitBreaker::State::Open);
+    EXPECT_TRUE(breaker.isOpen(now));
+    EXPECT_FALSE(breaker.allowRequest(now + std::chrono::seconds(1)));
+}
+
+TEST(CircuitBreakerTest, HalfOpenLetsOneProbeThrough)
+{
+    CircuitBreaker breaker(1, std::chrono::seconds(5));
+    auto now = CircuitBreaker::Clock::now();
+    breaker.recordFailure(now);
+
+    auto later = now + std::chrono::seconds(6);
+    EXPECT_FALSE(breaker.isOpen(later));
+    EXPECT_TRUE(breaker.allowRequest(later));
+    EXPECT_EQ(breaker.state(), CircuitBreaker::State::HalfOpen);
+    EXPECT_FALSE(breaker.allowRequest(later));
+
+    // a failed probe opens it for another cooldown
+    breaker.recordFailure(later);
+    EXPECT_TRUE(breaker.isOpen(later + std::chrono::seconds(1)));
+
+    auto even_later = later + std::chrono::seconds(6);
+    EXPECT_TRUE(breaker.allowRequest(even_later));
+    breaker.recordSuccess();
+    EXPECT_EQ(breaker.state(), CircuitBreaker::State::Closed);
+    EXPECT_TRUE(breaker.allowRequest(even_later));
+}
+
+#ifndef _WIN32
+TEST(CircuitBreakerTest, FailingBackendIsNotCalledOnceOpen)
+{
+    MockBackend backend;
+    ASSERT_TRUE(backend.start());
+    backend.on("GET", "data/retrieve", [](const MockRequest &)
+    {
+        return MockResponse{503, "{}"};
+    });
+    backend.on("GET", "plugin/status", [](const MockRequest &)
+    {
+        return MockResponse{200, "{}"};
+    });
+
+    ApiConnection api_connection(backend.baseUrl());
+    for (int i = 0; i < 3; i++)
+        EXPECT_TRUE(api_connection.getData("frame").empty());
+    EXPECT_FALSE(api_connection.isBackendAvailable());
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(api_connection.getData("frame").empty());
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+    EXPECT_EQ(backend.requestCount("data/retrieve"), 3u);
+
+    // the status probe still goes out and closes the breaker when the backend answers
+    EXPECT_TRUE(api_connection.isBackendRunning());
+    EXPECT_TRUE(api_connection.isBackendAvailable());
+}
+
+TEST(CircuitBreakerTest, DialogsAreNotCountedByTheBreaker)
+{
+    MockBackend backend;
+    ASSERT_TRUE(backend.start());
+    backend.on("GET", "ui/configure/", [](const MockRequest &)
+    {
+        return MockResponse{503, "{}"};
+    });
+    backend.on("GET", "data/retrieve", [](const MockRequest &)
+    {
+        return MockResponse{503, "{}"};
+    });
+
+    ApiConnection api_connection(backend.baseUrl());
+    for (int i = 0; i < 3; i++)
+        api_connection.openConfigMenu("Dummy");
+    EXPECT_TRUE(api_connection.isBackendAvailable());
+
+    for (int i = 0; i < 3; i++)
+        EXPECT_TRUE(api_connection.getData("frame").empty());
+    EXPECT_FALSE(api_connection.isBackendAvailable());
+
+    // the user can still open the dialog while renders are held back
+    api_connection.openConfigMenu("Dummy");
+    EXPECT_EQ(backend.requestCount("ui/configure/"), 4u);
+}
+#endif
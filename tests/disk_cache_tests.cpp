@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <filesystem>
+#include "images/disk_result_cache.h"
+#include "images/image_utils.h"
+#include "images/image_buffer.h"
+#include "main_api_connection.h"
+#include "mock_backend.h"
+
+using namespace ::testing;
+
+class DiskResultCacheTest : public Test
+{
+protected:
+    void SetUp() override
+    {
+        m_directory = (std::filesystem::temp_directory_path() / "deepmake_disk_cache_test").string();
+        std::filesystem::remove_all(m_directory);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(m_directory);
+    }
+
+    std::string m_directory;
+};
+
+TEST_F(DiskResultCacheTest, StoreAndReload)
+{
+    {
+        DiskResultCache cache(m_directory, 1024);
+        EXPECT_TRUE(cache.store(1, "first result"));
+        EXPECT_TRUE(cache.store(2, "second result"));
+
+        std::string data;
+        EXPECT_TRUE(cache.load(1, data));
+        EXPECT_EQ(data, "first result");
+        EXPECT_FALSE(cache.load(3, data));
+    }
+
+    // a new session picks up what the previous one left
+    DiskResultCache cache(m_directory, 1024);
+    EXPECT_EQ(cache.size(), 2u);
+    std::string data;
+    EXPECT_TRUE(cache.load(2, data));
+    EXPECT_EQ(data, "second result");
+}
+
+TEST_F(DiskResultCacheTest, EvictsOldestOverCap)
+{
+    DiskResultCache cache(m_directory, 100);
+    std::string payload(40, 'x');
+    cache.store(1, payload);
+    cache.store(2, payload);
+
+    std::string data;
+    EXPECT_TRUE(cache.load(1, data));
+    cache.store(3, payload);
+
+    EXPECT_TRUE(cache.load(1, data));
+    EXPECT_FALSE(cache.load(2, data));
+    EXPECT_TRUE(cache.load(3, data));
+    EXPECT_LE(cache.totalBytes(), 100u);
+
+    // only the two live results and the index stay on disk
+    size_t files = 0;
+    for (const auto &entry : std::filesystem::directory_iterator(m_directory))
+    {
+        (void)entry;
+        files++;
+    }
+    EXPECT_EQ(files, 3u);
+}
+
+TEST_F(DiskResultCacheTest, DropsMissingAndOrphanedFiles)
+{
+    {
+        DiskResultCache cache(m_directory, 1024);
+        cache.store(1, "first result");
+        cache.store(2, "second result");
+    }
+    std::filesystem::remove(std::filesystem::path(m_directory) / "0000000000000001.img");
+    {
+        std::ofstream orphan(std::filesystem::path(m_directory) / "orphan.img");
+        orphan << "junk";
+    }
+
+    DiskResultCache cache(m_directory, 1024);
+    EXPECT_EQ(cache.size(), 1u);
+    EXPECT_FALSE(std::filesystem::exists(std::filesystem::path(m_directory) / "orphan.img"));
+}
+
+#ifndef _WIN32
+TEST_F(DiskResultCacheTest, DecodedHitStillHandsOutTheEncodedResult)
+{
+    std::shared_ptr<ImageBuffer> image = std::make_shared<ImageBuffer>();
+    image->init(2, 2, ImageFormat::RGBA8, ChannelOrder::RGBA);
+    fillImage(image, Color(1.0, 0, 0));
+    std::string encoded = encodeImage(image, ImageCodec::PNG);
+
+    MockBackend backend;
+    backend.on("GET", "image/get/", [encoded](const MockRequest &)
+    {
+        return MockResponse{200, encoded, "image/png"};
+    });
+    ASSERT_TRUE(backend.start());
+    ApiConnection api_connection(backend.baseUrl());
+
+    // drawn first, nobody wanted the encoded bytes then
+    ASSERT_NE(api_connection.getImage("result"), nullptr);
+    std::string first;
+    ASSERT_NE(api_connection.getImage("result", &first), nullptr);
+    EXPECT_EQ(first, encoded);
+    EXPECT_EQ(backend.requestCount("image/get/"), 2u);
+
+    // kept with the decoded image from then on
+    std::string second;
+    ASSERT_NE(api_connection.getImage("result", &second), nullptr);
+    EXPECT_EQ(second, encoded);
+    EXPECT_EQ(backend.requestCount("image/get/"), 2u);
+}
+#endif
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "endpoint_request_builder.h"
+
+using namespace ::testing;
+
+class EndpointRequestBuilderTest : public Test
+{
+};
+
+TEST(EndpointRequestBuilderTest, SortsKeysAndEscapesStrings)
+{
+    EndpointRequestBuilder request;
+    request.addInt("width", 512);
+    request.addString("prompt", "a \"quoted\" cat\non two lines");
+    request.addBool("skin", true);
+    request.addFloat("guidance_scale", 7.5f);
+    request.addStringList("img_before", {"a", "b"});
+
+    EXPECT_EQ(request.json(), "{\"guidance_scale\":7.5,\"img_before\":[\"a\",\"b\"],"
+                              "\"prompt\":\"a \\\"quoted\\\" cat\\non two lines\",\"skin\":true,\"width\":512}");
+}
+
+TEST(EndpointRequestBuilderTest, HashIgnoresInsertionOrder)
+{
+    EndpointRequestBuilder first;
+    first.addInt("height", 512);
+    first.addFloat("strength", 0.1f);
+
+    EndpointRequestBuilder second;
+    second.addFloat("strength", 0.1f);
+    second.addInt("height", 512);
+
+    EXPECT_EQ(first.json(), second.json());
+    EXPECT_EQ(first.hash(), second.hash());
+
+    second.addInt("height", 513);
+    EXPECT_NE(first.hash(), second.hash());
+}
+
+TEST(EndpointRequestBuilderTest, ReusedAfterClear)
+{
+    EndpointRequestBuilder request;
+    request.addString("prompt", "first");
+    request.addInt("seed", 1);
+    uint64_t first_hash = request.hash();
+
+    request.clear();
+    EXPECT_EQ(request.json(), "{}");
+
+    request.addString("prompt", "first");
+    request.addInt("seed", 1);
+    EXPECT_EQ(request.hash(), first_hash);
+    EXPECT_EQ(request.fieldCount(), 2);
+}
+
+TEST(EndpointRequestBuilderTest, TypeIsPartOfTheHash)
+{
+    EndpointRequestBuilder as_int;
+    as_int.addInt("value", 1);
+
+    EndpointRequestBuilder as_bool;
+    as_bool.addBool("value", true);
+
+    EXPECT_NE(as_int.hash(), as_bool.hash());
+}
+
+TEST(EndpointRequestBuilderTest, HashDoesNotDependOnWritingJson)
+{
+    // far more than the 1K of params the sequence data used to hold
+    EndpointRequestBuilder request;
+    for (int i = 0; i < 200; i++)
+        request.addFloat("input_" + std::to_string(i), i * 0.25f);
+    uint64_t before = request.hash();
+
+    EXPECT_GT(request.json().size(), 1024);
+    EXPECT_EQ(request.hash(), before);
+
+    request.addFloat("input_7", 100.0f);
+    EXPECT_NE(request.hash(), before);
+}
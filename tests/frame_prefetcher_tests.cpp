@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include "frame_prefetcher.h"
+
+using namespace ::testing;
+
+class FramePrefetcherTest : public Test
+{
+};
+
+TEST(FramePrefetcherTest, StableOnlyOnceParamsRepeat)
+{
+    FramePrefetcher prefetcher(10.0, 8, 1);
+    EXPECT_FALSE(prefetcher.paramsStable(1, 0xaa));
+    EXPECT_TRUE(prefetcher.paramsStable(1, 0xaa));
+    EXPECT_FALSE(prefetcher.paramsStable(1, 0xbb));
+    // instances are tracked apart
+    EXPECT_FALSE(prefetcher.paramsStable(2, 0xbb));
+    EXPECT_TRUE(prefetcher.paramsStable(1, 0xbb));
+}
+
+TEST(FramePrefetcherTest, DepthFollowsThroughput)
+{
+    FramePrefetcher prefetcher(10.0, 8, 1);
+    // nothing measured yet, just the next frame
+    EXPECT_EQ(prefetcher.depth(), 1);
+
+    prefetcher.recordJobTime(5.0);
+    EXPECT_EQ(prefetcher.depth(), 2);
+
+    // a faster backend is worth looking further ahead, up to the cap
+    for (int i = 0; i < 20; i++)
+        prefetcher.recordJobTime(0.5);
+    EXPECT_EQ(prefetcher.depth(), 8);
+
+    // and a slow one pulls it back in
+    for (int i = 0; i < 20; i++)
+        prefetcher.recordJobTime(20.0);
+    EXPECT_EQ(prefetcher.depth(), 1);
+}
+
+TEST(FramePrefetcherTest, DepthScalesWithWorkers)
+{
+    FramePrefetcher prefetcher(10.0, 8, 2);
+    prefetcher.recordJobTime(5.0);
+    EXPECT_EQ(prefetcher.depth(), 4);
+}
+
+TEST(FramePrefetcherTest, FramesAreHandedOutOnce)
+{
+    FramePrefetcher prefetcher(10.0, 8, 1);
+    prefetcher.recordJobTime(2.5); // 4 frames ahead
+    prefetcher.paramsStable(1, 0xaa);
+
+    EXPECT_EQ(prefetcher.framesToPrefetch(1, 0xaa, 10, 100), (std::vector<int>{11, 12, 13, 14}));
+    // the playhead moved on a frame, only the newly uncovered one is left
+    EXPECT_EQ(prefetcher.framesToPrefetch(1, 0xaa, 11, 100), (std::vector<int>{15}));
+    // never past the end of the clip
+    EXPECT_EQ(prefetcher.framesToPrefetch(1, 0xaa, 14, 16), (std::vector<int>{16}));
+    // params that aren't the instance's current ones get nothing
+    EXPECT_TRUE(prefetcher.framesToPrefetch(1, 0xbb, 20, 100).empty());
+
+    // new params start over
+    prefetcher.paramsStable(1, 0xbb);
+    EXPECT_EQ(prefetcher.framesToPrefetch(1, 0xbb, 11, 100), (std::vector<int>{12, 13, 14, 15}));
+
+    prefetcher.forget(1);
+    EXPECT_TRUE(prefetcher.framesToPrefetch(1, 0xbb, 11, 100).empty());
+}
@@ -238,3 +238,74 @@ TEST(ImageUtilsTest, TestGreyScaleToARGB) {
     EXPECT_EQ(img_ptr[8], 128);
     EXPECT_EQ(img_ptr[12], 128);
 }
+
+TEST(ImageUtilsTest, TestContentHash) {
+
+    std::shared_ptr<ImageBuffer> img = std::make_shared<ImageBuffer>();
+    img->init(4, 4, ImageFormat::RGBA8, ChannelOrder::RGBA);
+    fillImage(img, Color(1.0, 0, 0));
+
+    std::shared_ptr<ImageBuffer> same = std::make_shared<ImageBuffer>();
+    same->init(4, 4, ImageFormat::RGBA8, ChannelOrder::RGBA);
+    fillImage(same, Color(1.0, 0, 0));
+    EXPECT_EQ(imageContentHash(img), imageContentHash(same));
+
+    static_cast<uint8_t *>(same->data())[5] ^= 1;
+    EXPECT_NE(imageContentHash(img), imageContentHash(same));
+
+    std::shared_ptr<ImageBuffer> bgra = std::make_shared<ImageBuffer>();
+    bgra->init(4, 4, ImageFormat::RGBA8, ChannelOrder::BGRA);
+    memcpy(bgra->data(), img->data(), img->height() * img->strideBytes());
+    EXPECT_NE(imageContentHash(img), imageContentHash(bgra));
+}
+
+TEST(ImageUtilsTest, TestDownscaleImage) {
+
+    std::shared_ptr<ImageBuffer> argb = std::make_shared<ImageBuffer>();
+    argb->init(5, 4, ImageFormat::RGBA8, ChannelOrder::ARGB);
+    fillImage(argb, Color(1.0, 0, 0));
+
+    // packed RGBA whatever the host's layout, the odd column left over is dropped
+    ArkImagePtr half = downscaleImage(argb, 2);
+    ASSERT_TRUE(half);
+    EXPECT_EQ(half->width(), 2);
+    EXPECT_EQ(half->height(), 2);
+    EXPECT_EQ(half->format(), ImageFormat::RGBA8);
+    EXPECT_EQ(half->channelOrder(), ChannelOrder::RGBA);
+    const uint8_t *pixel = static_cast<const uint8_t *>(half->data());
+    EXPECT_EQ(pixel[0], 255);
+    EXPECT_EQ(pixel[1], 0);
+    EXPECT_EQ(pixel[2], 0);
+
+    // blocks are averaged
+    std::shared_ptr<ImageBuffer> stripes = std::make_shared<ImageBuffer>();
+    stripes->init(2, 2, ImageFormat::RGBA8, ChannelOrder::RGBA);
+    uint8_t *data = static_cast<uint8_t *>(stripes->data());
+    memset(data, 0, stripes->height() * stripes->strideBytes());
+    data[0] = 200;
+    data[4] = 100;
+    ArkImagePtr averaged = downscaleImage(stripes, 2);
+    ASSERT_TRUE(averaged);
+    EXPECT_EQ(static_cast<const uint8_t *>(averaged->data())[0], 75);
+
+    // nothing to shrink still hands back a copy of our own
+    ArkImagePtr same = downscaleImage(stripes, 1);
+    ASSERT_TRUE(same);
+    EXPECT_NE(same->data(), stripes->data());
+    EXPECT_EQ(imageContentHash(same), imageContentHash(stripes));
+}
+
+TEST(ImageUtilsTest, TestResizeUpKeepsEdges) {
+
+    std::shared_ptr<ImageBuffer> small = std::make_shared<ImageBuffer>();
+    small->init(2, 2, ImageFormat::RGBA8, ChannelOrder::RGBA);
+    fillImage(small, Color(0.2f, 0.6f, 1.0f));
+
+    std::unique_ptr<ArkImage> large(resizeImageUp(small.get(), 5, 5));
+    ASSERT_TRUE(large);
+    EXPECT_EQ(large->width(), 5);
+    EXPECT_EQ(large->height(), 5);
+    // the last pixel only blends with pixels inside the image
+    const uint8_t *last = static_cast<const uint8_t *>(large->data()) + 4 * large->strideBytes() + 4 * 4;
+    EXPECT_EQ(memcmp(last, small->data(), 4), 0);
+}
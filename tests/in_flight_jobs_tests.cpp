@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <future>
+#include <thread>
+#include "in_flight_jobs.h"
+#include "main_api_connection.h"
+#include "mock_backend.h"
+
+using namespace ::testing;
+
+class InFlightJobsTest : public Test
+{
+};
+
+TEST(InFlightJobsTest, NewParamsSupersedeOlderJobs)
+{
+    InFlightJobs jobs;
+    jobs.supersede(1, 0xaa);
+    EXPECT_TRUE(jobs.add(1, 0xaa, "job_1"));
+    EXPECT_TRUE(jobs.add(1, 0xaa, "job_2"));
+    EXPECT_TRUE(jobs.add(2, 0xaa, "job_3"));
+    EXPECT_EQ(jobs.count(1), 2u);
+
+    // same params again leaves them alone
+    EXPECT_EQ(jobs.supersede(1, 0xaa), 0u);
+    // other instances keep theirs
+    EXPECT_EQ(jobs.supersede(1, 0xbb), 2u);
+    EXPECT_TRUE(jobs.waitSuperseded(1, "job_1", std::chrono::milliseconds(0)));
+    EXPECT_FALSE(jobs.waitSuperseded(2, "job_3", std::chrono::milliseconds(0)));
+    // only counted once
+    EXPECT_EQ(jobs.supersede(1, 0xcc), 0u);
+    EXPECT_EQ(jobs.supersededCount(), 2u);
+
+    jobs.remove(1, "job_1");
+    jobs.remove(1, "job_2");
+    EXPECT_EQ(jobs.count(1), 0u);
+    EXPECT_EQ(jobs.count(2), 1u);
+}
+
+TEST(InFlightJobsTest, StaleJobsAreNotStarted)
+{
+    InFlightJobs jobs;
+    // nothing rendered yet, anything goes
+    EXPECT_TRUE(jobs.isCurrent(1, 0xaa));
+
+    jobs.supersede(1, 0xbb);
+    EXPECT_FALSE(jobs.isCurrent(1, 0xaa));
+    EXPECT_TRUE(jobs.isCurrent(1, 0xbb));
+    EXPECT_FALSE(jobs.add(1, 0xaa, "job_1"));
+    EXPECT_EQ(jobs.count(1), 0u);
+    EXPECT_EQ(jobs.supersededCount(), 1u);
+}
+
+TEST(InFlightJobsTest, PollingWakesUpWhenSuperseded)
+{
+    InFlightJobs jobs;
+    jobs.supersede(1, 0xaa);
+    ASSERT_TRUE(jobs.add(1, 0xaa, "job_1"));
+
+    auto start = std::chrono::steady_clock::now();
+    std::future<bool> poll = std::async(std::launch::async, [&]()
+    {
+        return jobs.waitSuperseded(1, "job_1", std::chrono::seconds(10));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    jobs.supersede(1, 0xbb);
+    EXPECT_TRUE(poll.get());
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+
+    // untracked jobs wait out the timeout
+    EXPECT_FALSE(jobs.waitSuperseded(1, "job_2", std::chrono::milliseconds(10)));
+}
+
+#ifndef _WIN32
+TEST(InFlightJobsTest, CancelReachesTheBackend)
+{
+    MockBackend backend;
+    backend.on("DELETE", "job/", [](const MockRequest &)
+    {
+        return MockResponse{200, "{\"status\":\"Cancelled\"}"};
+    });
+    ASSERT_TRUE(backend.start());
+    ApiConnection api_connection(backend.baseUrl());
+
+    EXPECT_TRUE(api_connection.cancelJob("job_1"));
+    EXPECT_EQ(backend.requestCount("job/job_1"), 1u);
+    EXPECT_TRUE(api_connection.jobCancelSupported());
+}
+
+TEST(InFlightJobsTest, BackendWithoutCancelIsRemembered)
+{
+    MockBackend backend;
+    backend.on("DELETE", "job/", [](const MockRequest &)
+    {
+        return MockResponse{405, "{\"detail\":\"Method Not Allowed\"}"};
+    });
+    ASSERT_TRUE(backend.start());
+    ApiConnection api_connection(backend.baseUrl());
+
+    EXPECT_FALSE(api_connection.cancelJob("job_1"));
+    EXPECT_FALSE(api_connection.jobCancelSupported());
+    // not asked again, superseded jobs are only left alone from now on
+    EXPECT_FALSE(api_connection.cancelJob("job_2"));
+    EXPECT_EQ(backend.requestCount("job/"), 1u);
+}
+#endif
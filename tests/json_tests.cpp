@@ -163,3 +163,87 @@ TEST(JsonParsingTest, ParseBisinetJson) {
     EXPECT_EQ(plugin.endpoints[0].has_prompt, false);
     EXPECT_EQ(plugin.endpoints[0].outputIsMask(), true);
 }
+
+TEST(JsonParsingTest, ReportsMalformedJson) {
+    ArkPlugin plugin;
+    PluginJsonParser configParser;
+    EXPECT_FALSE(configParser.parsePluginInfo("{\"plugin\": {", plugin));
+    EXPECT_EQ(configParser.lastError().code, JsonError::Syntax);
+
+    EXPECT_FALSE(configParser.parsePluginInfo("[1, 2]", plugin));
+    EXPECT_EQ(configParser.lastError().code, JsonError::NotObject);
+}
+
+TEST(JsonParsingTest, ReportsMissingAndMistypedFields) {
+    ArkPlugin plugin;
+    PluginJsonParser configParser;
+
+    std::string no_author = sGetInfoJson;
+    no_author.replace(no_author.find("\"Author\""), 8, "\"Writer\"");
+    EXPECT_FALSE(configParser.parsePluginInfo(no_author, plugin));
+    EXPECT_EQ(configParser.lastError().code, JsonError::MissingField);
+    EXPECT_EQ(configParser.lastError().field, "plugin.Author");
+
+    std::string bad_input = sGetInfoJson;
+    bad_input.replace(bad_input.find("\"Text\""), 6, "42");
+    EXPECT_FALSE(configParser.parsePluginInfo(bad_input, plugin));
+    EXPECT_EQ(configParser.lastError().code, JsonError::WrongType);
+    EXPECT_EQ(configParser.lastError().field, "endpoints.generate_image.inputs.prompt");
+
+    // a good parse clears the previous error
+    EXPECT_TRUE(configParser.parsePluginInfo(sGetInfoJson, plugin));
+    EXPECT_EQ(configParser.lastError().code, JsonError::None);
+}
+
+TEST(JsonParsingTest, ConfigHashCoversUnparsedSettings) {
+    PluginJsonParser parser;
+    ArkPlugin plugin;
+    ASSERT_TRUE(parser.parsePluginInfo(sGetInfoJson, plugin));
+    EXPECT_NE(plugin.config.hash, 0u);
+
+    // loras aren't parsed, but they change the output all the same
+    const std::string no_loras = "\"loras\": []";
+    std::string with_lora = sGetInfoJson;
+    with_lora.replace(with_lora.find(no_loras), no_loras.size(), "\"loras\": [\"detail\"]");
+    ArkPlugin lora_plugin;
+    ASSERT_TRUE(parser.parsePluginInfo(with_lora, lora_plugin));
+    EXPECT_EQ(lora_plugin.config.model_name, plugin.config.model_name);
+    EXPECT_NE(lora_plugin.config.hash, plugin.config.hash);
+
+    ArkPlugin same_plugin;
+    ASSERT_TRUE(parser.parsePluginInfo(sGetInfoJson, same_plugin));
+    EXPECT_EQ(same_plugin.config.hash, plugin.config.hash);
+}
+
+TEST(JsonParsingTest, ParseResponses) {
+    PluginJsonParser parser;
+
+    std::string img_id;
+    EXPECT_TRUE(parser.parseUploadImageResponse("{\"status\": \"Success\", \"image_id\": \"abc\"}", img_id));
+    EXPECT_EQ(img_id, "abc");
+    EXPECT_FALSE(parser.parseUploadImageResponse("{\"status\": \"Failed\"}", img_id));
+    EXPECT_EQ(parser.lastError().code, JsonError::Rejected);
+
+    ExecuteResponse execute;
+    EXPECT_FALSE(parser.parseExecuteResponse("{\"job_id\": 7}", execute));
+    EXPECT_EQ(parser.lastError().code, JsonError::WrongType);
+
+    JobStatusResponse job;
+    EXPECT_TRUE(parser.parseJobResponse("{\"status\": \"Success\", \"output_mask\": \"mask\"}", job));
+    EXPECT_EQ(job.status, JOB_STATUS_SUCCESS);
+    EXPECT_EQ(job.img_id, "mask");
+
+    BatchFrameResult batch_frame;
+    EXPECT_TRUE(parser.parseBatchFrameResponse("{\"frame\": 12, \"status\": \"Success\", \"output_img\": \"img\"}", batch_frame));
+    EXPECT_EQ(batch_frame.frame, 12);
+    EXPECT_EQ(batch_frame.status, JOB_STATUS_SUCCESS);
+    EXPECT_EQ(batch_frame.img_id, "img");
+    EXPECT_FALSE(parser.parseBatchFrameResponse("{\"frame\": \"12\", \"status\": \"Success\"}", batch_frame));
+    EXPECT_EQ(parser.lastError().code, JsonError::WrongType);
+
+    std::vector<std::string> plugins;
+    EXPECT_TRUE(parser.parsePluginList("{\"plugins\": [\"sd\", \"bisenet\"]}", plugins));
+    EXPECT_EQ(plugins, (std::vector<std::string>{"sd", "bisenet"}));
+    EXPECT_FALSE(parser.parsePluginList("{\"plugins\": {}}", plugins));
+    EXPECT_EQ(parser.lastError().code, JsonError::WrongType);
+}
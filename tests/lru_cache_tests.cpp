@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include "lru_cache.h"
+#include "hash_utils.h"
+
+using namespace ::testing;
+
+class LruCacheTest : public Test
+{
+};
+
+TEST(LruCacheTest, EvictsLeastRecentlyUsed)
+{
+    LruCache<int, std::string> cache(2);
+    cache.put(1, "one");
+    cache.put(2, "two");
+
+    std::string value;
+    EXPECT_TRUE(cache.get(1, value));
+    EXPECT_EQ(value, "one");
+
+    cache.put(3, "three");
+    EXPECT_TRUE(cache.contains(1));
+    EXPECT_FALSE(cache.contains(2));
+    EXPECT_TRUE(cache.contains(3));
+    EXPECT_EQ(cache.size(), 2u);
+}
+
+TEST(LruCacheTest, CostBudget)
+{
+    LruCache<int, int> cache(100);
+    cache.put(1, 1, 60);
+    cache.put(2, 2, 30);
+    EXPECT_EQ(cache.totalCost(), 90u);
+
+    cache.put(3, 3, 20);
+    EXPECT_FALSE(cache.contains(1));
+    EXPECT_EQ(cache.totalCost(), 50u);
+
+    // bigger than the whole budget, never stored
+    cache.put(4, 4, 200);
+    EXPECT_FALSE(cache.contains(4));
+
+    cache.put(2, 22, 10);
+    EXPECT_EQ(cache.totalCost(), 30u);
+    EXPECT_TRUE(cache.erase(2));
+    EXPECT_EQ(cache.totalCost(), 20u);
+}
+
+TEST(LruCacheTest, Hash64)
+{
+    std::string text = "deepmake";
+    EXPECT_EQ(hash64(text), hash64(text.data(), text.size()));
+    EXPECT_NE(hash64(text), hash64(std::string("deepmakE")));
+    EXPECT_NE(hash64(text), hash64(text, 1));
+    EXPECT_NE(hashCombine(1, 2), hashCombine(2, 1));
+}
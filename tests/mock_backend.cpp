@@ -0,0 +1,312 @@
+#include "mock_backend.h"
+#include <cstring>
+#include <sstream>
+#include <algorithm>
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+static std::string statusText(int status)
+{
+    switch (status)
+    {
+        case 200: return "OK";
+        case 304: return "Not Modified";
+        case 404: return "Not Found";
+        case 413: return "Payload Too Large";
+        case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
+        default: return "Status";
+    }
+}
+
+MockBackend::MockBackend() = default;
+
+MockBackend::~MockBackend()
+{
+    stop();
+}
+
+#ifndef _WIN32
+
+bool MockBackend::start()
+{
+    m_listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (m_listen_fd < 0)
+        return false;
+
+    int reuse = 1;
+    setsockopt(m_listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if (bind(m_listen_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+        listen(m_listen_fd, 64) != 0)
+    {
+        close(m_listen_fd);
+        m_listen_fd = -1;
+        return false;
+    }
+
+    socklen_t addr_len = sizeof(addr);
+    getsockname(m_listen_fd, reinterpret_cast<sockaddr *>(&addr), &addr_len);
+    m_port = ntohs(addr.sin_port);
+
+    m_running = true;
+    m_thread = std::thread(&MockBackend::serve, this);
+    return true;
+}
+
+bool MockBackend::startUnix(const std::string &socket_path)
+{
+    sockaddr_un addr {};
+    if (socket_path.size() >= sizeof(addr.sun_path))
+        return false;
+
+    m_listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_listen_fd < 0)
+        return false;
+
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(socket_path.c_str());
+    if (bind(m_listen_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+        listen(m_listen_fd, 64) != 0)
+    {
+        close(m_listen_fd);
+        m_listen_fd = -1;
+        return false;
+    }
+
+    m_socket_path = socket_path;
+    m_running = true;
+    m_thread = std::thread(&MockBackend::serve, this);
+    return true;
+}
+
+void MockBackend::stop()
+{
+    if (!m_running)
+        return;
+
+    m_running = false;
+    if (m_thread.joinable())
+        m_thread.join();
+    for (auto &worker : m_workers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+    m_workers.clear();
+    close(m_listen_fd);
+    m_listen_fd = -1;
+    if (!m_socket_path.empty())
+    {
+        unlink(m_socket_path.c_str());
+        m_socket_path.clear();
+    }
+}
+
+void MockBackend::serve()
+{
+    while (m_running)
+    {
+        pollfd poll_fd {m_listen_fd, POLLIN, 0};
+        if (poll(&poll_fd, 1, 50) <= 0)
+            continue;
+
+        int fd = accept(m_listen_fd, nullptr, nullptr);
+        if (fd < 0)
+            continue;
+        // a thread per connection so tests can have requests in flight at the same time
+        m_workers.emplace_back(&MockBackend::handleConnection, this, fd);
+    }
+}
+
+void MockBackend::handleConnection(int fd)
+{
+    std::string data;
+    char buffer[16384];
+    size_t header_end = std::string::npos;
+    while (header_end == std::string::npos)
+    {
+        ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0)
+        {
+            close(fd);
+            return;
+        }
+        m_bytes_received += static_cast<size_t>(received);
+        data.append(buffer, static_cast<size_t>(received));
+        header_end = data.find("\r\n\r\n");
+    }
+
+    MockRequest request;
+    std::istringstream header_stream(data.substr(0, header_end));
+    std::string line;
+    std::getline(header_stream, line);
+    std::istringstream request_line(line);
+    std::string target;
+    request_line >> request.method >> target;
+    request.path = target.empty() ? target : target.substr(1);
+
+    size_t content_length = 0;
+    while (std::getline(header_stream, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        size_t colon = line.find(':');
+        if (colon == std::string::npos)
+            continue;
+        std::string name = line.substr(0, colon);
+        std::string value = line.substr(colon + 1);
+        value.erase(0, value.find_first_not_of(' '));
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        request.headers[name] = value;
+        if (name == "content-length")
+            content_length = std::stoul(value);
+    }
+
+    request.body = data.substr(header_end + 4);
+    while (request.body.size() < content_length)
+    {
+        ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0)
+            break;
+        m_bytes_received += static_cast<size_t>(received);
+        throttle(static_cast<size_t>(received));
+        request.body.append(buffer, static_cast<size_t>(received));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_request_paths.push_back(request.path);
+    }
+
+    MockResponse response = dispatch(request);
+    if (m_latency_ms > 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(m_latency_ms));
+
+    std::string header = "HTTP/1.1 " + std::to_string(response.status) + " " + statusText(response.status) + "\r\n";
+    header += "Content-Type: " + response.content_type + "\r\n";
+    if (!response.stream)
+        header += "Content-Length: " + std::to_string(response.body.size()) + "\r\n";
+    for (const auto &extra : response.headers)
+        header += extra.first + ": " + extra.second + "\r\n";
+    header += "Connection: close\r\n\r\n";
+
+    bool sent_all = sendAll(fd, header + response.body);
+    if (response.stream)
+    {
+        std::string chunk;
+        bool more = true;
+        while (sent_all && more)
+        {
+            chunk.clear();
+            more = response.stream(chunk);
+            sent_all = sendAll(fd, chunk);
+        }
+    }
+    close(fd);
+}
+
+bool MockBackend::sendAll(int fd, const std::string &out)
+{
+    char buffer[16384];
+    size_t sent_total = 0;
+    while (sent_total < out.size())
+    {
+        size_t chunk = std::min<size_t>(out.size() - sent_total, sizeof(buffer));
+        ssize_t sent = send(fd, out.data() + sent_total, chunk, MSG_NOSIGNAL);
+        if (sent <= 0)
+            return false;
+        sent_total += static_cast<size_t>(sent);
+        m_bytes_sent += static_cast<size_t>(sent);
+        throttle(static_cast<size_t>(sent));
+    }
+    return true;
+}
+
+#else
+
+bool MockBackend::start() { return false; }
+bool MockBackend::startUnix(const std::string &) { return false; }
+void MockBackend::stop() {}
+void MockBackend::serve() {}
+void MockBackend::handleConnection(int) {}
+bool MockBackend::sendAll(int, const std::string &) { return false; }
+
+#endif
+
+void MockBackend::on(const std::string &method, const std::string &path_prefix, MockHandler handler)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_handlers[{method, path_prefix}] = std::move(handler);
+}
+
+MockResponse MockBackend::dispatch(const MockRequest &request)
+{
+    MockHandler handler;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t best_length = 0;
+        for (const auto &entry : m_handlers)
+        {
+            const std::string &prefix = entry.first.second;
+            if (entry.first.first == request.method &&
+                request.path.compare(0, prefix.size(), prefix) == 0 &&
+                (!handler || prefix.size() > best_length))
+            {
+                handler = entry.second;
+                best_length = prefix.size();
+            }
+        }
+    }
+
+    if (!handler)
+    {
+        MockResponse not_found;
+        not_found.status = 404;
+        not_found.body = "{\"detail\":\"Not Found\"}";
+        return not_found;
+    }
+    return handler(request);
+}
+
+void MockBackend::throttle(size_t bytes)
+{
+    size_t bandwidth = m_bandwidth;
+    if (bandwidth > 0)
+        std::this_thread::sleep_for(std::chrono::microseconds(bytes * 1000000 / bandwidth));
+}
+
+std::string MockBackend::baseUrl() const
+{
+    if (!m_socket_path.empty())
+        return "http://localhost/";
+    return "http://127.0.0.1:" + std::to_string(m_port) + "/";
+}
+
+size_t MockBackend::requestCount(const std::string &path_prefix) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::count_if(m_request_paths.begin(), m_request_paths.end(), [&path_prefix](const std::string &path)
+    {
+        return path.compare(0, path_prefix.size(), path_prefix) == 0;
+    });
+}
+
+void MockBackend::resetCounters()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_request_paths.clear();
+    m_bytes_received = 0;
+    m_bytes_sent = 0;
+}
@@ -0,0 +1,87 @@
+#ifndef MOCK_BACKEND_H
+#define MOCK_BACKEND_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+struct MockRequest
+{
+    std::string method;
+    std::string path; // without the leading slash, same as the ApiConnection urls
+    std::map<std::string, std::string> headers;
+    std::string body;
+};
+
+struct MockResponse
+{
+    int status {200};
+    std::string body;
+    std::string content_type {"application/json"};
+    std::map<std::string, std::string> headers;
+    // when set the body is streamed instead: each chunk is sent as soon as it's returned,
+    // until stream returns false, and closing the connection ends the body
+    std::function<bool(std::string &chunk)> stream;
+};
+
+using MockHandler = std::function<MockResponse(const MockRequest &)>;
+
+// Bare bones HTTP/1.1 server on 127.0.0.1 standing in for the backend in tests.
+// Handlers are matched on method and the longest registered path prefix, every
+// connection is closed after one response. Counts what went through the socket
+// so tests can tell how much data a call actually moved.
+class MockBackend
+{
+public:
+    MockBackend();
+    ~MockBackend();
+
+    bool start();
+    // listens on a unix domain socket instead, baseUrl() then only names the host for the requests
+    bool startUnix(const std::string &socket_path);
+    void stop();
+
+    void on(const std::string &method, const std::string &path_prefix, MockHandler handler);
+
+    // delay applied before every response, and a cap on the speed bodies are read/written at (0 = unlimited)
+    void setLatency(std::chrono::milliseconds latency) { m_latency_ms = latency.count(); }
+    void setBandwidth(size_t bytes_per_second) { m_bandwidth = bytes_per_second; }
+
+    int port() const { return m_port; }
+    std::string baseUrl() const;
+
+    size_t bytesReceived() const { return m_bytes_received; }
+    size_t bytesSent() const { return m_bytes_sent; }
+    size_t requestCount(const std::string &path_prefix = "") const;
+    void resetCounters();
+
+protected:
+    void serve();
+    void handleConnection(int fd);
+    bool sendAll(int fd, const std::string &out);
+    MockResponse dispatch(const MockRequest &request);
+    void throttle(size_t bytes);
+
+    int m_listen_fd {-1};
+    int m_port {0};
+    std::string m_socket_path;
+    std::atomic<bool> m_running {false};
+    std::thread m_thread;
+    std::vector<std::thread> m_workers;
+
+    mutable std::mutex m_mutex;
+    std::map<std::pair<std::string, std::string>, MockHandler> m_handlers;
+    std::vector<std::string> m_request_paths;
+
+    std::atomic<size_t> m_bytes_received {0};
+    std::atomic<size_t> m_bytes_sent {0};
+    std::atomic<long long> m_latency_ms {0};
+    std::atomic<size_t> m_bandwidth {0};
+};
+
+#endif // MOCK_BACKEND_H
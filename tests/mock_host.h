@@ -0,0 +1,93 @@
+#ifndef MOCK_HOST_H
+#define MOCK_HOST_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "video_host_delegate.h"
+#include "images/image_buffer.h"
+
+class MockDrawHelper : public DrawHelper
+{
+public:
+    bool DrawCircle(Point2D, float, Color, float, bool) override { return true; }
+    bool DrawLine(Point2D, Point2D, Color, float) override { return true; }
+};
+
+// Stands in for AE/OFX in tests. Renders frame 0 of a one frame clip at full resolution
+// from a width x height RGBA source into a destination of the same size, params are
+// accepted and read back as defaults.
+class MockHostDelegate : public VideoHostDelegate
+{
+public:
+    MockHostDelegate(int width, int height)
+    : m_source(std::make_shared<ImageBuffer>()),
+      m_dest(std::make_shared<ImageBuffer>())
+    {
+        m_source->init(width, height, ImageFormat::RGBA8, ChannelOrder::RGBA);
+        m_dest->init(width, height, ImageFormat::RGBA8, ChannelOrder::RGBA);
+    }
+
+    int projectWidth() const override { return m_source->width(); }
+    int projectHeight() const override { return m_source->height(); }
+    int downsampleX() const override { return 1; }
+    int downSampleY() const override { return 1; }
+    float projectFPS() const override { return 24.0f; }
+    int durationFrames() const override { return 1; }
+    int currentFrame() const override { return 0; }
+
+    bool registerParam(const ParameterPtr) override { return true; }
+    ParamValue getParamValue(int) const override { return ParamValue(); }
+    void fillParamSnapshot(ParamSnapshot &) const override { }
+    int hostIndexFromParamId(int paramId) const override { return paramId; }
+    int paramIdFromHostIndex(int hostIndex) const override { return hostIndex; }
+
+    std::string getTextPrompt() override { return m_prompt; }
+    void setTextPrompt(const std::string &prompt) override { m_prompt = prompt; }
+    std::string getRenderedImageID() override { return m_rendered_image_id; }
+    void setRenderedImageID(const std::string &img_id) override { m_rendered_image_id = img_id; }
+    uint64_t getCachedParamsHash() override { return m_params_hash; }
+    void setCachedParamsHash(uint64_t params_hash) override { m_params_hash = params_hash; }
+    std::string getRenderIndex() override { return m_render_index; }
+    void setRenderIndex(const std::string &index) override { m_render_index = index; }
+
+    uint64_t instanceId() override { return 1; }
+    bool isInteractiveRender() override { return true; }
+    RenderCompletion renderCompletion() override { return nullptr; }
+
+    bool getCachedLicenseStatus() override { return true; }
+    void setCachedLicenseStatus(bool) override { }
+
+    ArkImagePtr sourceImg() override { return m_source; }
+    ArkImagePtr destImg() override { return m_dest; }
+    ArkImagePtr getImgAtFrame(int frame) override { return frame == 0 ? m_source : nullptr; }
+
+    bool addFloatSlider(int, const std::string &, float, float, float) override { return true; }
+    bool addIntSlider(int, const std::string &, int, int, int) override { return true; }
+    bool addCheckbox(int, const std::string &, bool) override { return true; }
+    bool addButton(int, const std::string &, const std::string &, bool, bool) override { return true; }
+    bool addPoint(int, const std::string &, const Point2D &) override { return true; }
+    bool addColor(int, const std::string &, const Color &) override { return true; }
+    bool addMenu(int, const std::string &, const std::vector<std::string> &, short) override { return true; }
+    bool startGroup(int, const std::string &, bool) override { return true; }
+    bool endGroup(int, const std::string &) override { return true; }
+    void hideShowControl(int, bool) override { }
+    void enableDisableControl(int, bool) override { }
+
+    DrawHelper &getDrawHelper() override { return m_draw_helper; }
+    std::string getHostName() override { return "Mock"; }
+
+    std::shared_ptr<ImageBuffer> source() { return m_source; }
+    std::shared_ptr<ImageBuffer> dest() { return m_dest; }
+
+protected:
+    std::shared_ptr<ImageBuffer> m_source;
+    std::shared_ptr<ImageBuffer> m_dest;
+    MockDrawHelper m_draw_helper;
+    std::string m_prompt;
+    std::string m_rendered_image_id;
+    uint64_t m_params_hash {0};
+    std::string m_render_index;
+};
+
+#endif // MOCK_HOST_H
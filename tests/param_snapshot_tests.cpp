@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include "param_snapshot.h"
+
+using namespace ::testing;
+
+class ParamSnapshotTest : public Test
+{
+};
+
+TEST(ParamSnapshotTest, LooksUpValuesByParamId)
+{
+    ParamSnapshot snapshot;
+    snapshot.set(10002, 3, 0.5f);
+    snapshot.set(10000, 1, 2);
+    snapshot.set(10001, 2, true);
+
+    EXPECT_EQ(snapshot.size(), 3);
+    EXPECT_EQ(std::get<int>(snapshot.value(10000)), 2);
+    EXPECT_EQ(std::get<bool>(snapshot.value(10001)), true);
+    EXPECT_EQ(std::get<float>(snapshot.value(10002)), 0.5f);
+}
+
+TEST(ParamSnapshotTest, MissingParams)
+{
+    ParamSnapshot snapshot;
+    snapshot.set(10000, 1, 4);
+
+    ParamValue value;
+    EXPECT_FALSE(snapshot.get(20000, value));
+    EXPECT_FALSE(snapshot.contains(20000));
+
+    snapshot.clear();
+    EXPECT_FALSE(snapshot.contains(10000));
+    EXPECT_EQ(snapshot.size(), 0);
+}
+
+TEST(ParamSnapshotTest, SetAgainReplacesTheValue)
+{
+    ParamSnapshot snapshot;
+    snapshot.set(10000, 1, 4);
+    snapshot.set(10000, 1, 5);
+
+    EXPECT_EQ(snapshot.size(), 1);
+    EXPECT_EQ(std::get<int>(snapshot.value(10000)), 5);
+}
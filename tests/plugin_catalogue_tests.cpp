@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include "plugin_catalogue.h"
+#include "ai_renderer_video_filter.h"
+
+using namespace ::testing;
+
+class PluginCatalogueTest : public Test
+{
+};
+
+// reaches the session's plugin configs a refresh updates
+class CatalogueFilter : public AIRendererFilter
+{
+public:
+    using AIRendererFilter::applyCatalogueChanges;
+    static std::vector<FilterConfig> &filterConfigs() { return s_filter_configs; }
+};
+
+static ArkPlugin makePlugin(const std::string &plugin_name, const std::string &version)
+{
+    ArkPlugin plugin;
+    plugin.name = plugin_name + " UI";
+    plugin.version = version;
+    plugin.author = "DeepMake";
+    plugin.description = "test plugin";
+    plugin.env = "sd";
+    plugin.license_level = 2;
+    plugin.config.model_name = "model";
+    plugin.config.model_dtype = "fp16";
+    plugin.config.save_output = true;
+    plugin.config.hash = 0x5eed;
+
+    Endpoint endpoint;
+    endpoint.name = "txt2img";
+    endpoint.call = "txt2img";
+    endpoint.tag = "generator";
+    endpoint.has_prompt = true;
+    endpoint.inputs.push_back({"prompt", "Text(default='')"});
+    endpoint.inputs.push_back({"seed", "Int(default=0, min=0, max=100)"});
+    endpoint.outputs.push_back({"output_img", "Image"});
+    plugin.endpoints.push_back(endpoint);
+
+    plugin.setPluginName(plugin_name);
+    return plugin;
+}
+
+TEST(PluginCatalogueTest, RoundTrip)
+{
+    std::vector<ArkPlugin> plugins = {makePlugin("diffusers", "1.0"), makePlugin("rembg", "0.3")};
+    std::string data;
+    PluginCatalogue::serialize(plugins, data);
+
+    std::vector<ArkPlugin> loaded;
+    ASSERT_TRUE(PluginCatalogue::deserialize(data.data(), data.size(), loaded));
+    ASSERT_EQ(loaded.size(), 2u);
+    EXPECT_EQ(loaded[1].plugin_name, "rembg");
+    EXPECT_EQ(loaded[1].version, "0.3");
+    EXPECT_EQ(loaded[0].license_level, 2);
+    EXPECT_TRUE(loaded[0].config.save_output);
+    EXPECT_EQ(loaded[0].config.hash, 0x5eedu);
+    ASSERT_EQ(loaded[0].endpoints.size(), 1u);
+    EXPECT_EQ(loaded[0].endpoints[0].plugin_name, "diffusers");
+    EXPECT_TRUE(loaded[0].endpoints[0].has_prompt);
+    ASSERT_EQ(loaded[0].endpoints[0].inputs.size(), 2u);
+    EXPECT_EQ(loaded[0].endpoints[0].inputs[1].parameter_data, "Int(default=0, min=0, max=100)");
+}
+
+TEST(PluginCatalogueTest, RejectsTruncatedData)
+{
+    std::vector<ArkPlugin> plugins = {makePlugin("diffusers", "1.0")};
+    std::string data;
+    PluginCatalogue::serialize(plugins, data);
+
+    std::vector<ArkPlugin> loaded;
+    EXPECT_FALSE(PluginCatalogue::deserialize(data.data(), data.size() - 3, loaded));
+    EXPECT_FALSE(PluginCatalogue::deserialize("nope", 4, loaded));
+    EXPECT_TRUE(loaded.empty());
+}
+
+TEST(PluginCatalogueTest, SaveAndLoadFile)
+{
+    std::string path = (std::filesystem::temp_directory_path() / "plugin_catalogue_test.bin").string();
+    std::vector<ArkPlugin> plugins = {makePlugin("diffusers", "1.0"), makePlugin("rembg", "0.3")};
+    ASSERT_TRUE(PluginCatalogue::save(path, plugins));
+
+    std::vector<ArkPlugin> loaded;
+    ASSERT_TRUE(PluginCatalogue::load(path, loaded));
+    EXPECT_EQ(loaded.size(), 2u);
+    std::filesystem::remove(path);
+
+    EXPECT_FALSE(PluginCatalogue::load(path, loaded));
+}
+
+TEST(PluginCatalogueTest, MergeKeepsUnchangedVersions)
+{
+    std::vector<ArkPlugin> snapshot = {makePlugin("diffusers", "1.0"), makePlugin("rembg", "0.3"), makePlugin("old", "1.0")};
+    snapshot[0].description = "from snapshot";
+
+    std::vector<ArkPlugin> fetched = {makePlugin("diffusers", "1.0"), makePlugin("rembg", "0.4"), makePlugin("new", "1.0")};
+
+    std::vector<ArkPlugin> merged;
+    // rembg updated, new added, old removed
+    EXPECT_EQ(PluginCatalogue::merge(snapshot, fetched, merged), 3);
+    ASSERT_EQ(merged.size(), 3u);
+    EXPECT_EQ(merged[0].description, "from snapshot");
+    EXPECT_EQ(merged[1].version, "0.4");
+    EXPECT_EQ(merged[2].plugin_name, "new");
+
+    std::vector<ArkPlugin> unchanged;
+    EXPECT_EQ(PluginCatalogue::merge(merged, merged, unchanged), 0);
+}
+
+TEST(PluginCatalogueTest, MergeTakesEditedConfigs)
+{
+    std::vector<ArkPlugin> snapshot = {makePlugin("diffusers", "1.0")};
+    std::vector<ArkPlugin> fetched = {makePlugin("diffusers", "1.0")};
+    fetched[0].config.hash = 0xed17;
+
+    std::vector<ArkPlugin> merged;
+    EXPECT_EQ(PluginCatalogue::merge(snapshot, fetched, merged), 1);
+    ASSERT_EQ(merged.size(), 1u);
+    EXPECT_EQ(merged[0].config.hash, 0xed17u);
+}
+
+TEST(PluginCatalogueTest, RefreshUpdatesTheSessionsConfigs)
+{
+    std::vector<FilterConfig> saved_configs = CatalogueFilter::filterConfigs();
+    CatalogueFilter::filterConfigs().clear();
+    for (const auto &plugin : {makePlugin("diffusers", "1.0"), makePlugin("sam", "2.0")})
+    {
+        FilterConfig filter_config(plugin.plugin_name);
+        filter_config.plugin() = plugin;
+        CatalogueFilter::filterConfigs().push_back(filter_config);
+    }
+
+    std::vector<ArkPlugin> fetched = {makePlugin("diffusers", "1.1"), makePlugin("sam", "2.0"), makePlugin("new", "1.0")};
+    fetched[0].config.hash = 0xed17;
+    EXPECT_EQ(CatalogueFilter::applyCatalogueChanges(fetched), 1);
+    EXPECT_EQ(CatalogueFilter::filterConfigs()[0].plugin().version, "1.1");
+    EXPECT_EQ(CatalogueFilter::filterConfigs()[0].plugin().config.hash, 0xed17u);
+    EXPECT_EQ(CatalogueFilter::filterConfigs()[1].plugin().version, "2.0");
+    // the menu was built from the snapshot, a new plugin waits for the next launch
+    EXPECT_EQ(CatalogueFilter::filterConfigs().size(), 2u);
+
+    CatalogueFilter::filterConfigs() = saved_configs;
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include "render_result_index.h"
+
+using namespace ::testing;
+
+class RenderResultIndexTest : public Test
+{
+};
+
+TEST(RenderResultIndexTest, FindByFrameAndParams)
+{
+    RenderResultIndex index;
+    index.add(10, 0xabcdef, "img-10");
+    index.add(11, 0xabcdef, "img-11");
+
+    std::string img_id;
+    EXPECT_TRUE(index.find(10, 0xabcdef, img_id));
+    EXPECT_EQ(img_id, "img-10");
+    EXPECT_FALSE(index.find(10, 0x123456, img_id));
+    EXPECT_FALSE(index.find(12, 0xabcdef, img_id));
+
+    index.remove(10, 0xabcdef);
+    EXPECT_FALSE(index.find(10, 0xabcdef, img_id));
+}
+
+TEST(RenderResultIndexTest, SerializeRoundTrip)
+{
+    RenderResultIndex index;
+    for (int frame = 0; frame < 20; frame++)
+        index.add(frame, 42, "img-" + std::to_string(frame));
+
+    RenderResultIndex loaded;
+    ASSERT_TRUE(loaded.deserialize(index.serialize()));
+    EXPECT_EQ(loaded.size(), 20u);
+
+    std::string img_id;
+    EXPECT_TRUE(loaded.find(7, 42, img_id));
+    EXPECT_EQ(img_id, "img-7");
+
+    EXPECT_FALSE(loaded.deserialize(std::string("\x07\x01\x00", 3)));
+    EXPECT_EQ(loaded.size(), 0u);
+    EXPECT_TRUE(loaded.deserialize(""));
+}
+
+TEST(RenderResultIndexTest, StaysUnderByteBudget)
+{
+    const size_t max_bytes = 256;
+    RenderResultIndex index(max_bytes);
+    for (int frame = 0; frame < 100; frame++)
+        index.add(frame, 42, "0123456789abcdef0123456789abcdef0123");
+
+    EXPECT_LE(index.serialize().size(), max_bytes);
+
+    // newest frames survive
+    std::string img_id;
+    EXPECT_TRUE(index.find(99, 42, img_id));
+    EXPECT_FALSE(index.find(0, 42, img_id));
+
+    // the recency order survives a round trip
+    RenderResultIndex loaded(max_bytes);
+    ASSERT_TRUE(loaded.deserialize(index.serialize()));
+    EXPECT_TRUE(loaded.find(99, 42, img_id));
+}
+
+TEST(RenderResultIndexTest, NodeIsKeptWithTheImage)
+{
+    RenderResultIndex index;
+    index.add(1, 42, "img-1", "http://node-a:8000/");
+    index.add(2, 42, "img-1", "http://node-b:8000/");
+
+    RenderResultIndex loaded;
+    ASSERT_TRUE(loaded.deserialize(index.serialize()));
+
+    // the same id from two backends stays apart
+    std::string img_id;
+    std::string node_url;
+    ASSERT_TRUE(loaded.find(1, 42, img_id, &node_url));
+    EXPECT_EQ(node_url, "http://node-a:8000/");
+    ASSERT_TRUE(loaded.find(2, 42, img_id, &node_url));
+    EXPECT_EQ(node_url, "http://node-b:8000/");
+
+    EXPECT_TRUE(loaded.findNode("img-1", node_url));
+    EXPECT_FALSE(loaded.findNode("img-2", node_url));
+}
+
+TEST(RenderResultIndexTest, NodeUrlIsStoredOnce)
+{
+    RenderResultIndex index;
+    const std::string node_url = "http://render-node-01.studio.lan:8000/";
+    for (int frame = 0; frame < 75; frame++)
+        index.add(frame, 42, "0123456789abcdef0123456789abcdef" + std::to_string(1000 + frame), node_url);
+
+    // a uuid sized id per frame, the url repeated with each of them wouldn't leave room for all
+    EXPECT_LE(index.serialize().size(), kRenderIndexMaxBytes);
+    RenderResultIndex loaded;
+    ASSERT_TRUE(loaded.deserialize(index.serialize()));
+    EXPECT_EQ(loaded.size(), 75u);
+
+    std::string img_id;
+    std::string loaded_node_url;
+    ASSERT_TRUE(loaded.find(0, 42, img_id, &loaded_node_url));
+    EXPECT_EQ(loaded_node_url, node_url);
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include "render_latency.h"
+
+using namespace ::testing;
+
+class RenderLatencyTest : public Test
+{
+};
+
+static RenderLatency::Clock::time_point at(int ms)
+{
+    return RenderLatency::Clock::time_point(std::chrono::milliseconds(ms));
+}
+
+TEST(RenderLatencyTest, DraftAndFinalAreMeasuredApart)
+{
+    RenderLatency latency;
+    latency.requested(1, 0xaa, at(1000));
+    EXPECT_DOUBLE_EQ(latency.firstFeedback(1, 0xaa, at(1200)), 0.2);
+    // the draft is shown again on later calls, only the first time counts
+    EXPECT_LT(latency.firstFeedback(1, 0xaa, at(1500)), 0.0);
+    EXPECT_DOUBLE_EQ(latency.finished(1, 0xaa, at(3000)), 2.0);
+
+    EXPECT_EQ(latency.firstFeedbackStats().count, 1u);
+    EXPECT_DOUBLE_EQ(latency.firstFeedbackStats().mean_seconds, 0.2);
+    EXPECT_EQ(latency.finalStats().count, 1u);
+    EXPECT_DOUBLE_EQ(latency.finalStats().mean_seconds, 2.0);
+
+    // and once finished it isn't waited on anymore
+    EXPECT_LT(latency.finished(1, 0xaa, at(4000)), 0.0);
+    EXPECT_EQ(latency.finalStats().count, 1u);
+}
+
+TEST(RenderLatencyTest, FinalWithoutDraftIsTheFirstFeedback)
+{
+    RenderLatency latency;
+    latency.requested(1, 0xaa, at(0));
+    // asking again while it renders doesn't restart the clock
+    latency.requested(1, 0xaa, at(400));
+    EXPECT_DOUBLE_EQ(latency.finished(1, 0xaa, at(1000)), 1.0);
+
+    EXPECT_EQ(latency.firstFeedbackStats().count, 1u);
+    EXPECT_DOUBLE_EQ(latency.firstFeedbackStats().mean_seconds, 1.0);
+    EXPECT_DOUBLE_EQ(latency.finalStats().max_seconds, 1.0);
+}
+
+TEST(RenderLatencyTest, SupersededRendersAreNotMeasured)
+{
+    RenderLatency latency;
+    latency.requested(1, 0xaa, at(0));
+    latency.requested(1, 0xbb, at(500));
+    EXPECT_LT(latency.finished(1, 0xaa, at(1000)), 0.0);
+    EXPECT_DOUBLE_EQ(latency.finished(1, 0xbb, at(1500)), 1.0);
+
+    // instances wait on their own renders
+    latency.requested(1, 0xcc, at(2000));
+    latency.requested(2, 0xcc, at(2500));
+    EXPECT_DOUBLE_EQ(latency.finished(2, 0xcc, at(3000)), 0.5);
+    EXPECT_DOUBLE_EQ(latency.finished(1, 0xcc, at(3000)), 1.0);
+
+    RenderLatency::Stats final_stats = latency.finalStats();
+    EXPECT_EQ(final_stats.count, 3u);
+    EXPECT_NEAR(final_stats.mean_seconds, 2.5 / 3.0, 1e-9);
+    EXPECT_DOUBLE_EQ(final_stats.max_seconds, 1.0);
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <vector>
+#include "ai_renderer_video_filter.h"
+#include "circuit_breaker.h"
+#include "main_api_connection.h"
+#include "mock_host.h"
+#include "video_host.h"
+
+using namespace ::testing;
+
+class RenderPassthroughTest : public Test
+{
+};
+
+TEST(RenderPassthroughTest, OpenBreakerPassesTheSourceThrough)
+{
+    std::vector<BackendNode> nodes = ApiConnection::configuredBackends();
+    std::vector<int> failures;
+    for (const auto &node : nodes)
+    {
+        CircuitBreaker &breaker = CircuitBreaker::forBackend(node.base_url + node.unix_socket);
+        while (!breaker.isOpen())
+            breaker.recordFailure();
+        failures.push_back(breaker.consecutiveFailures());
+    }
+
+    auto delegate = std::make_shared<MockHostDelegate>(8, 4);
+    size_t size = delegate->source()->strideBytes() * delegate->source()->height();
+    unsigned char *source = static_cast<unsigned char *>(delegate->source()->data());
+    for (size_t i = 0; i < size; i++)
+        source[i] = static_cast<unsigned char>(i * 7);
+    VideoHost host(delegate, std::make_shared<AIRendererFilter>());
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(host.render());
+    // no status probe or request waited on a timeout
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+    EXPECT_EQ(memcmp(delegate->source()->data(), delegate->dest()->data(), size), 0);
+
+    // nothing was sent, a request would have counted another failure
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        CircuitBreaker &breaker = CircuitBreaker::forBackend(nodes[i].base_url + nodes[i].unix_socket);
+        EXPECT_EQ(breaker.consecutiveFailures(), failures[i]);
+        breaker.reset();
+    }
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "render_pipeline.h"
+
+using namespace ::testing;
+
+class RenderPipelineTest : public Test
+{
+};
+
+struct PipelineFrame
+{
+    int frame {0};
+    std::vector<std::string> stages;
+};
+
+static RenderPipeline<PipelineFrame>::Stage sleepingStage(const std::string &name, std::chrono::milliseconds duration)
+{
+    return [name, duration](PipelineFrame &frame)
+    {
+        std::this_thread::sleep_for(duration);
+        frame.stages.push_back(name);
+        return true;
+    };
+}
+
+TEST(RenderPipelineTest, EveryFrameGoesThroughEveryStageInOrder)
+{
+    RenderPipeline<PipelineFrame> pipeline(sleepingStage("upload", std::chrono::milliseconds(0)),
+                                           sleepingStage("infer", std::chrono::milliseconds(0)),
+                                           sleepingStage("download", std::chrono::milliseconds(0)), 2);
+    std::vector<PipelineFrame> done;
+    pipeline.start([&](PipelineFrame &frame, bool success)
+    {
+        EXPECT_TRUE(success);
+        done.push_back(frame);
+    });
+    for (int i = 0; i < 10; i++)
+        EXPECT_TRUE(pipeline.submit(PipelineFrame{i, {}}));
+    pipeline.finish();
+    EXPECT_FALSE(pipeline.submit(PipelineFrame{10, {}}));
+
+    ASSERT_EQ(done.size(), 10u);
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_EQ(done[i].frame, i);
+        EXPECT_EQ(done[i].stages, (std::vector<std::string>{"upload", "infer", "download"}));
+    }
+}
+
+TEST(RenderPipelineTest, DroppedFramesSkipTheRest)
+{
+    std::atomic<int> downloads {0};
+    RenderPipeline<PipelineFrame> pipeline(
+        [](PipelineFrame &) { return true; },
+        [](PipelineFrame &frame) { return frame.frame != 3; },
+        [&](PipelineFrame &) { downloads++; return true; }, 2);
+
+    std::mutex mutex;
+    std::vector<int> failed;
+    pipeline.start([&](PipelineFrame &frame, bool success)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!success)
+            failed.push_back(frame.frame);
+    });
+    for (int i = 0; i < 6; i++)
+        pipeline.submit(PipelineFrame{i, {}});
+    pipeline.finish();
+
+    EXPECT_EQ(failed, (std::vector<int>{3}));
+    EXPECT_EQ(downloads, 5);
+}
+
+TEST(RenderPipelineTest, StagesOverlap)
+{
+    const std::chrono::milliseconds kStage(20);
+    const int kFrames = 10;
+    RenderPipeline<PipelineFrame> pipeline(sleepingStage("upload", kStage), sleepingStage("infer", kStage),
+                                           sleepingStage("download", kStage), 2);
+    std::atomic<int> done {0};
+    pipeline.start([&](PipelineFrame &, bool) { done++; });
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kFrames; i++)
+        pipeline.submit(PipelineFrame{i, {}});
+    pipeline.finish();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // one stage time per frame plus filling the pipeline, back to back would take three per frame
+    EXPECT_EQ(done, kFrames);
+    EXPECT_LT(elapsed, kStage * (kFrames * 3) * 2 / 3);
+}
+
+TEST(RenderPipelineTest, SlowStageHoldsTheOthersBack)
+{
+    std::atomic<int> uploaded {0};
+    std::atomic<bool> release {false};
+    RenderPipeline<PipelineFrame> pipeline(
+        [&](PipelineFrame &) { uploaded++; return true; },
+        [&](PipelineFrame &)
+        {
+            while (!release)
+                std::this_thread::yield();
+            return true;
+        },
+        [](PipelineFrame &) { return true; }, 1);
+    pipeline.start(nullptr);
+
+    std::thread producer([&]()
+    {
+        for (int i = 0; i < 10; i++)
+            pipeline.submit(PipelineFrame{i, {}});
+    });
+    // inference holds one frame and its queue another, the upload stage the third and stops
+    while (pipeline.uploadStalls() == 0)
+        std::this_thread::yield();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(uploaded, 3);
+
+    release = true;
+    producer.join();
+    pipeline.finish();
+    EXPECT_EQ(uploaded, 10);
+}
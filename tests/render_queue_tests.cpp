@@ -0,0 +1,333 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+#include "render_queue.h"
+
+using namespace ::testing;
+
+class RenderQueueTest : public Test
+{
+};
+
+static void waitForFinished(RenderQueue &queue, size_t count)
+{
+    while (queue.finishedCount() < count || queue.pendingCount() > 0)
+        std::this_thread::yield();
+}
+
+TEST(RenderQueueTest, ResultIsTakenByItsInstance)
+{
+    RenderQueue queue(1);
+    std::atomic<int> completions {0};
+    EXPECT_TRUE(queue.submit(1, 100, 7, [](RenderQueue::Result &result)
+    {
+        result.success = true;
+        result.image_id = "img_7";
+        result.node_url = "http://node:8000/";
+    },
+    [&](const RenderQueue::Result &result)
+    {
+        EXPECT_TRUE(result.success);
+        completions++;
+    }));
+    waitForFinished(queue, 1);
+    while (completions == 0)
+        std::this_thread::yield();
+
+    std::vector<RenderQueue::Result> results;
+    EXPECT_FALSE(queue.takeResults(2, results));
+    EXPECT_TRUE(queue.takeResults(1, results));
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].instance_id, 1u);
+    EXPECT_EQ(results[0].render_key, 100u);
+    EXPECT_EQ(results[0].frame, 7);
+    EXPECT_EQ(results[0].image_id, "img_7");
+    EXPECT_EQ(results[0].node_url, "http://node:8000/");
+    EXPECT_EQ(queue.lastImageId(1), "img_7");
+
+    // taken once
+    results.clear();
+    EXPECT_FALSE(queue.takeResults(1, results));
+    std::string node_url;
+    EXPECT_EQ(queue.lastImageId(1, &node_url), "img_7");
+    EXPECT_EQ(node_url, "http://node:8000/");
+}
+
+TEST(RenderQueueTest, DuplicateSubmitsAreDropped)
+{
+    RenderQueue queue(1);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<int> runs {0};
+    auto work = [&](RenderQueue::Result &result)
+    {
+        runs++;
+        released.wait();
+        result.success = true;
+    };
+
+    EXPECT_TRUE(queue.submit(1, 100, 7, work));
+    EXPECT_FALSE(queue.submit(1, 100, 7, work));
+    EXPECT_TRUE(queue.isPending(1, 100, 7));
+    // another frame, params or instance is a different job
+    EXPECT_TRUE(queue.submit(1, 100, 8, work));
+    EXPECT_TRUE(queue.submit(1, 101, 7, work));
+    EXPECT_TRUE(queue.submit(2, 100, 7, work));
+    EXPECT_EQ(queue.pendingCount(), 4u);
+
+    release.set_value();
+    waitForFinished(queue, 4);
+    EXPECT_EQ(runs, 4);
+    EXPECT_FALSE(queue.isPending(1, 100, 7));
+
+    // finished, so it can be submitted again
+    EXPECT_TRUE(queue.submit(1, 100, 7, work));
+    waitForFinished(queue, 5);
+}
+
+TEST(RenderQueueTest, FailedJobsKeepTheLastImage)
+{
+    RenderQueue queue(1);
+    queue.submit(1, 100, 7, [](RenderQueue::Result &result)
+    {
+        result.success = true;
+        result.image_id = "good";
+    });
+    waitForFinished(queue, 1);
+    queue.submit(1, 101, 7, [](RenderQueue::Result &result)
+    {
+        throw std::runtime_error("backend went away");
+    });
+    waitForFinished(queue, 2);
+
+    std::vector<RenderQueue::Result> results;
+    EXPECT_TRUE(queue.takeResults(1, results));
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_TRUE(results[0].success);
+    EXPECT_FALSE(results[1].success);
+    EXPECT_EQ(queue.lastImageId(1), "good");
+}
+
+TEST(RenderQueueTest, ShutdownDropsQueuedJobs)
+{
+    RenderQueue queue(1);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<int> runs {0};
+    auto work = [&](RenderQueue::Result &result)
+    {
+        runs++;
+        released.wait();
+        result.success = true;
+    };
+
+    queue.submit(1, 100, 1, work);
+    while (runs == 0)
+        std::this_thread::yield();
+    queue.submit(1, 100, 2, work);
+    queue.submit(1, 100, 3, work);
+
+    std::thread stopper([&]() { queue.shutdown(); });
+    release.set_value();
+    stopper.join();
+
+    // the running job finishes, the queued ones never start
+    EXPECT_EQ(runs, 1);
+    EXPECT_EQ(queue.pendingCount(), 0u);
+    EXPECT_FALSE(queue.submit(1, 100, 4, work));
+}
+
+TEST(RenderQueueTest, InteractiveJobsGoFirst)
+{
+    // one worker, so prefetch work can't be kept off it and the order shows
+    RenderQueue queue(1);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::mutex order_mutex;
+    std::vector<int> order;
+    auto work = [&](RenderQueue::Result &result)
+    {
+        released.wait();
+        std::lock_guard<std::mutex> lock(order_mutex);
+        order.push_back(result.frame);
+        result.success = true;
+    };
+
+    queue.submit(1, 100, 1, work);
+    while (queue.queuedCount(RenderLane::Interactive) > 0)
+        std::this_thread::yield();
+    queue.submit(1, 100, 2, work, nullptr, RenderLane::Prefetch);
+    queue.submit(1, 100, 3, work, nullptr, RenderLane::Prefetch);
+    queue.submit(1, 100, 4, work);
+    // asked for while still queued, so it moves up too
+    EXPECT_TRUE(queue.promote(1, 100, 3));
+    EXPECT_EQ(queue.queuedCount(RenderLane::Prefetch), 1u);
+
+    release.set_value();
+    waitForFinished(queue, 4);
+    EXPECT_EQ(order, (std::vector<int>{1, 4, 3, 2}));
+}
+
+TEST(RenderQueueTest, PrefetchLeavesAWorkerFree)
+{
+    RenderQueue queue(2);
+    std::promise<void> release_prefetch;
+    std::shared_future<void> prefetch_released = release_prefetch.get_future().share();
+    std::atomic<int> prefetch_runs {0};
+    auto prefetch_work = [&](RenderQueue::Result &result)
+    {
+        prefetch_runs++;
+        prefetch_released.wait();
+        result.success = true;
+    };
+
+    queue.submit(1, 100, 2, prefetch_work, nullptr, RenderLane::Prefetch);
+    queue.submit(1, 100, 3, prefetch_work, nullptr, RenderLane::Prefetch);
+    while (prefetch_runs == 0)
+        std::this_thread::yield();
+
+    // the second prefetch stays queued, the interactive job gets the free worker
+    std::atomic<bool> interactive_done {false};
+    queue.submit(1, 100, 1, [&](RenderQueue::Result &result) { result.success = true; },
+                 [&](const RenderQueue::Result &) { interactive_done = true; });
+    while (!interactive_done)
+        std::this_thread::yield();
+    EXPECT_EQ(prefetch_runs, 1);
+    EXPECT_EQ(queue.queuedCount(RenderLane::Prefetch), 1u);
+
+    release_prefetch.set_value();
+    waitForFinished(queue, 3);
+    EXPECT_EQ(prefetch_runs, 2);
+}
+
+TEST(RenderQueueTest, WaitForPromotesAndBlocks)
+{
+    RenderQueue queue(2);
+    std::atomic<int> runs {0};
+    queue.submit(1, 100, 5, [&](RenderQueue::Result &result)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        runs++;
+        result.success = true;
+        result.image_id = "img_5";
+    }, nullptr, RenderLane::Prefetch);
+
+    EXPECT_TRUE(queue.waitFor(1, 100, 5));
+    EXPECT_EQ(runs, 1);
+    EXPECT_FALSE(queue.isPending(1, 100, 5));
+    EXPECT_FALSE(queue.waitFor(1, 100, 5));
+
+    // waited for, so it counts as what the instance last showed
+    EXPECT_EQ(queue.lastImageId(1), "img_5");
+}
+
+TEST(RenderQueueTest, CancelDropsQueuedPrefetch)
+{
+    RenderQueue queue(2);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<int> runs {0};
+    auto work = [&](RenderQueue::Result &result)
+    {
+        runs++;
+        released.wait();
+        result.success = true;
+    };
+
+    queue.submit(1, 100, 2, work, nullptr, RenderLane::Prefetch);
+    while (runs == 0)
+        std::this_thread::yield();
+    queue.submit(1, 100, 3, work, nullptr, RenderLane::Prefetch);
+    queue.submit(1, 100, 4, work, nullptr, RenderLane::Prefetch);
+    queue.submit(2, 100, 3, work, nullptr, RenderLane::Prefetch);
+
+    EXPECT_EQ(queue.cancelQueued(1, RenderLane::Prefetch), 2u);
+    EXPECT_FALSE(queue.isPending(1, 100, 3));
+    // the running one and the other instance's are left alone
+    EXPECT_TRUE(queue.isPending(1, 100, 2));
+    EXPECT_TRUE(queue.isPending(2, 100, 3));
+
+    release.set_value();
+    waitForFinished(queue, 2);
+    EXPECT_EQ(runs, 2);
+}
+
+TEST(RenderQueueTest, BatchFramesArePublishedAsTheyFinish)
+{
+    RenderQueue queue(2);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<bool> published {false};
+    EXPECT_TRUE(queue.submitBatch(1, {{100, 1}, {101, 2}, {102, 3}}, [&](RenderQueue::Result &result)
+    {
+        RenderQueue::Result other;
+        other.instance_id = 1;
+        other.render_key = 101;
+        other.frame = 2;
+        other.success = true;
+        other.image_id = "img_2";
+        queue.publish(other);
+        published = true;
+
+        released.wait();
+        result.success = true;
+        result.image_id = "img_1";
+    }));
+
+    // the other frames count as pending, so they aren't submitted again
+    EXPECT_FALSE(queue.submit(1, 102, 3, [](RenderQueue::Result &) {}));
+    EXPECT_FALSE(queue.submitBatch(1, {{103, 4}, {102, 3}}, [](RenderQueue::Result &) {}));
+
+    while (!published)
+        std::this_thread::yield();
+    std::vector<RenderQueue::Result> results;
+    EXPECT_TRUE(queue.takeResults(1, results));
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].frame, 2);
+    EXPECT_EQ(results[0].image_id, "img_2");
+    EXPECT_EQ(results[0].lane, RenderLane::Prefetch);
+    EXPECT_FALSE(queue.isPending(1, 101, 2));
+    EXPECT_TRUE(queue.isPending(1, 102, 3));
+
+    release.set_value();
+    waitForFinished(queue, 1);
+    // frame 3 was never published, it's dropped with the batch
+    EXPECT_FALSE(queue.isPending(1, 102, 3));
+    results.clear();
+    EXPECT_TRUE(queue.takeResults(1, results));
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].frame, 1);
+}
+
+TEST(RenderQueueTest, WaitingForABatchFrame)
+{
+    RenderQueue queue(2);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    queue.submitBatch(1, {{100, 1}, {101, 2}}, [&](RenderQueue::Result &result)
+    {
+        released.wait();
+        RenderQueue::Result other;
+        other.instance_id = 1;
+        other.render_key = 101;
+        other.frame = 2;
+        other.success = true;
+        other.image_id = "img_2";
+        queue.publish(other);
+        result.success = true;
+    });
+
+    std::thread releaser([&]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        release.set_value();
+    });
+    // returns once the frame is published, promoted so it's what the instance last showed
+    EXPECT_TRUE(queue.waitFor(1, 101, 2));
+    EXPECT_EQ(queue.lastImageId(1), "img_2");
+    releaser.join();
+    waitForFinished(queue, 2);
+}
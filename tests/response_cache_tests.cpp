@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <mutex>
+#include "response_cache.h"
+#include "main_api_connection.h"
+#include "ark_plugin.h"
+#include "mock_backend.h"
+
+using namespace ::testing;
+
+class ResponseCacheTest : public Test
+{
+};
+
+TEST(ResponseCacheTest, FreshHitAndMiss)
+{
+    ResponseCache cache;
+    CachedResponse entry;
+    EXPECT_EQ(cache.lookup("http://localhost:8000/plugins/get_list", entry), ResponseCache::Lookup::Miss);
+
+    cache.store("http://localhost:8000/plugins/get_list", "[\"a\",\"b\"]", "\"v1\"", "", std::chrono::seconds(60));
+    EXPECT_EQ(cache.lookup("http://localhost:8000/plugins/get_list", entry), ResponseCache::Lookup::Fresh);
+    EXPECT_EQ(entry.body, "[\"a\",\"b\"]");
+    EXPECT_EQ(entry.etag, "\"v1\"");
+
+    ResponseCacheStats stats = cache.stats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.bytes_saved, entry.body.size());
+}
+
+TEST(ResponseCacheTest, StaleEntryRevalidates)
+{
+    ResponseCache cache;
+    CachedResponse entry;
+    cache.store("http://localhost:8000/login/status", "{\"logged_in\":true}", "\"v1\"", "", std::chrono::seconds(0));
+    EXPECT_EQ(cache.lookup("http://localhost:8000/login/status", entry), ResponseCache::Lookup::Stale);
+    EXPECT_EQ(entry.etag, "\"v1\"");
+
+    std::string body;
+    EXPECT_TRUE(cache.markRevalidated("http://localhost:8000/login/status", std::chrono::seconds(60), body));
+    EXPECT_EQ(body, "{\"logged_in\":true}");
+    EXPECT_EQ(cache.lookup("http://localhost:8000/login/status", entry), ResponseCache::Lookup::Fresh);
+    EXPECT_EQ(cache.stats().revalidations, 1u);
+
+    EXPECT_FALSE(cache.markRevalidated("http://localhost:8000/unknown", std::chrono::seconds(60), body));
+}
+
+TEST(ResponseCacheTest, InvalidatePrefix)
+{
+    ResponseCache cache;
+    CachedResponse entry;
+    cache.store("http://localhost:8000/plugins/get_info/a", "{}", "", "", std::chrono::seconds(60));
+    cache.store("http://localhost:8000/plugins/get_list", "[]", "", "", std::chrono::seconds(60));
+    cache.store("http://localhost:8000/login/status", "{}", "", "", std::chrono::seconds(60));
+
+    cache.invalidatePrefix("http://localhost:8000/plugins/");
+    EXPECT_EQ(cache.lookup("http://localhost:8000/plugins/get_info/a", entry), ResponseCache::Lookup::Miss);
+    EXPECT_EQ(cache.lookup("http://localhost:8000/plugins/get_list", entry), ResponseCache::Lookup::Miss);
+    EXPECT_EQ(cache.lookup("http://localhost:8000/login/status", entry), ResponseCache::Lookup::Fresh);
+}
+
+#ifndef _WIN32
+static std::string getInfoJson(const std::string &model_name)
+{
+    return "{\"plugin\": {\"Name\": \"Dummy\", \"Version\": \"0.1.0\", \"Author\": \"DeepMake\", \"Description\": \"Dummy\", \"env\": \"dummy\"},"
+           " \"config\": {\"model_name\": \"" + model_name + "\", \"model_dtype\": \"fp32\"},"
+           " \"endpoints\": {\"run\": {\"call\": \"run\", \"inputs\": {\"img\": \"Image\"}, \"outputs\": {\"output_img\": \"Image\"}}}}";
+}
+
+TEST(ResponseCacheTest, ConfigEditedInTheDialogIsFetchedAfterIt)
+{
+    MockBackend backend;
+    std::mutex mutex;
+    std::string model_name = "model-v1";
+    backend.on("GET", "plugins/get_info/", [&](const MockRequest &)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return MockResponse{200, getInfoJson(model_name)};
+    });
+    backend.on("GET", "ui/configure/", [&](const MockRequest &)
+    {
+        // a render asks for the info while the dialog is open, then the user saves
+        ArkPlugin during;
+        ApiConnection(backend.baseUrl()).getPluginInfo("Dummy", during);
+        std::lock_guard<std::mutex> lock(mutex);
+        model_name = "model-v2";
+        return MockResponse{200, "{}"};
+    });
+    ASSERT_TRUE(backend.start());
+
+    ApiConnection api_connection(backend.baseUrl());
+    ArkPlugin before;
+    ASSERT_TRUE(api_connection.getPluginInfo("Dummy", before));
+    EXPECT_EQ(before.config.model_name, "model-v1");
+
+    api_connection.openConfigMenu("Dummy");
+
+    ArkPlugin after;
+    ASSERT_TRUE(api_connection.getPluginInfo("Dummy", after));
+    EXPECT_EQ(after.config.model_name, "model-v2");
+    EXPECT_EQ(backend.requestCount("plugins/get_info/"), 2u);
+}
+#endif
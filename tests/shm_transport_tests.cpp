@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <rapidjson/document.h>
+#include "mock_backend.h"
+#include "main_api_connection.h"
+#include "shm_transport.h"
+#include "images/image_buffer.h"
+
+using namespace ::testing;
+
+class ShmTransportTest : public Test
+{
+};
+
+static const int k4KWidth = 3840;
+static const int k4KHeight = 2160;
+
+// maps the segment the plugin named in the request, like the backend would
+static uint8_t *mapSegment(const std::string &name, size_t size)
+{
+    int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0)
+        return nullptr;
+    void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return data == MAP_FAILED ? nullptr : static_cast<uint8_t *>(data);
+}
+
+TEST(ShmTransportTest, SlotGrowsAndIsVisibleByName)
+{
+    SharedMemorySlot slot("/deepmake_test_slot_" + std::to_string(getpid()));
+    ASSERT_TRUE(slot.reserve(1024));
+    slot.data()[10] = 42;
+    ASSERT_TRUE(slot.reserve(4096));
+    EXPECT_EQ(slot.capacity(), 4096u);
+    EXPECT_EQ(slot.data()[10], 42);
+
+    uint8_t *mapped = mapSegment(slot.name(), slot.capacity());
+    ASSERT_NE(mapped, nullptr);
+    EXPECT_EQ(mapped[10], 42);
+    munmap(mapped, slot.capacity());
+}
+
+TEST(ShmTransportTest, FramesBypassTheSocket)
+{
+    MockBackend backend;
+    ASSERT_TRUE(backend.start());
+
+    backend.on("GET", "image/shm_support", [](const MockRequest &)
+    {
+        return MockResponse{200, "{}"};
+    });
+
+    uint8_t received_pixel = 0;
+    backend.on("POST", "image/upload_shm", [&received_pixel](const MockRequest &request)
+    {
+        rapidjson::Document doc;
+        doc.Parse(request.body.c_str());
+        size_t size = doc["size"].GetUint64();
+        uint8_t *pixels = mapSegment(doc["shm_name"].GetString(), size);
+        if (pixels == nullptr)
+            return MockResponse{500, "{}"};
+        received_pixel = pixels[size - 1];
+        munmap(pixels, size);
+        return MockResponse{200, "{\"status\":\"Success\",\"image_id\":\"shm-upload\"}"};
+    });
+
+    backend.on("POST", "image/get_shm", [](const MockRequest &request)
+    {
+        rapidjson::Document doc;
+        doc.Parse(request.body.c_str());
+        size_t size = static_cast<size_t>(k4KWidth) * k4KHeight * 3;
+        if (doc["capacity"].GetUint64() < size)
+            return MockResponse{413, "{\"size\":" + std::to_string(size) + "}"};
+        uint8_t *pixels = mapSegment(doc["shm_name"].GetString(), size);
+        if (pixels == nullptr)
+            return MockResponse{500, "{}"};
+        memset(pixels, 7, size);
+        munmap(pixels, size);
+        return MockResponse{200, "{\"width\":3840,\"height\":2160,\"channels\":3}"};
+    });
+
+    std::shared_ptr<ImageBuffer> frame = std::make_shared<ImageBuffer>();
+    frame->init(k4KWidth, k4KHeight, ImageFormat::RGBA8, ChannelOrder::RGBA);
+    size_t frame_bytes = static_cast<size_t>(frame->strideBytes()) * frame->height();
+    memset(frame->data(), 0, frame_bytes);
+    static_cast<uint8_t *>(frame->data())[frame_bytes - 1] = 99;
+
+    ApiConnection api_connection(backend.baseUrl());
+    std::string img_id;
+    ASSERT_TRUE(api_connection.uploadImage(frame, img_id));
+    EXPECT_EQ(img_id, "shm-upload");
+    EXPECT_EQ(received_pixel, 99);
+
+    ArkImagePtr result = api_connection.getImage("shm-result");
+    ASSERT_NE(result, nullptr);
+    EXPECT_EQ(result->width(), k4KWidth);
+    EXPECT_EQ(result->height(), k4KHeight);
+    EXPECT_EQ(static_cast<uint8_t *>(result->data())[12345], 7);
+
+    // two 4K frames moved, only the JSON handles went through the socket
+    EXPECT_EQ(backend.requestCount("image/upload_shm"), 1u);
+    EXPECT_EQ(backend.requestCount("image/get_shm"), 1u);
+    EXPECT_LT(backend.bytesReceived(), 16u * 1024);
+    EXPECT_LT(backend.bytesSent(), 16u * 1024);
+}
+
+#endif
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include "single_flight.h"
+#include "main_api_connection.h"
+#include "mock_backend.h"
+
+using namespace ::testing;
+
+class SingleFlightTest : public Test
+{
+};
+
+TEST(SingleFlightTest, ConcurrentCallsShareOneRun)
+{
+    SingleFlight<std::string, int> flight;
+    std::atomic<int> runs {0};
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    const int kCallers = 8;
+
+    std::vector<int> results(kCallers, 0);
+    std::vector<std::thread> callers;
+    for (int i = 0; i < kCallers; i++)
+    {
+        callers.emplace_back([&, i]()
+        {
+            results[i] = flight.run("job/1", [&]()
+            {
+                runs++;
+                released.wait();
+                return 42;
+            });
+        });
+    }
+
+    // hold the first call until every other caller has joined it
+    while (flight.sharedCount() < kCallers - 1)
+        std::this_thread::yield();
+    release.set_value();
+    for (auto &caller : callers)
+        caller.join();
+
+    EXPECT_EQ(runs, 1);
+    for (int result : results)
+        EXPECT_EQ(result, 42);
+    EXPECT_EQ(flight.inFlight(), 0u);
+}
+
+TEST(SingleFlightTest, SequentialCallsRunAgain)
+{
+    SingleFlight<std::string, int> flight;
+    int runs = 0;
+    EXPECT_EQ(flight.run("a", [&]() { return ++runs; }), 1);
+    EXPECT_EQ(flight.run("a", [&]() { return ++runs; }), 2);
+    EXPECT_EQ(flight.run("b", [&]() { return ++runs; }), 3);
+    EXPECT_EQ(flight.sharedCount(), 0u);
+}
+
+TEST(SingleFlightTest, ExceptionsReachEveryCaller)
+{
+    SingleFlight<int, int> flight;
+    EXPECT_THROW(flight.run(1, []() -> int { throw std::runtime_error("backend"); }), std::runtime_error);
+    EXPECT_EQ(flight.run(1, []() { return 7; }), 7);
+}
+
+#ifndef _WIN32
+TEST(SingleFlightTest, IdenticalJobPollsHitTheBackendOnce)
+{
+    MockBackend backend;
+    ASSERT_TRUE(backend.start());
+    backend.setLatency(std::chrono::milliseconds(200));
+    backend.on("GET", "job/", [](const MockRequest &)
+    {
+        return MockResponse{200, "{\"status\":\"Job in progress\"}"};
+    });
+
+    ApiConnection api_connection(backend.baseUrl());
+    std::vector<std::thread> pollers;
+    std::vector<JobStatusResponse> statuses(6);
+    for (size_t i = 0; i < statuses.size(); i++)
+    {
+        pollers.emplace_back([&, i]()
+        {
+            statuses[i] = api_connection.jobStatus("1234");
+        });
+    }
+    for (auto &poller : pollers)
+        poller.join();
+
+    // threads starting after the first response would send again, with this latency they all overlap
+    EXPECT_EQ(backend.requestCount("job/"), 1u);
+    for (const auto &status : statuses)
+        EXPECT_EQ(status.status, JOB_STATUS_IN_PROGRESS);
+}
+#endif
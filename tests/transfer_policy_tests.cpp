@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include "transfer_policy.h"
+#include "images/image_utils.h"
+#include "images/image_buffer.h"
+
+using namespace ::testing;
+
+class TransferPolicyTest : public Test
+{
+};
+
+static const size_t k4KBytes = 3840 * 2160 * 4;
+
+static TransferThresholds lossyThresholds()
+{
+    TransferThresholds thresholds;
+    thresholds.allow_lossy = true;
+    thresholds.allow_downscale = true;
+    return thresholds;
+}
+
+TEST(TransferPolicyTest, StaysOnPngUntilMeasured)
+{
+    TransferPolicy policy(lossyThresholds());
+    TransferPlan plan = policy.plan(k4KBytes, TransferRole::Neighbour);
+    EXPECT_EQ(plan.codec, ImageCodec::PNG);
+    EXPECT_TRUE(plan.lossless());
+}
+
+TEST(TransferPolicyTest, FastLinkSkipsCompression)
+{
+    TransferPolicy policy;
+    policy.recordTransfer(1000000000, 1.0);
+    EXPECT_EQ(policy.plan(k4KBytes, TransferRole::Frame).codec, ImageCodec::BMP);
+}
+
+TEST(TransferPolicyTest, SlowLinkCompresses)
+{
+    TransferPolicy policy;
+    policy.recordTransfer(20000000, 1.0);
+    TransferPlan plan = policy.plan(k4KBytes, TransferRole::Frame);
+    EXPECT_EQ(plan.codec, ImageCodec::PNG);
+    // nothing lossy unless the config allows it
+    EXPECT_TRUE(plan.lossless());
+}
+
+TEST(TransferPolicyTest, VerySlowLinkGoesLossyAndDownscalesNeighbours)
+{
+    TransferPolicy policy(lossyThresholds());
+    policy.recordTransfer(2000000, 1.0);
+
+    TransferPlan frame_plan = policy.plan(k4KBytes, TransferRole::Frame);
+    EXPECT_EQ(frame_plan.codec, ImageCodec::JPEG);
+    EXPECT_EQ(frame_plan.downscale, 1);
+
+    TransferPlan neighbour_plan = policy.plan(k4KBytes, TransferRole::Neighbour);
+    EXPECT_EQ(neighbour_plan.codec, ImageCodec::JPEG);
+    EXPECT_GT(neighbour_plan.downscale, 1);
+    EXPECT_LT(neighbour_plan.estimated_seconds, frame_plan.estimated_seconds);
+}
+
+TEST(TransferPolicyTest, ThroughputIsSmoothed)
+{
+    TransferThresholds thresholds;
+    thresholds.smoothing = 0.5;
+    TransferPolicy policy(thresholds);
+    policy.recordRoundTrip(0.0);
+    policy.recordTransfer(100, 1.0);
+    policy.recordTransfer(300, 1.0);
+    EXPECT_DOUBLE_EQ(policy.throughput(), 200.0);
+}
+
+TEST(TransferPolicyTest, EncodedImagesDecode)
+{
+    std::shared_ptr<ImageBuffer> image = std::make_shared<ImageBuffer>();
+    image->init(8, 8, ImageFormat::RGBA8, ChannelOrder::RGBA);
+    uint8_t *pixels = static_cast<uint8_t *>(image->data());
+    for (int i = 0; i < 8 * 8; i++)
+    {
+        pixels[i * 4 + 0] = 200;
+        pixels[i * 4 + 1] = 100;
+        pixels[i * 4 + 2] = 50;
+        pixels[i * 4 + 3] = 255;
+    }
+
+    for (ImageCodec codec : {ImageCodec::PNG, ImageCodec::BMP, ImageCodec::JPEG})
+    {
+        ArkImagePtr decoded = getImage(encodeImage(image, codec, 95));
+        ASSERT_NE(decoded, nullptr);
+        EXPECT_EQ(decoded->width(), 8);
+        uint8_t red = static_cast<uint8_t *>(decoded->data())[0];
+        EXPECT_NEAR(red, 200, 3);
+    }
+
+    ArkImagePtr scaled = getImage(encodeImage(image, ImageCodec::PNG, 0, 2));
+    ASSERT_NE(scaled, nullptr);
+    EXPECT_EQ(scaled->width(), 4);
+    EXPECT_EQ(scaled->height(), 4);
+}
@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <filesystem>
+#include "mock_backend.h"
+#include "main_api_connection.h"
+
+using namespace ::testing;
+
+class UnixSocketTest : public Test
+{
+};
+
+static std::string testSocketPath()
+{
+    return (std::filesystem::temp_directory_path() / ("deepmake_test_" + std::to_string(getpid()) + ".sock")).string();
+}
+
+TEST(UnixSocketTest, RequestsGoThroughTheSocket)
+{
+    MockBackend backend;
+    ASSERT_TRUE(backend.startUnix(testSocketPath()));
+    backend.on("GET", "plugin/status", [](const MockRequest &)
+    {
+        return MockResponse{200, "{}"};
+    });
+
+    ApiConnection api_connection(backend.baseUrl(), testSocketPath());
+    EXPECT_TRUE(api_connection.isBackendRunning());
+    EXPECT_EQ(backend.requestCount("plugin/status"), 1u);
+}
+
+TEST(UnixSocketTest, MissingSocketFailsLikeAStoppedBackend)
+{
+    ApiConnection api_connection("http://localhost", testSocketPath() + ".missing");
+    EXPECT_FALSE(api_connection.isBackendRunning());
+}
+
+#endif
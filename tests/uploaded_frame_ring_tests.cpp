@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include "uploaded_frame_ring.h"
+
+using namespace ::testing;
+
+class UploadedFrameRingTest : public Test
+{
+};
+
+static UploadedFrame uploadedFrame(int frame, uint64_t content_hash, const std::string &node = "http://node_a")
+{
+    UploadedFrame uploaded;
+    uploaded.frame = frame;
+    uploaded.node = node;
+    uploaded.image_id = "img_" + std::to_string(frame);
+    uploaded.content_hash = content_hash;
+    return uploaded;
+}
+
+TEST(UploadedFrameRingTest, FindsAddedFrames)
+{
+    UploadedFrameRing ring(8);
+    ring.add(1, uploadedFrame(10, 100));
+
+    UploadedFrame found;
+    EXPECT_TRUE(ring.find(1, 10, found));
+    EXPECT_EQ(found.image_id, "img_10");
+    EXPECT_EQ(found.node, "http://node_a");
+    EXPECT_FALSE(ring.find(1, 11, found));
+    // instances don't share uploads
+    EXPECT_FALSE(ring.find(2, 10, found));
+}
+
+TEST(UploadedFrameRingTest, SameFrameIsReplaced)
+{
+    UploadedFrameRing ring(8);
+    ring.add(1, uploadedFrame(10, 100));
+    ring.add(1, uploadedFrame(10, 101, "http://node_b"));
+    EXPECT_EQ(ring.size(1), 1u);
+
+    UploadedFrame found;
+    EXPECT_TRUE(ring.find(1, 10, found));
+    EXPECT_EQ(found.node, "http://node_b");
+    EXPECT_EQ(found.content_hash, 101u);
+}
+
+TEST(UploadedFrameRingTest, OldestFramesAreDropped)
+{
+    UploadedFrameRing ring(3);
+    for (int frame = 1; frame <= 5; frame++)
+        ring.add(1, uploadedFrame(frame, frame));
+    EXPECT_EQ(ring.size(1), 3u);
+
+    UploadedFrame found;
+    EXPECT_FALSE(ring.find(1, 2, found));
+    EXPECT_TRUE(ring.find(1, 3, found));
+    EXPECT_TRUE(ring.find(1, 5, found));
+}
+
+TEST(UploadedFrameRingTest, ChangedPixelsDropTheInstance)
+{
+    UploadedFrameRing ring(8);
+    ring.add(1, uploadedFrame(10, 100));
+    ring.add(1, uploadedFrame(11, 110));
+    ring.add(2, uploadedFrame(10, 100));
+
+    // same pixels, or a frame that was never uploaded, keep everything
+    ring.checkFrame(1, 10, 100);
+    ring.checkFrame(1, 12, 999);
+    EXPECT_EQ(ring.size(1), 2u);
+
+    ring.checkFrame(1, 11, 111);
+    EXPECT_EQ(ring.size(1), 0u);
+    EXPECT_EQ(ring.size(2), 1u);
+}
+
+TEST(UploadedFrameRingTest, ForgetDropsTheInstance)
+{
+    UploadedFrameRing ring(8);
+    ring.add(1, uploadedFrame(10, 100));
+    ring.add(2, uploadedFrame(10, 100));
+    ring.forget(1);
+
+    UploadedFrame found;
+    EXPECT_FALSE(ring.find(1, 10, found));
+    EXPECT_TRUE(ring.find(2, 10, found));
+}